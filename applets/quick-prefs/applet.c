@@ -114,7 +114,8 @@ struct _PrefsAppletPrivate {
 	DesktopAgnosticConfigClient* panel_client;
 	GtkMenu* ctx_menu;
 	GList* windows;
-	guint timer_id;
+	gulong motion_hook_id;
+	gint last_region;
 	gboolean in_drag;
 	guint autohide_cookie;
 	AwnApplet* docklet;
@@ -218,8 +219,9 @@ static void prefs_applet_on_active_changed (PrefsApplet* self, WnckWindow* old_a
 static void prefs_applet_on_window_opened (PrefsApplet* self, WnckWindow* window);
 static void prefs_applet_update_icon (PrefsApplet* self);
 static void prefs_applet_on_window_closed (PrefsApplet* self, WnckWindow* window);
-static gboolean prefs_applet_on_timer_tick (PrefsApplet* self);
-static gboolean _prefs_applet_on_timer_tick_gsource_func (gpointer self);
+static gboolean prefs_applet_on_motion_hook (PrefsApplet* self, GSignalInvocationHint* ihint, GValue* param_values, int param_values_length1);
+static void prefs_applet_update_orientation (PrefsApplet* self, GdkScreen* screen, gint mouse_x, gint mouse_y);
+static gboolean _prefs_applet_on_motion_hook_gsignal_emission_hook (GSignalInvocationHint* ihint, guint n_param_values, const GValue* param_values, gpointer self);
 void prefs_applet_setup_docklet (PrefsApplet* self, GdkNativeWindow window_id);
 void prefs_applet_setup_label_for_docklet (AwnLabel* label, AwnApplet* docklet);
 static AwnIcon* prefs_applet_new_unbound_icon (void);
@@ -1234,6 +1236,8 @@ static void prefs_applet_real_constructed (GObject* base) {
 	prefs_applet_initialize_menu (self);
 	_tmp17_ = awn_dbus_watcher_get_default ();
 	watcher = _tmp17_;
+	awn_dbus_watcher_watch_name (watcher, "net.launchpad.DockManager");
+	awn_dbus_watcher_set_filtered (watcher, TRUE);
 	g_signal_connect_object (watcher, "name-appeared::net.launchpad.DockManager", (GCallback) _prefs_applet_taskmanager_appeared_awn_dbus_watcher_name_appeared, self, 0);
 	prefs_applet_update_taskmanager (self, FALSE, NULL, NULL);
 	g_signal_connect_object ((AwnApplet*) self, "applet-deleted", (GCallback) __lambda10__awn_applet_applet_deleted, self, 0);
@@ -1493,97 +1497,122 @@ static void prefs_applet_update_icon (PrefsApplet* self) {
 }
 
 
-static gboolean prefs_applet_on_timer_tick (PrefsApplet* self) {
+static gboolean prefs_applet_on_motion_hook (PrefsApplet* self, GSignalInvocationHint* ihint, GValue* param_values, int param_values_length1) {
 	gboolean result = FALSE;
-	gint mouse_x = 0;
-	gint mouse_y = 0;
-	GdkScreen* screen = NULL;
+	gpointer _tmp0_ = NULL;
+	GdkEvent* event;
+	GdkScreen* _tmp1_ = NULL;
+	GdkScreen* screen;
+	gint mouse_x;
+	gint mouse_y;
+	g_return_val_if_fail (self != NULL, FALSE);
+	g_return_val_if_fail (ihint != NULL, FALSE);
+	_tmp0_ = g_value_get_boxed (&param_values[1]);
+	event = (GdkEvent*) _tmp0_;
+	if (event->type != GDK_MOTION_NOTIFY) {
+		result = TRUE;
+		return result;
+	}
+	_tmp1_ = gdk_drawable_get_screen ((GdkDrawable*) event->motion.window);
+	screen = _tmp1_;
+	mouse_x = (gint) event->motion.x_root;
+	mouse_y = (gint) event->motion.y_root;
+	if (event->motion.is_hint != 0) {
+		GdkDisplay* _tmp2_ = NULL;
+		GdkScreen* _tmp3_ = NULL;
+		gint _tmp4_;
+		gint _tmp5_;
+		_tmp2_ = gdk_drawable_get_display ((GdkDrawable*) event->motion.window);
+		gdk_display_get_pointer (_tmp2_, &_tmp3_, &_tmp4_, &_tmp5_, NULL);
+		screen = _tmp3_;
+		mouse_x = _tmp4_;
+		mouse_y = _tmp5_;
+	}
+	prefs_applet_update_orientation (self, screen, mouse_x, mouse_y);
+	result = TRUE;
+	return result;
+}
+
+
+static void prefs_applet_update_orientation (PrefsApplet* self, GdkScreen* screen, gint mouse_x, gint mouse_y) {
 	GdkRectangle rect = {0};
-	AwnIcon* _tmp0_ = NULL;
-	GdkDisplay* _tmp1_ = NULL;
-	GdkScreen* _tmp2_ = NULL;
-	gint _tmp3_;
-	gint _tmp4_;
-	gint _tmp5_;
+	gint _tmp0_;
 	gint monitor_num;
-	gint _tmp6_;
+	gint _tmp1_;
 	gint n_monitors;
-	gint _tmp7_;
+	gint _tmp2_;
 	gint default_mon;
-	GdkRectangle _tmp8_ = {0};
+	GdkRectangle _tmp3_ = {0};
 	gfloat rel_x;
 	gfloat rel_y;
 	GtkPositionType pos = 0;
-	gboolean _tmp9_ = FALSE;
+	gboolean _tmp4_ = FALSE;
 	gboolean is_top;
-	gboolean _tmp10_ = FALSE;
+	gboolean _tmp5_ = FALSE;
 	gboolean is_bottom;
-	gboolean _tmp11_ = FALSE;
+	gboolean _tmp6_ = FALSE;
 	gboolean is_left;
-	gboolean _tmp12_ = FALSE;
+	gboolean _tmp7_ = FALSE;
 	gboolean is_right;
-	gboolean _tmp13_ = FALSE;
-	gboolean _tmp14_ = FALSE;
-	gboolean _tmp15_ = FALSE;
+	gboolean _tmp8_ = FALSE;
+	gboolean _tmp9_ = FALSE;
+	gboolean _tmp10_ = FALSE;
 	gboolean on_edge;
+	gint _tmp11_ = 0;
+	gint region;
 	GError * _inner_error_ = NULL;
-	g_return_val_if_fail (self != NULL, FALSE);
-	_tmp0_ = awn_applet_simple_get_icon ((AwnAppletSimple*) self);
-	_tmp1_ = gtk_widget_get_display ((GtkWidget*) _tmp0_);
-	gdk_display_get_pointer (_tmp1_, &_tmp2_, &_tmp3_, &_tmp4_, NULL);
-	screen = _tmp2_;
-	mouse_x = _tmp3_;
-	mouse_y = _tmp4_;
-	_tmp5_ = gdk_screen_get_monitor_at_point (screen, mouse_x, mouse_y);
-	monitor_num = _tmp5_;
-	_tmp6_ = gdk_screen_get_n_monitors (screen);
-	n_monitors = _tmp6_;
-	_tmp7_ = gdk_screen_get_monitor_at_point (screen, 0, 0);
-	default_mon = _tmp7_;
-	gdk_screen_get_monitor_geometry (screen, monitor_num, &_tmp8_);
-	rect = _tmp8_;
+	g_return_if_fail (self != NULL);
+	g_return_if_fail (screen != NULL);
+	_tmp0_ = gdk_screen_get_monitor_at_point (screen, mouse_x, mouse_y);
+	monitor_num = _tmp0_;
+	_tmp1_ = gdk_screen_get_n_monitors (screen);
+	n_monitors = _tmp1_;
+	_tmp2_ = gdk_screen_get_monitor_at_point (screen, 0, 0);
+	default_mon = _tmp2_;
+	gdk_screen_get_monitor_geometry (screen, monitor_num, &_tmp3_);
+	rect = _tmp3_;
 	rel_x = (mouse_x - rect.x) / ((gfloat) rect.width);
 	rel_y = (mouse_y - rect.y) / ((gfloat) rect.height);
 	if (rel_y <= 0.15) {
-		_tmp9_ = rel_y >= 0;
+		_tmp4_ = rel_y >= 0;
 	} else {
-		_tmp9_ = FALSE;
+		_tmp4_ = FALSE;
 	}
-	is_top = _tmp9_;
+	is_top = _tmp4_;
 	if (rel_y >= 0.85) {
-		_tmp10_ = rel_y <= 1;
+		_tmp5_ = rel_y <= 1;
 	} else {
-		_tmp10_ = FALSE;
+		_tmp5_ = FALSE;
 	}
-	is_bottom = _tmp10_;
+	is_bottom = _tmp5_;
 	if (rel_x <= 0.15) {
-		_tmp11_ = rel_x >= 0;
+		_tmp6_ = rel_x >= 0;
 	} else {
-		_tmp11_ = FALSE;
+		_tmp6_ = FALSE;
 	}
-	is_left = _tmp11_;
+	is_left = _tmp6_;
 	if (rel_x >= 0.85) {
-		_tmp12_ = rel_x <= 1;
+		_tmp7_ = rel_x <= 1;
 	} else {
-		_tmp12_ = FALSE;
+		_tmp7_ = FALSE;
 	}
-	is_right = _tmp12_;
+	is_right = _tmp7_;
 	if (is_top) {
-		_tmp15_ = TRUE;
+		_tmp10_ = TRUE;
 	} else {
-		_tmp15_ = is_bottom;
+		_tmp10_ = is_bottom;
 	}
-	if (_tmp15_) {
-		_tmp14_ = TRUE;
+	if (_tmp10_) {
+		_tmp9_ = TRUE;
 	} else {
-		_tmp14_ = is_left;
+		_tmp9_ = is_left;
 	}
-	if (_tmp14_) {
-		_tmp13_ = TRUE;
+	if (_tmp9_) {
+		_tmp8_ = TRUE;
 	} else {
-		_tmp13_ = is_right;
+		_tmp8_ = is_right;
 	}
-	on_edge = _tmp13_;
+	on_edge = _tmp8_;
 	if (is_bottom) {
 		pos = GTK_POS_BOTTOM;
 	} else {
@@ -1601,25 +1630,35 @@ static gboolean prefs_applet_on_timer_tick (PrefsApplet* self) {
 			}
 		}
 	}
+	if (on_edge) {
+		_tmp11_ = ((gint) pos) + 1;
+	} else {
+		_tmp11_ = 0;
+	}
+	region = (monitor_num * 5) + _tmp11_;
+	if (region == self->priv->last_region) {
+		return;
+	}
+	self->priv->last_region = region;
 	desktop_agnostic_config_client_set_bool (self->priv->panel_client, "panel", "monitor_force", FALSE, &_inner_error_);
 	if (_inner_error_ != NULL) {
 		goto __catch1_g_error;
 	}
 	if (n_monitors > 1) {
-		gint _tmp16_;
+		gint _tmp12_;
 		gint config_mon;
-		gboolean _tmp17_ = FALSE;
-		_tmp16_ = desktop_agnostic_config_client_get_int (self->priv->panel_client, "panel", "monitor_num", &_inner_error_);
-		config_mon = _tmp16_;
+		gboolean _tmp13_ = FALSE;
+		_tmp12_ = desktop_agnostic_config_client_get_int (self->priv->panel_client, "panel", "monitor_num", &_inner_error_);
+		config_mon = _tmp12_;
 		if (_inner_error_ != NULL) {
 			goto __catch1_g_error;
 		}
 		if (default_mon != monitor_num) {
-			_tmp17_ = TRUE;
+			_tmp13_ = TRUE;
 		} else {
-			_tmp17_ = monitor_num != config_mon;
+			_tmp13_ = monitor_num != config_mon;
 		}
-		if (_tmp17_) {
+		if (_tmp13_) {
 			desktop_agnostic_config_client_set_int (self->priv->panel_client, "panel", "monitor_num", monitor_num, &_inner_error_);
 			if (_inner_error_ != NULL) {
 				goto __catch1_g_error;
@@ -1638,23 +1677,21 @@ static gboolean prefs_applet_on_timer_tick (PrefsApplet* self) {
 		GError * e;
 		e = _inner_error_;
 		_inner_error_ = NULL;
-		g_warning ("applet.vala:273: Unable to set panel properties. Error: %s", e->message);
+		g_warning ("applet.vala:307: Unable to set panel properties. Error: %s", e->message);
 		_g_error_free0 (e);
 	}
 	__finally1:
 	if (_inner_error_ != NULL) {
 		g_critical ("file %s: line %d: uncaught error: %s (%s, %d)", __FILE__, __LINE__, _inner_error_->message, g_quark_to_string (_inner_error_->domain), _inner_error_->code);
 		g_clear_error (&_inner_error_);
-		return FALSE;
+		return;
 	}
-	result = TRUE;
-	return result;
 }
 
 
-static gboolean _prefs_applet_on_timer_tick_gsource_func (gpointer self) {
+static gboolean _prefs_applet_on_motion_hook_gsignal_emission_hook (GSignalInvocationHint* ihint, guint n_param_values, const GValue* param_values, gpointer self) {
 	gboolean result;
-	result = prefs_applet_on_timer_tick (self);
+	result = prefs_applet_on_motion_hook (self, ihint, (GValue*) param_values, (int) n_param_values);
 	return result;
 }
 
@@ -1675,15 +1712,18 @@ static void prefs_applet_on_drag_begin (PrefsApplet* self, GdkDragContext* conte
 	g_object_set (tooltip, "smart-behavior", FALSE, NULL);
 	g_object_set (tooltip, "toggle-on-click", FALSE, NULL);
 	gtk_widget_show ((GtkWidget*) tooltip);
-	if (self->priv->timer_id == 0) {
+	if (self->priv->motion_hook_id == 0) {
 		guint _tmp3_;
-		_tmp3_ = g_timeout_add_full (G_PRIORITY_DEFAULT, (guint) 300, _prefs_applet_on_timer_tick_gsource_func, g_object_ref (self), g_object_unref);
-		self->priv->timer_id = _tmp3_;
+		gulong _tmp4_;
+		self->priv->last_region = -1;
+		_tmp3_ = g_signal_lookup ("motion-notify-event", GTK_TYPE_WIDGET);
+		_tmp4_ = g_signal_add_emission_hook (_tmp3_, (GQuark) 0, _prefs_applet_on_motion_hook_gsignal_emission_hook, self, NULL);
+		self->priv->motion_hook_id = _tmp4_;
 	}
 	if (self->priv->autohide_cookie == 0) {
-		guint _tmp4_;
-		_tmp4_ = awn_applet_inhibit_autohide ((AwnApplet*) self, "awn-settings");
-		self->priv->autohide_cookie = _tmp4_;
+		guint _tmp5_;
+		_tmp5_ = awn_applet_inhibit_autohide ((AwnApplet*) self, "awn-settings");
+		self->priv->autohide_cookie = _tmp5_;
 	}
 }
 
@@ -1694,9 +1734,11 @@ static void prefs_applet_on_drag_end (PrefsApplet* self, GdkDragContext* context
 	AwnTooltip* tooltip;
 	g_return_if_fail (self != NULL);
 	g_return_if_fail (context != NULL);
-	if (self->priv->timer_id != 0) {
-		g_source_remove (self->priv->timer_id);
-		self->priv->timer_id = (guint) 0;
+	if (self->priv->motion_hook_id != 0) {
+		guint _tmp2_;
+		_tmp2_ = g_signal_lookup ("motion-notify-event", GTK_TYPE_WIDGET);
+		g_signal_remove_emission_hook (_tmp2_, self->priv->motion_hook_id);
+		self->priv->motion_hook_id = (gulong) 0;
 	}
 	if (self->priv->autohide_cookie != 0) {
 		awn_applet_uninhibit_autohide ((AwnApplet*) self, self->priv->autohide_cookie);
@@ -2190,7 +2232,7 @@ static void prefs_applet_change_icon_size (PrefsApplet* self, gint new_size) {
 		GError * e;
 		e = _inner_error_;
 		_inner_error_ = NULL;
-		g_warning ("applet.vala:547: Unable to set panel properties. Error: %s", e->message);
+		g_warning ("applet.vala:585: Unable to set panel properties. Error: %s", e->message);
 		_g_error_free0 (e);
 	}
 	__finally2:
@@ -2258,7 +2300,7 @@ static void prefs_applet_run_preferences (PrefsApplet* self, gboolean about_only
 		_tmp9_ = g_strdup_printf (_tmp8_, err->message);
 		_g_free0 (msg);
 		msg = _tmp9_;
-		g_warning ("applet.vala:579: %s", msg);
+		g_warning ("applet.vala:617: %s", msg);
 		_g_free0 (msg);
 		_g_error_free0 (err);
 	}
@@ -2318,7 +2360,7 @@ static void prefs_applet_on_quit_click (PrefsApplet* self) {
 		GError * err;
 		err = _inner_error_;
 		_inner_error_ = NULL;
-		g_error ("applet.vala:599: %s", err->message);
+		g_error ("applet.vala:640: %s", err->message);
 		_g_error_free0 (err);
 	}
 	__finally4:
@@ -2387,7 +2429,8 @@ static void prefs_applet_instance_init (PrefsApplet * self) {
 	self->priv = PREFS_APPLET_GET_PRIVATE (self);
 	self->priv->panel_client = NULL;
 	self->priv->ctx_menu = NULL;
-	self->priv->timer_id = (guint) 0;
+	self->priv->motion_hook_id = (gulong) 0;
+	self->priv->last_region = -1;
 	self->priv->in_drag = FALSE;
 	self->priv->autohide_cookie = (guint) 0;
 }
@@ -45,7 +45,8 @@ public class PrefsApplet : AppletSimple
   private unowned DesktopAgnostic.Config.Client panel_client = null;
   private Gtk.Menu? ctx_menu = null;
   private List<unowned Wnck.Window> windows;
-  private uint timer_id = 0;
+  private ulong motion_hook_id = 0;
+  private int last_region = -1;
   private bool in_drag = false;
   private uint autohide_cookie = 0;
 
@@ -101,6 +102,8 @@ public class PrefsApplet : AppletSimple
     this.initialize_menu ();
 
     unowned DBusWatcher watcher = DBusWatcher.get_default ();
+    watcher.watch_name ("net.launchpad.DockManager");
+    watcher.set_filtered (true);
     watcher.name_appeared["net.launchpad.DockManager"].
         connect (this.taskmanager_appeared);
 
@@ -229,15 +232,33 @@ public class PrefsApplet : AppletSimple
   }
 
   private bool
-  on_timer_tick ()
+  on_motion_hook (SignalInvocationHint ihint, Value[] param_values)
+  {
+    // GTK grabs the pointer for the drag, so every motion ends up here
+    unowned Gdk.Event event = (Gdk.Event) param_values[1].get_boxed ();
+    if (event.type != Gdk.EventType.MOTION_NOTIFY) return true;
+
+    unowned Gdk.Screen screen = event.motion.window.get_screen ();
+    int mouse_x = (int) event.motion.x_root;
+    int mouse_y = (int) event.motion.y_root;
+
+    if (event.motion.is_hint != 0)
+    {
+      event.motion.window.get_display ().get_pointer (out screen,
+                                                      out mouse_x,
+                                                      out mouse_y,
+                                                      null);
+    }
+
+    this.update_orientation (screen, mouse_x, mouse_y);
+    return true;
+  }
+
+  private void
+  update_orientation (Gdk.Screen screen, int mouse_x, int mouse_y)
   {
-    int mouse_x, mouse_y;
-    unowned Gdk.Screen screen;
     Gdk.Rectangle rect;
 
-    this.get_icon ().get_display ().get_pointer (out screen,
-                                                 out mouse_x, out mouse_y,
-                                                 null);
     int monitor_num = screen.get_monitor_at_point (mouse_x, mouse_y);
     int n_monitors = screen.get_n_monitors ();
     int default_mon = screen.get_monitor_at_point (0, 0);
@@ -259,6 +280,11 @@ public class PrefsApplet : AppletSimple
     else if (is_right) pos = Gtk.PositionType.RIGHT;
     else pos = Gtk.PositionType.BOTTOM;
 
+    // nothing to do until the pointer gets to another monitor or edge
+    int region = monitor_num * 5 + (on_edge ? (int)pos + 1 : 0);
+    if (region == this.last_region) return;
+    this.last_region = region;
+
     try
     {
       this.panel_client.set_bool ("panel", "monitor_force", false);
@@ -281,7 +307,6 @@ public class PrefsApplet : AppletSimple
     {
       warning ("Unable to set panel properties. Error: %s", e.message);
     }
-    return true;
   }
 
   private void
@@ -295,9 +320,12 @@ public class PrefsApplet : AppletSimple
     tooltip.toggle_on_click = false;
     tooltip.show ();
 
-    if (this.timer_id == 0)
+    if (this.motion_hook_id == 0)
     {
-      this.timer_id = GLib.Timeout.add (300, this.on_timer_tick);
+      this.last_region = -1;
+      this.motion_hook_id = GLib.Signal.add_emission_hook (
+        GLib.Signal.lookup ("motion-notify-event", typeof (Gtk.Widget)),
+        0, this.on_motion_hook, null);
     }
     if (this.autohide_cookie == 0)
     {
@@ -308,10 +336,12 @@ public class PrefsApplet : AppletSimple
   private void
   on_drag_end (DragContext context)
   {
-    if (this.timer_id != 0)
+    if (this.motion_hook_id != 0)
     {
-      Source.remove (this.timer_id);
-      this.timer_id = 0;
+      GLib.Signal.remove_emission_hook (
+        GLib.Signal.lookup ("motion-notify-event", typeof (Gtk.Widget)),
+        this.motion_hook_id);
+      this.motion_hook_id = 0;
     }
     if (this.autohide_cookie != 0)
     {
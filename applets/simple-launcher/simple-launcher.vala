@@ -25,6 +25,7 @@ using DesktopAgnostic;
 class SimpleLauncher : Applet
 {
   static const string DESKTOP_ENTRY = "desktop-entry-object";
+  static const string LAUNCHER_PATH = "launcher-path";
 
   //private Zeitgeist.Log zg_log = new Zeitgeist.Log ();
   private IconBox icon_box;
@@ -35,7 +36,10 @@ class SimpleLauncher : Applet
   private Gtk.MenuItem edit_menu_item;
   private DesktopAgnostic.Config.Client client;
   private string config_dir;
-  private GenericArray<Awn.ThemedIcon> launchers;
+  // desktop file path -> launcher
+  private HashTable<string, Awn.ThemedIcon> launchers;
+  private Queue<string> parse_queue = new Queue<string> ();
+  private uint parse_id = 0;
   private uint timer_id = 0;
 
   private ValueArray _launcher_list = new ValueArray (4);
@@ -142,15 +146,16 @@ class SimpleLauncher : Applet
                                            null);
     DirUtils.create_with_parents (config_dir, 0755);
 
-    launchers = new GenericArray<Awn.ThemedIcon> ();
+    launchers = new HashTable<string, Awn.ThemedIcon> (str_hash, str_equal);
 
     this.client = Awn.Config.get_default_for_applet (this);
 
     try
     {
+      // written back through save_launcher_list ()
       this.client.bind (DesktopAgnostic.Config.GROUP_DEFAULT, "launcher_list",
                         this, "launcher-list",
-                        false, DesktopAgnostic.Config.BindMethod.FALLBACK);
+                        true, DesktopAgnostic.Config.BindMethod.FALLBACK);
     }
     catch (DesktopAgnostic.Config.Error err)
     {
@@ -281,7 +286,16 @@ class SimpleLauncher : Applet
 
     Value v = path;
     _launcher_list.append (v);
+    save_launcher_list ();
+  }
+
+  private void save_launcher_list ()
+  {
     this.notify_property ("launcher-list");
+    // edits in one main loop iteration end up in a single write
+    Awn.Config.set_list_deferred (this.client,
+                                  DesktopAgnostic.Config.GROUP_DEFAULT,
+                                  "launcher_list", _launcher_list);
   }
 
   private VFS.File get_new_desktop_file ()
@@ -309,99 +323,212 @@ class SimpleLauncher : Applet
     {
       Value v = f.path;
       _launcher_list.append (v);
-      this.notify_property ("launcher-list");
+      save_launcher_list ();
     }
     d.destroy ();
   }
 
   private void launchers_changed ()
   {
-    int i;
-    int[] invalid_launchers = {};
+    var wanted = new HashTable<string, string> (str_hash, str_equal);
+    foreach (Value v in _launcher_list)
+    {
+      string de_path = v.get_string ();
+      wanted.insert (de_path, de_path);
+    }
 
-    // mark all icons as untouched
-    for (i=0; i<launchers.length; i++)
+    // destroy removed launchers
+    List<unowned Awn.ThemedIcon> removed = new List<unowned Awn.ThemedIcon> ();
+    var iter = HashTableIter<string, Awn.ThemedIcon> (launchers);
+    unowned string path;
+    unowned Awn.ThemedIcon launcher;
+    while (iter.next (out path, out launcher))
     {
-      launchers[i].set_data ("untouched", 1);
+      if (wanted.lookup (path) == null) removed.prepend (launcher);
     }
 
-    // create new launchers
-    int index = 0;
+    foreach (unowned Awn.ThemedIcon ti in removed)
+    {
+      remove_launcher (ti, true);
+    }
+
+    // create new launchers, duplicate paths share one
+    var ordered = new GenericArray<unowned Awn.ThemedIcon> ();
     foreach (Value v in _launcher_list)
     {
       string de_path = v.get_string ();
-      bool found = false;
-      for (i=0; i<launchers.length; i++)
-      {
-        FDO.DesktopEntry? de = launchers[i].get_data (DESKTOP_ENTRY);
-        if (de != null && de.file.path == de_path)
-        {
-          launchers[i].set_data ("untouched", 0);
-          found = true;
+      if (wanted.lookup (de_path) == null) continue;
+      wanted.remove (de_path);
 
-          icon_box.reorder_child (launchers[i], index);
-          break;
-        }
+      if (launchers.lookup (de_path) == null)
+      {
+        create_launcher (de_path);
       }
+      ordered.add (launchers.lookup (de_path));
+    }
 
-      if (!found)
+    reorder_launchers (ordered);
+
+    if (launchers.size () > 0) add_icon.hide ();
+    else add_icon.show ();
+  }
+
+  /* Puts the launchers in the given order. The longest run of launchers
+   * that is already in the right relative order stays where it is, only
+   * the rest is moved. */
+  private void reorder_launchers (GenericArray<unowned Awn.ThemedIcon> ordered)
+  {
+    int i;
+    int n = ordered.length;
+    if (n == 0) return;
+
+    // the box order and where each child is in it, kept up to date while
+    // moving so the box isn't asked for its children again
+    var positions = new HashTable<unowned Gtk.Widget, int> (direct_hash,
+                                                            direct_equal);
+    List<unowned Gtk.Widget> children = icon_box.get_children ();
+    Gtk.Widget[] order = new Gtk.Widget[children.length ()];
+    i = 0;
+    foreach (unowned Gtk.Widget child in children)
+    {
+      positions.insert (child, i);
+      order[i++] = child;
+    }
+
+    int[] seq = new int[n];
+    for (i = 0; i < n; i++)
+    {
+      seq[i] = positions.lookup (ordered[i]);
+    }
+
+    // longest increasing subsequence of the current positions;
+    // tails[k] is the end of the best subsequence of length k+1
+    int[] tails = new int[n];
+    int[] prev = new int[n];
+    int length = 0;
+    for (i = 0; i < n; i++)
+    {
+      int lo = 0, hi = length;
+      while (lo < hi)
       {
-        var icon = create_launcher (de_path);
-        if (icon != null)
-        {
-          icon_box.reorder_child (icon, index);
-        }
-        else
-        {
-          invalid_launchers += index;
-        }
+        int mid = (lo + hi) / 2;
+        if (seq[tails[mid]] < seq[i]) lo = mid + 1;
+        else hi = mid;
       }
+      prev[i] = lo > 0 ? tails[lo - 1] : -1;
+      tails[lo] = i;
+      if (lo == length) length++;
+    }
 
-      index++;
+    bool[] keep = new bool[n];
+    for (i = tails[length - 1]; i >= 0; i = prev[i])
+    {
+      keep[i] = true;
     }
 
-    // destroy removed launchers
-    List<unowned Awn.ThemedIcon> l = new List<unowned Awn.ThemedIcon> ();
-    for (i=0; i<launchers.length; i++)
+    // everything else goes right after its predecessor
+    for (i = 0; i < n; i++)
     {
-      if (launchers[i].get_data<int> ("untouched") != 0)
+      if (keep[i]) continue;
+
+      int c = positions.lookup (ordered[i]);
+      int target = 0;
+      if (i > 0)
+      {
+        int p = positions.lookup (ordered[i - 1]);
+        target = c < p ? p : p + 1;
+      }
+      icon_box.reorder_child (ordered[i], target);
+
+      // the children in between shift by one towards the old slot
+      Gtk.Widget moved = order[c];
+      int k;
+      for (k = c; k < target; k++)
+      {
+        order[k] = order[k + 1];
+        positions.insert (order[k], k);
+      }
+      for (k = c; k > target; k--)
       {
-        l.append (launchers[i]);
+        order[k] = order[k - 1];
+        positions.insert (order[k], k);
       }
+      order[target] = moved;
+      positions.insert (moved, target);
     }
+  }
+
+  /* Creates a placeholder launcher, the desktop file is parsed later. */
+  private void create_launcher (string path)
+  {
+    var icon = new Awn.ThemedIcon ();
+    icon.drag_and_drop = false;
+    icon.set_data (LAUNCHER_PATH, path);
+    icon.set_size (this.size);
+    icon.set_info_simple (this.canonical_name,
+                          this.uid,
+                          "application-x-executable");
 
-    foreach (unowned Awn.ThemedIcon ti in l)
+    icon.clicked.connect (this.on_launcher_clicked);
+    icon.context_menu_popup.connect (this.on_launcher_ctx_menu);
+    icon_box.add (icon);
+    icon.show ();
+
+    Gtk.drag_dest_set (icon, 0, null, Gdk.DragAction.PRIVATE);
+    icon.drag_motion.connect (this.on_launcher_drag_motion);
+
+    launchers.insert (path, icon);
+
+    parse_queue.push_tail (path);
+    if (parse_id == 0)
     {
-      remove_launcher (ti, true);
+      parse_id = Idle.add_full (Priority.LOW, this.parse_next);
     }
+  }
 
-    if (launchers.length > 0) add_icon.hide ();
-    else add_icon.show ();
+  /* Parses one queued desktop file per main loop iteration, so neither
+   * startup nor config changes wait for all the files to be read. */
+  private bool parse_next ()
+  {
+    string? path = parse_queue.pop_head ();
+    if (path != null)
+    {
+      unowned Awn.ThemedIcon? icon = launchers.lookup (path);
+      // the launcher could have been removed in the meantime
+      if (icon != null) load_desktop_entry (icon, path);
+    }
 
-    // remove invalid launchers from config backend
-    bool something_removed = false;
-    for (i = invalid_launchers.length-1; i >= 0; i--)
+    if (parse_queue.is_empty ())
     {
-      _launcher_list.remove (invalid_launchers[i]);
-      something_removed = true;
+      parse_id = 0;
+      return false;
     }
-    if (something_removed) this.notify_property ("launcher-list");
+    return true;
   }
 
-  private Awn.ThemedIcon? create_launcher (string path)
+  private void load_desktop_entry (Awn.ThemedIcon icon, string path)
   {
     var f = VFS.file_new_for_path (path);
     if (!f.exists ())
     {
       warning ("Desktop file \"%s\" doesn't exist!", path);
-      return null;
+
+      // remove it from config backend, that also destroys the placeholder
+      uint i = 0;
+      while (i < _launcher_list.n_values)
+      {
+        if (_launcher_list.get_nth (i).get_string () == path)
+        {
+          _launcher_list.remove (i);
+        }
+        else i++;
+      }
+      save_launcher_list ();
+      return;
     }
     var de = FDO.desktop_entry_new_for_file (f);
 
-    var icon = new Awn.ThemedIcon ();
-    icon.drag_and_drop = false;
     icon.set_data (DESKTOP_ENTRY, de);
-    icon.set_size (this.size);
 
     string icon_name = "image-missing";
     if (de.key_exists ("Icon"))
@@ -413,29 +540,19 @@ class SimpleLauncher : Applet
                           this.uid,
                           icon_name);
     icon.set_tooltip_text (de.get_localestring ("Name", null));
-
-    icon.clicked.connect (this.on_launcher_clicked);
-    icon.context_menu_popup.connect (this.on_launcher_ctx_menu);
-    icon_box.add (icon);
-    icon.show ();
-
-    Gtk.drag_dest_set (icon, 0, null, Gdk.DragAction.PRIVATE);
-    icon.drag_motion.connect (this.on_launcher_drag_motion);
-
-    launchers.add (icon);
-
-    return icon;
   }
 
   private void remove_launcher (Awn.ThemedIcon launcher,
                                 bool delete_desktop_file)
   {
-    FDO.DesktopEntry de = launcher.steal_data (DESKTOP_ENTRY);
-    if (delete_desktop_file && de.file.path.has_prefix (config_dir))
+    FDO.DesktopEntry? de = launcher.steal_data (DESKTOP_ENTRY);
+    string path = launcher.steal_data (LAUNCHER_PATH);
+    if (delete_desktop_file && path.has_prefix (config_dir))
     {
-      de.file.remove ();
+      var f = de != null ? de.file : VFS.file_new_for_path (path);
+      if (f.exists ()) f.remove ();
     }
-    this.launchers.remove (launcher);
+    this.launchers.remove (path);
     launcher.destroy (); // removes the launcher from IconBox
   }
 
@@ -453,8 +570,9 @@ class SimpleLauncher : Applet
 
   private void on_launcher_clicked (Awn.Icon launcher)
   {
-    FDO.DesktopEntry de = launcher.get_data (DESKTOP_ENTRY);
-    return_if_fail (de != null);
+    FDO.DesktopEntry? de = launcher.get_data (DESKTOP_ENTRY);
+    // not loaded yet
+    if (de == null) return;
 
     try
     {
@@ -486,24 +604,25 @@ class SimpleLauncher : Applet
   private void remove_clicked ()
   {
     Awn.ThemedIcon ti = remove_menu_item.get_data (DESKTOP_ENTRY);
-    FDO.DesktopEntry de = ti.get_data (DESKTOP_ENTRY);
+    unowned string path = ti.get_data (LAUNCHER_PATH);
 
     uint index = 0;
     foreach (Value v in _launcher_list)
     {
-      if (v.get_string () == de.file.path) break;
+      if (v.get_string () == path) break;
       index++;
     }
 
     if (index < _launcher_list.n_values) _launcher_list.remove (index);
 
-    this.notify_property ("launcher-list");
+    save_launcher_list ();
   }
 
   private void edit_clicked ()
   {
     Awn.ThemedIcon ti = remove_menu_item.get_data (DESKTOP_ENTRY);
-    FDO.DesktopEntry de = ti.get_data (DESKTOP_ENTRY);
+    FDO.DesktopEntry? de = ti.get_data (DESKTOP_ENTRY);
+    if (de == null) return;
 
     var input = de.file;
     VFS.File? output = null;
@@ -530,7 +649,7 @@ class SimpleLauncher : Applet
           val = _launcher_list.get_nth (i);
           if (val.get_string () == input.path) val.set_string (output.path);
         }
-        this.notify_property ("launcher-list");
+        save_launcher_list ();
       }
     }
     d.destroy ();
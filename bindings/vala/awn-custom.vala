@@ -37,10 +37,12 @@ namespace Awn
   [CCode (cheader_filename = "libawn/libawn.h")]
   namespace Config
   {
+    public static void flush ();
     public static void free ();
     public static unowned DesktopAgnostic.Config.Client get_default (int panel_id) throws GLib.Error;
     public static unowned DesktopAgnostic.Config.Client get_default_for_applet (Awn.Applet applet) throws GLib.Error;
     public static unowned DesktopAgnostic.Config.Client get_default_for_applet_by_info (string name, string uid) throws GLib.Error;
+    public static void set_list_deferred (DesktopAgnostic.Config.Client client, string group, string key, GLib.ValueArray value);
   }
 
   [CCode (cheader_filename = "libawn/awn-utils.h")]
@@ -79,6 +79,10 @@ awn_effect_handle_repeating(AwnEffectsAnimation* anim)
         priv->effect_lock = FALSE;
         priv->timer_id = 0;
 
+        if (priv->redraw_skipped) {
+            awn_effects_redraw(fx);
+        }
+
         if (effect_stopped) {
             // the signal handler can try to destroy us, so make sure it doesn't do
             //   that immediately
@@ -124,6 +128,10 @@ awn_effect_suspend_animation(AwnEffectsAnimation* anim, GSourceFunc func)
     AwnEffectsPrivate* priv = anim->effects->priv;
     priv->sleeping_func = func;
     priv->timer_id = 0;
+
+    if (priv->redraw_skipped) {
+        awn_effects_redraw(anim->effects);
+    }
     return FALSE;
 }
 
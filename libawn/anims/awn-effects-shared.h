@@ -31,6 +31,27 @@ typedef enum {
 
 typedef struct _AwnEffectsAnimation AwnEffectsAnimation;
 
+/* what the cached side face was made from, see awn_effects_post_op_depth() */
+typedef struct {
+    guint content_serial;
+    gint width, height;
+    gint depth;
+    gint direction;
+    GtkPositionType position;
+    cairo_matrix_t matrix;
+    gboolean clip;
+    GtkAllocation clip_region;
+    gint border_clip;
+} AwnEffectsDepthKey;
+
+/* what the cached shadow mask was made from, see
+ * awn_effects_post_op_shadow() */
+typedef struct {
+    AwnEffectsDepthKey content;
+    gint radius;
+    cairo_surface_type_t surface_type;
+} AwnEffectsShadowKey;
+
 struct _AwnEffectsAnimation {
     AwnEffects* effects;
     AwnEffect this_effect;
@@ -76,6 +97,38 @@ struct _AwnEffectsPrivate {
     gint icon_depth;
     gint icon_depth_direction;
 
+    /* see awn_effects_set_content_serial(), 0 means unknown */
+    guint content_serial;
+    /* the transformation set up by the pre-ops */
+    cairo_matrix_t paint_matrix;
+
+    /* extrusion cache, see awn_effects_post_op_depth() */
+    cairo_surface_t* depth_scratch;
+    cairo_surface_t* depth_face;
+    gint depth_face_width;
+    gint depth_face_height;
+    AwnEffectsDepthKey depth_key;
+
+    /* shadow, see awn_effects_post_op_shadow() */
+    DesktopAgnosticColor* shadow_color;
+    gint shadow_radius;
+    gint shadow_offset_x;
+    gint shadow_offset_y;
+    cairo_surface_t* shadow_scratch;
+    cairo_surface_t* shadow_mask;
+    gint shadow_mask_width;
+    gint shadow_mask_height;
+    AwnEffectsShadowKey shadow_key;
+
+    /* reflection */
+    gfloat refl_fade;
+    gboolean refl_compat;
+    cairo_pattern_t* refl_mask;
+    gdouble refl_mask_start;
+    gdouble refl_mask_end;
+    gdouble refl_mask_alpha;
+    gdouble refl_mask_fade;
+
     AwnArrowType arrow_type;
 
     /* State variables */
@@ -86,6 +139,11 @@ struct _AwnEffectsPrivate {
 
     guint timer_id;
     gboolean already_exposed;
+    /* a frame wasn't painted, see awn_effects_redraw() */
+    gboolean redraw_skipped;
+
+    /* statistics, see awn-stats.h */
+    gint64 paint_start;
 };
 
 typedef enum {
@@ -35,6 +35,8 @@
 #include "awn-applet.h"
 #include "awn-utils.h"
 #include "awn-enum-types.h"
+#include "awn-path.h"
+#include "awn-stats.h"
 #include "gseal-transition.h"
 #include "libawn-marshal.h"
 
@@ -68,11 +70,16 @@ struct _AwnAppletPrivate {
     gint origin_x, origin_y;
     gint pos_x, pos_y;
     gint panel_width, panel_height;
+    AwnPathTable path_table;
 
     AwnAppletFlags flags;
 
     DBusGConnection* connection;
     DBusGProxy*      proxy;
+
+    /* set once the panel sends PropertiesChanged batches */
+    gboolean batched_props;
+    guint    props_generation;
 };
 
 enum {
@@ -138,9 +145,43 @@ on_prop_changed(DBusGProxy* proxy, const gchar* prop_name,
                 GValue* value, AwnApplet* applet)
 {
     g_return_if_fail(AWN_IS_APPLET(applet));
+
+    // the same change will arrive in the next PropertiesChanged batch
+    if (applet->priv->batched_props) {
+        return;
+    }
+
     g_object_set_property(G_OBJECT(applet), prop_name, value);
 }
 
+static void
+on_props_changed(DBusGProxy* proxy, guint generation,
+                 GHashTable* props, AwnApplet* applet)
+{
+    AwnAppletPrivate* priv;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_return_if_fail(AWN_IS_APPLET(applet));
+    priv = applet->priv;
+
+    // stale or duplicate batch
+    if (priv->batched_props &&
+            (gint)(generation - priv->props_generation) <= 0) {
+        return;
+    }
+
+    priv->batched_props = TRUE;
+    priv->props_generation = generation;
+
+    g_object_freeze_notify(G_OBJECT(applet));
+    g_hash_table_iter_init(&iter, props);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        g_object_set_property(G_OBJECT(applet), (gchar*)key, (GValue*)value);
+    }
+    g_object_thaw_notify(G_OBJECT(applet));
+}
+
 static void
 on_delete_notify(DBusGProxy* proxy, AwnApplet* applet)
 {
@@ -394,6 +435,13 @@ awn_applet_constructed(GObject* obj)
     AwnApplet* applet = AWN_APPLET(obj);
     AwnAppletPrivate* priv = applet->priv;
 
+    if (priv->connection) {
+        awn_stats_export(priv->connection, priv->canonical_name);
+        if (priv->panel_id > 0) {
+            awn_stats_register_process(priv->connection);
+        }
+    }
+
     if (priv->panel_id > 0) {
         gchar* object_path = g_strdup_printf("/org/awnproject/Awn/Panel%d",
                                              priv->panel_id);
@@ -411,6 +459,12 @@ awn_applet_constructed(GObject* obj)
             G_TYPE_NONE, G_TYPE_STRING, G_TYPE_VALUE,
             G_TYPE_INVALID
         );
+        dbus_g_object_register_marshaller(
+            libawn_marshal_VOID__UINT_BOXED,
+            G_TYPE_NONE, G_TYPE_UINT,
+            dbus_g_type_get_map("GHashTable", G_TYPE_STRING, G_TYPE_VALUE),
+            G_TYPE_INVALID
+        );
 
         dbus_g_proxy_add_signal(priv->proxy, "PositionChanged",
                                 G_TYPE_INT, G_TYPE_INVALID);
@@ -420,6 +474,11 @@ awn_applet_constructed(GObject* obj)
                                 G_TYPE_INT, G_TYPE_INVALID);
         dbus_g_proxy_add_signal(priv->proxy, "PropertyChanged",
                                 G_TYPE_STRING, G_TYPE_VALUE, G_TYPE_INVALID);
+        dbus_g_proxy_add_signal(priv->proxy, "PropertiesChanged",
+                                G_TYPE_UINT,
+                                dbus_g_type_get_map("GHashTable", G_TYPE_STRING,
+                                                    G_TYPE_VALUE),
+                                G_TYPE_INVALID);
         dbus_g_proxy_add_signal(priv->proxy, "DestroyNotify",
                                 G_TYPE_INVALID);
         dbus_g_proxy_add_signal(priv->proxy, "DestroyApplet",
@@ -437,6 +496,9 @@ awn_applet_constructed(GObject* obj)
         dbus_g_proxy_connect_signal(priv->proxy, "PropertyChanged",
                                     G_CALLBACK(on_prop_changed), applet,
                                     NULL);
+        dbus_g_proxy_connect_signal(priv->proxy, "PropertiesChanged",
+                                    G_CALLBACK(on_props_changed), applet,
+                                    NULL);
         dbus_g_proxy_connect_signal(priv->proxy, "DestroyNotify",
                                     G_CALLBACK(on_delete_notify), applet,
                                     NULL);
@@ -493,6 +555,10 @@ awn_applet_constructed(GObject* obj)
                 g_object_set_property(obj, "offset-modifier", value);
             } else if (strcmp(key, "PathType") == 0) {
                 g_object_set_property(obj, "path-type", value);
+            } else if (strcmp(key, "PropertiesGeneration") == 0) {
+                // panel sends batches, ignore the per-property signal
+                priv->batched_props = TRUE;
+                priv->props_generation = g_value_get_uint(value);
             } else {
                 g_warning("Unknown property: \"%s\"", (char*)key);
             }
@@ -627,6 +693,8 @@ awn_applet_finalize(GObject* obj)
 {
     AwnAppletPrivate* priv = AWN_APPLET_GET_PRIVATE(obj);
 
+    awn_path_table_clear(&priv->path_table);
+
     if (priv->connection) {
         if (priv->proxy) {
             g_object_unref(priv->proxy);
@@ -1502,22 +1570,31 @@ gint
 awn_applet_get_offset_at(AwnApplet* applet, gint x, gint y)
 {
     AwnAppletPrivate* priv;
-    gint result;
-    gfloat temp;
+    gint length, pos;
 
     g_return_val_if_fail(AWN_IS_APPLET(applet), 0);
     priv = applet->priv;
 
-    temp = awn_utils_get_offset_modifier_by_path_type(priv->path_type,
-            priv->position,
-            priv->offset,
-            priv->offset_modifier,
-            priv->pos_x + x,
-            priv->pos_y + y,
-            priv->panel_width,
-            priv->panel_height);
-    result = round(temp);
-    return result;
+    if (priv->panel_width == 0 || priv->panel_height == 0) {
+        return priv->offset;
+    }
+
+    switch (priv->position) {
+    case GTK_POS_LEFT:
+    case GTK_POS_RIGHT:
+        length = priv->panel_height;
+        pos = priv->pos_y + y;
+        break;
+    default:
+        length = priv->panel_width;
+        pos = priv->pos_x + x;
+        break;
+    }
+
+    awn_path_table_ensure(&priv->path_table, priv->path_type,
+                          priv->offset, priv->offset_modifier, length);
+
+    return round(awn_path_table_get_offset(&priv->path_table, pos));
 }
 
 /**
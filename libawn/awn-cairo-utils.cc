@@ -26,6 +26,7 @@
 
 #include "awn-cairo-utils.h"
 #include <math.h>
+#include <gdk/gdk.h>
 
 /**
  * awn_cairo_rounded_rect:
@@ -364,3 +365,32 @@ awn_cairo_pattern_add_color_stop_color_with_alpha_multiplier(cairo_pattern_t*
                                       alpha * multiplier);
 }
 
+
+/**
+ * awn_cairo_image_surface_new_from_pixbuf:
+ * @pixbuf: The source pixbuf.
+ *
+ * Converts @pixbuf into a premultiplied ARGB32 image surface of the same
+ * size, so it can be painted repeatedly without converting it every time.
+ *
+ * Returns: a new image surface. Free it with cairo_surface_destroy().
+ */
+cairo_surface_t*
+awn_cairo_image_surface_new_from_pixbuf(GdkPixbuf* pixbuf)
+{
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    g_return_val_if_fail(GDK_IS_PIXBUF(pixbuf), NULL);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         gdk_pixbuf_get_width(pixbuf),
+                                         gdk_pixbuf_get_height(pixbuf));
+    cr = cairo_create(surface);
+    gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return surface;
+}
@@ -28,6 +28,7 @@
 #define __AWN_CAIRO_UTILS_H__
 
 #include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 #include <libdesktop-agnostic/desktop-agnostic.h>
 
 #ifdef __cplusplus
@@ -87,6 +88,9 @@ awn_cairo_pattern_add_color_stop_color_with_alpha_multiplier(cairo_pattern_t*
         DesktopAgnosticColor* color,
         gdouble               multiplier);
 
+cairo_surface_t*
+awn_cairo_image_surface_new_from_pixbuf(GdkPixbuf* pixbuf);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
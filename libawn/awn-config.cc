@@ -21,6 +21,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "awn-config.h"
 
 /**
@@ -40,6 +42,21 @@
 /* The config client cache. */
 static GData* awn_config_clients = NULL;
 
+/* A list write waiting for the next flush. */
+typedef struct {
+    DesktopAgnosticConfigClient* client;
+    gchar* group;
+    gchar* key;
+    GValueArray* value;
+} AwnConfigPendingWrite;
+
+/* Pending writes in the order they were first queued, plus an index by
+ * (client, group, key) so a later write to the same key replaces the
+ * queued value instead of adding another write. */
+static GQueue awn_config_pending = G_QUEUE_INIT;
+static GHashTable* awn_config_pending_index = NULL;
+static guint awn_config_flush_id = 0;
+
 
 static void
 on_config_destroy(gpointer data)
@@ -111,9 +128,239 @@ awn_config_get_default(gint panel_id, GError** error)
 void
 awn_config_free(void)
 {
+    awn_config_flush();
     g_datalist_clear(&awn_config_clients);
 }
 
+static guint
+pending_write_hash(gconstpointer data)
+{
+    const AwnConfigPendingWrite* write = (const AwnConfigPendingWrite*)data;
+
+    return g_direct_hash(write->client) ^
+           (g_str_hash(write->group) * 31 + g_str_hash(write->key));
+}
+
+static gboolean
+pending_write_equal(gconstpointer a, gconstpointer b)
+{
+    const AwnConfigPendingWrite* wa = (const AwnConfigPendingWrite*)a;
+    const AwnConfigPendingWrite* wb = (const AwnConfigPendingWrite*)b;
+
+    return wa->client == wb->client &&
+           strcmp(wa->group, wb->group) == 0 &&
+           strcmp(wa->key, wb->key) == 0;
+}
+
+static void
+pending_write_free(AwnConfigPendingWrite* write)
+{
+    g_object_unref(write->client);
+    g_free(write->group);
+    g_free(write->key);
+    g_value_array_free(write->value);
+    g_slice_free(AwnConfigPendingWrite, write);
+}
+
+static gboolean
+awn_config_value_equal(const GValue* a, const GValue* b)
+{
+    GType type = G_VALUE_TYPE(a);
+
+    if (type != G_VALUE_TYPE(b)) {
+        return FALSE;
+    }
+
+    switch (G_TYPE_FUNDAMENTAL(type)) {
+    case G_TYPE_STRING:
+        return g_strcmp0(g_value_get_string(a), g_value_get_string(b)) == 0;
+    case G_TYPE_BOOLEAN:
+        return !g_value_get_boolean(a) == !g_value_get_boolean(b);
+    case G_TYPE_INT:
+        return g_value_get_int(a) == g_value_get_int(b);
+    case G_TYPE_UINT:
+        return g_value_get_uint(a) == g_value_get_uint(b);
+    case G_TYPE_INT64:
+        return g_value_get_int64(a) == g_value_get_int64(b);
+    case G_TYPE_FLOAT:
+        return g_value_get_float(a) == g_value_get_float(b);
+    case G_TYPE_DOUBLE:
+        return g_value_get_double(a) == g_value_get_double(b);
+    default: {
+        /* anything else (colours...) compares by its printed contents */
+        gchar* ca = g_strdup_value_contents(a);
+        gchar* cb = g_strdup_value_contents(b);
+        gboolean equal = strcmp(ca, cb) == 0;
+
+        g_free(ca);
+        g_free(cb);
+        return equal;
+    }
+    }
+}
+
+static gboolean
+awn_config_list_equal(GValueArray* a, GValueArray* b)
+{
+    guint i;
+
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    if (a->n_values != b->n_values) {
+        return FALSE;
+    }
+
+    for (i = 0; i < a->n_values; i++) {
+        if (!awn_config_value_equal(g_value_array_get_nth(a, i),
+                                    g_value_array_get_nth(b, i))) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void
+awn_config_write_pending(AwnConfigPendingWrite* write)
+{
+    GError* error = NULL;
+    GValueArray* current;
+
+    current = desktop_agnostic_config_client_get_list(write->client,
+              write->group,
+              write->key,
+              &error);
+    if (error) {
+        /* can't tell, so write it */
+        g_error_free(error);
+        error = NULL;
+    } else if (awn_config_list_equal(current, write->value)) {
+        g_value_array_free(current);
+        return;
+    }
+
+    if (current) {
+        g_value_array_free(current);
+    }
+
+    desktop_agnostic_config_client_set_list(write->client,
+                                            write->group, write->key,
+                                            write->value, &error);
+    if (error) {
+        g_warning("Unable to write %s/%s: %s",
+                  write->group, write->key, error->message);
+        g_error_free(error);
+    }
+}
+
+static gboolean
+awn_config_flush_cb(gpointer data)
+{
+    awn_config_flush_id = 0;
+    awn_config_flush();
+
+    return FALSE;
+}
+
+/**
+ * awn_config_set_list_deferred:
+ * @client: The configuration client.
+ * @group: The config group of the key.
+ * @key: The config key.
+ * @value: The new list. It is copied.
+ *
+ * Queues a write of a list-valued setting. All writes queued during one
+ * main loop iteration are flushed together from an idle callback, and only
+ * the last value queued for each client and key is written. A write which
+ * wouldn't change the stored list is dropped, so listeners get at most one
+ * notification per key and batch.
+ *
+ * Reads through @client keep returning the old list until the batch is
+ * flushed, use awn_config_flush() when that matters.
+ */
+void
+awn_config_set_list_deferred(DesktopAgnosticConfigClient* client,
+                             const gchar*                 group,
+                             const gchar*                 key,
+                             GValueArray*                 value)
+{
+    AwnConfigPendingWrite lookup;
+    AwnConfigPendingWrite* write;
+
+    g_return_if_fail(DESKTOP_AGNOSTIC_CONFIG_IS_CLIENT(client));
+    g_return_if_fail(group != NULL && key != NULL);
+    g_return_if_fail(value != NULL);
+
+    if (awn_config_pending_index == NULL) {
+        awn_config_pending_index = g_hash_table_new(pending_write_hash,
+                                   pending_write_equal);
+    }
+
+    lookup.client = client;
+    lookup.group = (gchar*)group;
+    lookup.key = (gchar*)key;
+
+    write = (AwnConfigPendingWrite*)g_hash_table_lookup(awn_config_pending_index,
+            &lookup);
+    if (write) {
+        if (awn_config_list_equal(write->value, value)) {
+            return;
+        }
+        g_value_array_free(write->value);
+        write->value = g_value_array_copy(value);
+        return;
+    }
+
+    write = g_slice_new(AwnConfigPendingWrite);
+    write->client = (DesktopAgnosticConfigClient*)g_object_ref(client);
+    write->group = g_strdup(group);
+    write->key = g_strdup(key);
+    write->value = g_value_array_copy(value);
+
+    g_queue_push_tail(&awn_config_pending, write);
+    g_hash_table_insert(awn_config_pending_index, write, write);
+
+    if (awn_config_flush_id == 0) {
+        awn_config_flush_id = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                                              awn_config_flush_cb,
+                                              NULL, NULL);
+    }
+}
+
+/**
+ * awn_config_flush:
+ *
+ * Immediately writes all the lists queued by awn_config_set_list_deferred().
+ */
+void
+awn_config_flush(void)
+{
+    GList* writes;
+    GList* iter;
+
+    if (awn_config_flush_id) {
+        g_source_remove(awn_config_flush_id);
+        awn_config_flush_id = 0;
+    }
+
+    if (awn_config_pending_index) {
+        g_hash_table_remove_all(awn_config_pending_index);
+    }
+
+    /* steal the queue, the backend notifications can queue new writes */
+    writes = awn_config_pending.head;
+    g_queue_init(&awn_config_pending);
+
+    for (iter = writes; iter != NULL; iter = iter->next) {
+        AwnConfigPendingWrite* write = (AwnConfigPendingWrite*)iter->data;
+
+        awn_config_write_pending(write);
+        pending_write_free(write);
+    }
+    g_list_free(writes);
+}
+
 
 /**
  * awn_config_get_default_for_applet:
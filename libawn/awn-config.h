@@ -33,6 +33,12 @@ DesktopAgnosticConfigClient* awn_config_get_default_for_applet(AwnApplet* applet
 DesktopAgnosticConfigClient* awn_config_get_default_for_applet_by_info(const gchar* name, const gchar* uid, GError** error);
 void                         awn_config_free(void);
 
+void                         awn_config_set_list_deferred(DesktopAgnosticConfigClient* client,
+        const gchar* group,
+        const gchar* key,
+        GValueArray* value);
+void                         awn_config_flush(void);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
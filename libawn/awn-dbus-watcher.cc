@@ -16,8 +16,11 @@
  *
  */
 
+#include <string.h>
+
+#include <dbus/dbus.h>
 #include <dbus/dbus-glib.h>
-#include <dbus/dbus-glib-bindings.h>
+#include <dbus/dbus-glib-lowlevel.h>
 
 #include "awn-dbus-watcher.h"
 
@@ -30,11 +33,32 @@ extern "C" {
 #define AWN_DBUS_WATCHER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE(obj, \
         AWN_TYPE_DBUS_WATCHER, AwnDBusWatcherPrivate))
 
+#define NAME_OWNER_CHANGED_RULE \
+    "type='signal',sender='" DBUS_SERVICE_DBUS "'," \
+    "path='" DBUS_PATH_DBUS "',interface='" DBUS_INTERFACE_DBUS "'," \
+    "member='NameOwnerChanged',arg0='%s'"
+
+#define NAME_OWNER_CHANGED_ANY_RULE \
+    "type='signal',sender='" DBUS_SERVICE_DBUS "'," \
+    "path='" DBUS_PATH_DBUS "',interface='" DBUS_INTERFACE_DBUS "'," \
+    "member='NameOwnerChanged'"
+
 struct _AwnDBusWatcherPrivate {
     DBusGConnection* connection;
-    DBusGProxy* proxy;
+    gboolean filter_added;
+
+    /* only watched names are asked for, see awn_dbus_watcher_set_filtered */
+    gboolean filtered;
+
+    /* watched name -> number of watchers (GUINT_TO_POINTER) */
+    GHashTable* names;
 };
 
+typedef struct {
+    AwnDBusWatcher* watcher;
+    gchar* name;
+} AwnDBusWatcherHandler;
+
 enum {
     NAME_APPEARED,
     NAME_DISAPPEARED,
@@ -45,9 +69,10 @@ enum {
 static guint _dbus_watcher_signals[LAST_SIGNAL] = { 0 };
 
 static void
-on_name_owner_changed(DBusGProxy* proxy,
-                      gchar* name, gchar* old_owner, gchar* new_owner,
-                      AwnDBusWatcher* watcher)
+on_name_owner_changed(AwnDBusWatcher* watcher,
+                      const gchar* name,
+                      const gchar* old_owner,
+                      const gchar* new_owner)
 {
     g_return_if_fail(old_owner && new_owner);
 
@@ -68,6 +93,38 @@ on_name_owner_changed(DBusGProxy* proxy,
     }
 }
 
+static DBusHandlerResult
+awn_dbus_watcher_filter(DBusConnection* connection, DBusMessage* message,
+                        void* user_data)
+{
+    AwnDBusWatcher* watcher = AWN_DBUS_WATCHER(user_data);
+    const gchar* name;
+    const gchar* old_owner;
+    const gchar* new_owner;
+
+    if (!dbus_message_is_signal(message, DBUS_INTERFACE_DBUS,
+                                "NameOwnerChanged") ||
+            g_strcmp0(dbus_message_get_sender(message), DBUS_SERVICE_DBUS) != 0) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    if (dbus_message_get_args(message, NULL,
+                              DBUS_TYPE_STRING, &name,
+                              DBUS_TYPE_STRING, &old_owner,
+                              DBUS_TYPE_STRING, &new_owner,
+                              DBUS_TYPE_INVALID)) {
+        // other parts of the process (dbus-glib proxies) may have their
+        // own rules, only pass on what we were asked for
+        if (!watcher->priv->filtered ||
+                g_hash_table_lookup(watcher->priv->names, name)) {
+            on_name_owner_changed(watcher, name, old_owner, new_owner);
+        }
+    }
+
+    // never steal the message from other filters
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
 static void
 awn_dbus_watcher_init(AwnDBusWatcher* watcher)
 {
@@ -76,6 +133,9 @@ awn_dbus_watcher_init(AwnDBusWatcher* watcher)
 
     watcher->priv = priv;
 
+    priv->names = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                        g_free, NULL);
+
     priv->connection = dbus_g_bus_get(DBUS_BUS_SESSION, &error);
     if (error != NULL) {
         g_warning("Unable to make connection to the D-Bus session bus: %s",
@@ -84,20 +144,15 @@ awn_dbus_watcher_init(AwnDBusWatcher* watcher)
         return;
     }
 
-    priv->proxy = dbus_g_proxy_new_for_name(priv->connection,
-                                            "org.freedesktop.DBus",
-                                            "/org/freedesktop/DBus",
-                                            "org.freedesktop.DBus");
-
-    g_return_if_fail(priv->proxy);
-
-    dbus_g_proxy_add_signal(priv->proxy, "NameOwnerChanged",
-                            G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
-                            G_TYPE_INVALID);
+    priv->filter_added =
+        dbus_connection_add_filter(dbus_g_connection_get_connection(priv->connection),
+                                   awn_dbus_watcher_filter, watcher, NULL);
 
-    dbus_g_proxy_connect_signal(priv->proxy, "NameOwnerChanged",
-                                G_CALLBACK(on_name_owner_changed), watcher,
-                                NULL);
+    /* Handlers connected with a plain g_signal_connect() don't watch their
+     * name, so until we're told otherwise every change is asked for.
+     */
+    dbus_bus_add_match(dbus_g_connection_get_connection(priv->connection),
+                       NAME_OWNER_CHANGED_ANY_RULE, NULL);
 }
 
 static void
@@ -105,16 +160,33 @@ awn_dbus_watcher_finalize(GObject* object)
 {
     AwnDBusWatcherPrivate* priv = AWN_DBUS_WATCHER_GET_PRIVATE(object);
 
-    if (priv->proxy) {
-        g_object_unref(priv->proxy);
-        priv->proxy = NULL;
-    }
-
     if (priv->connection) {
+        DBusConnection* conn = dbus_g_connection_get_connection(priv->connection);
+        GHashTableIter iter;
+        gpointer name;
+
+        g_hash_table_iter_init(&iter, priv->names);
+        while (g_hash_table_iter_next(&iter, &name, NULL)) {
+            gchar* rule = g_strdup_printf(NAME_OWNER_CHANGED_RULE,
+                                          (gchar*)name);
+            dbus_bus_remove_match(conn, rule, NULL);
+            g_free(rule);
+        }
+
+        if (!priv->filtered) {
+            dbus_bus_remove_match(conn, NAME_OWNER_CHANGED_ANY_RULE, NULL);
+        }
+
+        if (priv->filter_added) {
+            dbus_connection_remove_filter(conn, awn_dbus_watcher_filter, object);
+        }
+
         dbus_g_connection_unref(priv->connection);
         priv->connection = NULL;
     }
 
+    g_hash_table_destroy(priv->names);
+
     singleton_instance = NULL;
 
     G_OBJECT_CLASS(awn_dbus_watcher_parent_class)->finalize(object);
@@ -164,21 +236,200 @@ awn_dbus_watcher_get_default(void)
 }
 
 
+/**
+ * awn_dbus_watcher_has_name:
+ * @self: The #AwnDBusWatcher.
+ * @name: A D-Bus name.
+ *
+ * Returns: %TRUE if @name currently has an owner on the session bus.
+ */
 gboolean
 awn_dbus_watcher_has_name(AwnDBusWatcher* self, const gchar* name)
 {
     AwnDBusWatcherPrivate* priv = AWN_DBUS_WATCHER_GET_PRIVATE(self);
-    GError* error = NULL;
-    gboolean success, has_owner;
+    DBusError error;
+    gboolean has_owner;
+
+    g_return_val_if_fail(priv->connection, FALSE);
 
-    success = dbus_g_proxy_call(priv->proxy, "NameHasOwner", &error, G_TYPE_STRING, name, G_TYPE_INVALID, G_TYPE_BOOLEAN, &has_owner, G_TYPE_INVALID);
+    dbus_error_init(&error);
+    has_owner = dbus_bus_name_has_owner(
+                    dbus_g_connection_get_connection(priv->connection),
+                    name, &error);
 
-    if (!success) {
+    if (dbus_error_is_set(&error)) {
         g_warning("Unable to make get dbus connections: %s",
-                  error->message);
-        g_error_free(error);
+                  error.message);
+        dbus_error_free(&error);
         return FALSE;
     }
 
     return has_owner;
 }
+
+/**
+ * awn_dbus_watcher_watch_name:
+ * @self: The #AwnDBusWatcher.
+ * @name: A D-Bus name (unique or well-known).
+ *
+ * Asks the bus to deliver ownership changes of @name, so that the
+ * "name-appeared" and "name-disappeared" signals are emitted for it. Calls
+ * are reference counted, each of them has to be balanced by a call to
+ * awn_dbus_watcher_unwatch_name(). Once the watcher is filtered (see
+ * awn_dbus_watcher_set_filtered()) signals are emitted only for watched
+ * names, awn_dbus_watcher_connect() takes care of this automatically.
+ */
+void
+awn_dbus_watcher_watch_name(AwnDBusWatcher* self, const gchar* name)
+{
+    AwnDBusWatcherPrivate* priv;
+    guint count;
+
+    g_return_if_fail(AWN_IS_DBUS_WATCHER(self));
+    g_return_if_fail(name != NULL);
+
+    priv = self->priv;
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(priv->names, name));
+
+    if (count == 0 && priv->connection) {
+        gchar* rule = g_strdup_printf(NAME_OWNER_CHANGED_RULE, name);
+        // no DBusError means we don't block waiting for the reply
+        dbus_bus_add_match(dbus_g_connection_get_connection(priv->connection),
+                           rule, NULL);
+        g_free(rule);
+    }
+
+    g_hash_table_insert(priv->names, g_strdup(name),
+                        GUINT_TO_POINTER(count + 1));
+}
+
+/**
+ * awn_dbus_watcher_unwatch_name:
+ * @self: The #AwnDBusWatcher.
+ * @name: A D-Bus name previously passed to awn_dbus_watcher_watch_name().
+ *
+ * Drops one reference to the watch of @name, when the last one is gone
+ * the bus stops sending us its ownership changes.
+ */
+void
+awn_dbus_watcher_unwatch_name(AwnDBusWatcher* self, const gchar* name)
+{
+    AwnDBusWatcherPrivate* priv;
+    guint count;
+
+    g_return_if_fail(AWN_IS_DBUS_WATCHER(self));
+    g_return_if_fail(name != NULL);
+
+    priv = self->priv;
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(priv->names, name));
+    g_return_if_fail(count > 0);
+
+    if (count > 1) {
+        g_hash_table_insert(priv->names, g_strdup(name),
+                            GUINT_TO_POINTER(count - 1));
+        return;
+    }
+
+    g_hash_table_remove(priv->names, name);
+
+    if (priv->connection) {
+        gchar* rule = g_strdup_printf(NAME_OWNER_CHANGED_RULE, name);
+        dbus_bus_remove_match(dbus_g_connection_get_connection(priv->connection),
+                              rule, NULL);
+        g_free(rule);
+    }
+}
+
+/**
+ * awn_dbus_watcher_set_filtered:
+ * @self: The #AwnDBusWatcher.
+ * @filtered: Whether only watched names should be delivered.
+ *
+ * By default the watcher asks the bus for every name ownership change, so
+ * handlers connected with g_signal_connect() to "name-appeared::<name>"
+ * keep working without watching their name. A process which connects all
+ * of its handlers with awn_dbus_watcher_connect() (or watches the names
+ * with awn_dbus_watcher_watch_name()) can set @filtered to %TRUE, after
+ * which it is woken up only for the names it watches. The setting applies
+ * to the whole process, as the watcher is shared.
+ */
+void
+awn_dbus_watcher_set_filtered(AwnDBusWatcher* self, gboolean filtered)
+{
+    AwnDBusWatcherPrivate* priv;
+
+    g_return_if_fail(AWN_IS_DBUS_WATCHER(self));
+
+    priv = self->priv;
+    filtered = filtered != FALSE;
+
+    if (priv->filtered == filtered) {
+        return;
+    }
+    priv->filtered = filtered;
+
+    if (priv->connection) {
+        DBusConnection* conn = dbus_g_connection_get_connection(priv->connection);
+
+        if (filtered) {
+            dbus_bus_remove_match(conn, NAME_OWNER_CHANGED_ANY_RULE, NULL);
+        } else {
+            dbus_bus_add_match(conn, NAME_OWNER_CHANGED_ANY_RULE, NULL);
+        }
+    }
+}
+
+static void
+awn_dbus_watcher_handler_invalidated(gpointer data, GClosure* closure)
+{
+    AwnDBusWatcherHandler* handler = (AwnDBusWatcherHandler*)data;
+
+    awn_dbus_watcher_unwatch_name(handler->watcher, handler->name);
+
+    g_free(handler->name);
+    g_free(handler);
+}
+
+/**
+ * awn_dbus_watcher_connect:
+ * @self: The #AwnDBusWatcher.
+ * @detailed_signal: "name-appeared::<name>" or "name-disappeared::<name>".
+ * @callback: The callback to connect.
+ * @data: Data to pass to @callback.
+ *
+ * Connects @callback to @detailed_signal and watches the name in the signal
+ * detail for as long as the handler stays connected. Handlers can be
+ * disconnected the usual way (for example with
+ * g_signal_handlers_disconnect_by_func()).
+ *
+ * Returns: the handler id.
+ */
+gulong
+awn_dbus_watcher_connect(AwnDBusWatcher* self,
+                         const gchar* detailed_signal,
+                         GCallback callback,
+                         gpointer data)
+{
+    AwnDBusWatcherHandler* handler;
+    const gchar* name;
+    GClosure* closure;
+
+    g_return_val_if_fail(AWN_IS_DBUS_WATCHER(self), 0);
+    g_return_val_if_fail(detailed_signal != NULL, 0);
+
+    name = strstr(detailed_signal, "::");
+    g_return_val_if_fail(name != NULL && name[2] != '\0', 0);
+    name += 2;
+
+    closure = g_cclosure_new(callback, data, NULL);
+
+    handler = g_new(AwnDBusWatcherHandler, 1);
+    handler->watcher = self;
+    handler->name = g_strdup(name);
+    awn_dbus_watcher_watch_name(self, name);
+
+    g_closure_add_invalidate_notifier(closure, handler,
+                                      awn_dbus_watcher_handler_invalidated);
+
+    return g_signal_connect_closure(self, detailed_signal, closure, FALSE);
+}
@@ -72,6 +72,15 @@ GType    awn_dbus_watcher_get_type(void) G_GNUC_CONST;
 AwnDBusWatcher* awn_dbus_watcher_get_default(void);
 gboolean awn_dbus_watcher_has_name(AwnDBusWatcher* self, const gchar* name);
 
+void     awn_dbus_watcher_watch_name(AwnDBusWatcher* self, const gchar* name);
+void     awn_dbus_watcher_unwatch_name(AwnDBusWatcher* self, const gchar* name);
+void     awn_dbus_watcher_set_filtered(AwnDBusWatcher* self, gboolean filtered);
+
+gulong   awn_dbus_watcher_connect(AwnDBusWatcher* self,
+                                  const gchar* detailed_signal,
+                                  GCallback callback,
+                                  gpointer data);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
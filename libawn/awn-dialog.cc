@@ -36,6 +36,7 @@
 #include "awn-defines.h"
 #include "awn-utils.h"
 #include "awn-overlayable.h"
+#include "awn-stats.h"
 
 #include "gseal-transition.h"
 
@@ -47,6 +48,16 @@ extern "C" {
     AWN_TYPE_DIALOG, \
     AwnDialogPrivate))
 
+/* Everything the chrome and the shape mask depend on, besides the colours */
+typedef struct {
+    gint width, height;
+    gint arrow;          /* -1 if there's no arrow */
+    gint padding;
+    gint title_height;   /* -1 if the title is hidden */
+    GtkPositionType position;
+    gboolean composited;
+} AwnDialogGeometry;
+
 struct _AwnDialogPrivate {
     GtkWidget* hbox;
     GtkWidget* title;
@@ -86,6 +97,13 @@ struct _AwnDialogPrivate {
     gint a_old_x, a_old_y, a_old_w, a_old_h;
 
     gint last_x, last_y;
+
+    /* background, borders, arrow and shadow, painted for chrome_geometry */
+    cairo_surface_t* chrome;
+    AwnDialogGeometry chrome_geometry;
+
+    gboolean mask_valid;
+    AwnDialogGeometry mask_geometry;
 };
 
 enum {
@@ -153,6 +171,7 @@ _on_composited_changed(GtkWidget* widget, gpointer data)
     } else {
         gtk_widget_input_shape_combine_mask(widget, NULL, 0, 0);
     }
+    AWN_DIALOG(widget)->priv->mask_valid = FALSE;
 
     gtk_widget_get_allocation(widget, &alloc);
     awn_dialog_set_masks(widget, alloc.width, alloc.height);
@@ -179,45 +198,119 @@ _on_window_state_event(GtkWidget* dialog, GdkEventWindowState* event)
     return FALSE;
 }
 
-static void
-awn_dialog_paint_border_path(AwnDialog* dialog, cairo_t* cr,
-                             gint width, gint height)
+/*
+ * Returns position of the arrow point along the edge facing the anchor,
+ *  in the coordinates awn_dialog_paint_border_path() rotates to, or -1 if
+ *  the dialog doesn't have an arrow.
+ */
+static gint
+awn_dialog_get_arrow(AwnDialog* dialog, gint width, gint height)
 {
-    AwnDialogPrivate* priv = AWN_DIALOG_GET_PRIVATE(dialog);
+    AwnDialogPrivate* priv = dialog->priv;
 
     const int BORDER = priv->window_padding * 3 / 4;
     const int ROUND_RADIUS = priv->window_padding / 2;
 
+    GdkPoint a_center_point = { .x = 0, .y = 0 };
+    GdkPoint o_center_point = { .x = 0, .y = 0 };
+    gint arrow, length, aw = 0, ah = 0;
+    GdkWindow* win;
+
     /* FIXME: mhr3: I couldn't get the shape mask to work in non-composited env,
      *  so I disabled the arrow painting there, anyone feel free to fix it :)
      */
-    if (priv->anchor && priv->anchored &&
-            gtk_widget_get_window(priv->anchor) &&
-            gtk_widget_is_composited(GTK_WIDGET(dialog))) {
-        GdkPoint arrow;
-        GdkPoint a_center_point = { .x = 0, .y = 0 };
-        GdkPoint o_center_point = { .x = 0, .y = 0 };
-        gint temp, aw = 0, ah = 0;
-        GdkWindow* win;
-
-        /* Calculate position of the arrow point
-         *   1) get anchored window center point in root window coordinates
-         *   2) get our origin in root window coordinates
-         *   3) calc the difference (which is different for each position)
-         */
-        win = gtk_widget_get_window(priv->anchor);
-        g_return_if_fail(win);
+    if (!priv->anchor || !priv->anchored ||
+            !gtk_widget_is_composited(GTK_WIDGET(dialog))) {
+        return -1;
+    }
+
+    win = gtk_widget_get_window(priv->anchor);
+    if (!win) {
+        return -1;
+    }
 
-        gdk_window_get_origin(win, &a_center_point.x, &a_center_point.y);
-        gdk_drawable_get_size(GDK_DRAWABLE(win), &aw, &ah);
+    /* Calculate position of the arrow point
+     *   1) get anchored window center point in root window coordinates
+     *   2) get our origin in root window coordinates
+     *   3) calc the difference (which is different for each position)
+     */
+    gdk_window_get_origin(win, &a_center_point.x, &a_center_point.y);
+    gdk_drawable_get_size(GDK_DRAWABLE(win), &aw, &ah);
 
-        a_center_point.x += aw / 2;
-        a_center_point.y += ah / 2;
+    a_center_point.x += aw / 2;
+    a_center_point.y += ah / 2;
 
-        if (gtk_widget_get_realized(GTK_WIDGET(dialog))) {
-            gdk_window_get_origin(gtk_widget_get_window(GTK_WIDGET(dialog)),
-                                  &o_center_point.x, &o_center_point.y);
-        }
+    if (gtk_widget_get_realized(GTK_WIDGET(dialog))) {
+        gdk_window_get_origin(gtk_widget_get_window(GTK_WIDGET(dialog)),
+                              &o_center_point.x, &o_center_point.y);
+    }
+
+    switch (priv->position) {
+    case GTK_POS_LEFT:
+        length = height;
+        arrow = a_center_point.y - o_center_point.y;
+        break;
+    case GTK_POS_RIGHT:
+        length = height;
+        arrow = length - (a_center_point.y - o_center_point.y);
+        break;
+    case GTK_POS_TOP:
+        length = width;
+        arrow = length - (a_center_point.x - o_center_point.x);
+        break;
+    case GTK_POS_BOTTOM:
+    default:
+        length = width;
+        arrow = a_center_point.x - o_center_point.x;
+        break;
+    }
+
+    /* Make sure we paint the arrow in our window */
+    if (BORDER * 2 + ROUND_RADIUS > length - (BORDER * 2 + ROUND_RADIUS)) {
+        return length / 2;
+    }
+
+    return CLAMP(arrow, BORDER * 2 + ROUND_RADIUS,
+                 length - (BORDER * 2 + ROUND_RADIUS));
+}
+
+static void
+awn_dialog_get_geometry(AwnDialog* dialog, gint width, gint height,
+                        AwnDialogGeometry* geometry)
+{
+    AwnDialogPrivate* priv = dialog->priv;
+
+    geometry->width = width;
+    geometry->height = height;
+    geometry->arrow = awn_dialog_get_arrow(dialog, width, height);
+    geometry->padding = priv->window_padding;
+    geometry->title_height = -1;
+    geometry->position = priv->position;
+    geometry->composited = gtk_widget_is_composited(GTK_WIDGET(dialog));
+}
+
+static gboolean
+awn_dialog_geometry_equal(const AwnDialogGeometry* a,
+                          const AwnDialogGeometry* b)
+{
+    return a->width == b->width && a->height == b->height &&
+           a->arrow == b->arrow && a->padding == b->padding &&
+           a->title_height == b->title_height &&
+           a->position == b->position && a->composited == b->composited;
+}
+
+static void
+awn_dialog_paint_border_path(AwnDialog* dialog, cairo_t* cr,
+                             gint width, gint height, gint arrow_x)
+{
+    AwnDialogPrivate* priv = AWN_DIALOG_GET_PRIVATE(dialog);
+
+    const int BORDER = priv->window_padding * 3 / 4;
+    const int ROUND_RADIUS = priv->window_padding / 2;
+
+    if (arrow_x >= 0) {
+        GdkPoint arrow;
+        gint temp;
 
         switch (priv->position) {
         case GTK_POS_LEFT:
@@ -226,8 +319,6 @@ awn_dialog_paint_border_path(AwnDialog* dialog, cairo_t* cr,
             temp = width;
             width = height;
             height = temp;
-
-            arrow.x = a_center_point.y - o_center_point.y;
             break;
         case GTK_POS_RIGHT:
             cairo_translate(cr, 0.0, height);
@@ -235,27 +326,16 @@ awn_dialog_paint_border_path(AwnDialog* dialog, cairo_t* cr,
             temp = width;
             width = height;
             height = temp;
-
-            arrow.x = width - (a_center_point.y - o_center_point.y);
             break;
         case GTK_POS_TOP:
             cairo_translate(cr, width, height);
             cairo_rotate(cr, M_PI);
-
-            arrow.x = width - (a_center_point.x - o_center_point.x);
             break;
         case GTK_POS_BOTTOM:
         default:
-            arrow.x = a_center_point.x - o_center_point.x;
             break;
         }
-        /* Make sure we paint the arrow in our window */
-        if (BORDER * 2 + ROUND_RADIUS > width - (BORDER * 2 + ROUND_RADIUS)) {
-            arrow.x = width / 2;
-        } else {
-            arrow.x = CLAMP(arrow.x, BORDER * 2 + ROUND_RADIUS,
-                            width - (BORDER * 2 + ROUND_RADIUS));
-        }
+        arrow.x = arrow_x;
         arrow.y = height - BORDER;
 
         GdkPoint top_left  = { .x = BORDER, .y = BORDER };
@@ -356,36 +436,13 @@ _real_hide(GtkWidget* widget)
     }
 }
 
-static gboolean
-_expose_event(GtkWidget* widget, GdkEventExpose* expose)
+static void
+awn_dialog_paint_chrome(AwnDialog* dialog, cairo_t* cr,
+                        gint width, gint height, gint arrow_x)
 {
-    AwnDialog* dialog;
-    AwnDialogPrivate* priv;
-    GtkWidget* child;
-    cairo_t* cr = NULL;
+    AwnDialogPrivate* priv = dialog->priv;
     cairo_path_t* path = NULL;
-    GtkAllocation alloc;
-    gint width, height;
-
-    dialog = AWN_DIALOG(widget);
-    priv = dialog->priv;
 
-    cr = gdk_cairo_create(gtk_widget_get_window(widget));
-
-    g_return_val_if_fail(cr, FALSE);
-
-    gtk_widget_get_allocation(widget, &alloc);
-    width = alloc.width;
-    height = alloc.height;
-
-    gdk_cairo_region(cr, expose->region);
-    cairo_clip(cr);
-
-    /* Clear the background to transparent */
-    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(cr);
-
-    /* draw everything else over transparent background */
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     cairo_set_line_width(cr, 1.0);
     cairo_translate(cr, 0.5, 0.5);
@@ -393,7 +450,7 @@ _expose_event(GtkWidget* widget, GdkEventExpose* expose)
     /* background shading */
     awn_cairo_set_source_color(cr, priv->dialog_bg);
 
-    awn_dialog_paint_border_path(dialog, cr, width, height);
+    awn_dialog_paint_border_path(dialog, cr, width, height, arrow_x);
     path = cairo_copy_path(cr);
     cairo_fill(cr);
 
@@ -488,7 +545,8 @@ _expose_event(GtkWidget* widget, GdkEventExpose* expose)
 
     /* draw shadow */
     // FIXME: add property to disable it? (setting padding to <= 1 will do it now)
-    if (gtk_widget_is_composited(widget) && priv->window_padding > 1) {
+    if (gtk_widget_is_composited(GTK_WIDGET(dialog)) &&
+            priv->window_padding > 1) {
         const double SHADOW_RADIUS = MIN(priv->window_padding / 2, 15);
 
         int w, h;
@@ -524,6 +582,94 @@ _expose_event(GtkWidget* widget, GdkEventExpose* expose)
     }
 
     cairo_path_destroy(path);
+}
+
+/*
+ * Returns the chrome for the current geometry, it's painted only when
+ *  the size, position, arrow or title changes, or after
+ *  awn_dialog_invalidate_chrome().
+ */
+static cairo_surface_t*
+awn_dialog_get_chrome(AwnDialog* dialog, cairo_t* target,
+                      gint width, gint height)
+{
+    AwnDialogPrivate* priv = dialog->priv;
+    AwnDialogGeometry geometry;
+    cairo_t* cr;
+
+    awn_dialog_get_geometry(dialog, width, height, &geometry);
+
+    if (gtk_widget_get_visible(priv->title)) {
+        GtkAllocation title_alloc;
+
+        gtk_widget_get_allocation(priv->title, &title_alloc);
+        geometry.title_height = title_alloc.height;
+    }
+
+    if (priv->chrome &&
+            awn_dialog_geometry_equal(&geometry, &priv->chrome_geometry)) {
+        return priv->chrome;
+    }
+
+    if (priv->chrome) {
+        cairo_surface_destroy(priv->chrome);
+    }
+
+    priv->chrome = cairo_surface_create_similar(cairo_get_target(target),
+                   CAIRO_CONTENT_COLOR_ALPHA,
+                   width, height);
+    priv->chrome_geometry = geometry;
+
+    cr = cairo_create(priv->chrome);
+    awn_dialog_paint_chrome(dialog, cr, width, height, geometry.arrow);
+    cairo_destroy(cr);
+
+    AWN_STATS_COUNT(AWN_STATS_DIALOG_CHROME_RENDER);
+
+    return priv->chrome;
+}
+
+static void
+awn_dialog_invalidate_chrome(AwnDialog* dialog)
+{
+    AwnDialogPrivate* priv = dialog->priv;
+
+    if (priv->chrome) {
+        cairo_surface_destroy(priv->chrome);
+        priv->chrome = NULL;
+    }
+}
+
+static gboolean
+_expose_event(GtkWidget* widget, GdkEventExpose* expose)
+{
+    AwnDialog* dialog;
+    GtkWidget* child;
+    cairo_t* cr = NULL;
+    cairo_surface_t* chrome;
+    GtkAllocation alloc;
+
+    dialog = AWN_DIALOG(widget);
+
+    cr = gdk_cairo_create(gtk_widget_get_window(widget));
+
+    g_return_val_if_fail(cr, FALSE);
+
+    gtk_widget_get_allocation(widget, &alloc);
+
+    chrome = awn_dialog_get_chrome(dialog, cr, alloc.width, alloc.height);
+
+    gdk_cairo_region(cr, expose->region);
+    cairo_clip(cr);
+
+    /* The chrome is painted over a transparent background, so it replaces
+     *  the damaged area completely
+     */
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, chrome, 0.0, 0.0);
+    cairo_paint(cr);
+
+    AWN_STATS_COUNT(AWN_STATS_DIALOG_CHROME_BLIT);
 
     /* Clean up */
     cairo_destroy(cr);
@@ -607,7 +753,18 @@ _on_active_changed(GObject* dialog, GParamSpec* spec, gpointer null)
 static void
 awn_dialog_set_masks(GtkWidget* widget, gint width, gint height)
 {
+    AwnDialogPrivate* priv = AWN_DIALOG(widget)->priv;
+    AwnDialogGeometry geometry;
     GdkBitmap* shaped_bitmap;
+
+    /* the title isn't part of the outline */
+    awn_dialog_get_geometry(AWN_DIALOG(widget), width, height, &geometry);
+
+    if (priv->mask_valid &&
+            awn_dialog_geometry_equal(&geometry, &priv->mask_geometry)) {
+        return;
+    }
+
     shaped_bitmap = (GdkBitmap*) gdk_pixmap_new(NULL, width, height, 1);
 
     if (shaped_bitmap) {
@@ -619,7 +776,8 @@ awn_dialog_set_masks(GtkWidget* widget, gint width, gint height)
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
         cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
         cairo_translate(cr, 0.5, 0.5);
-        awn_dialog_paint_border_path(AWN_DIALOG(widget), cr, width, height);
+        awn_dialog_paint_border_path(AWN_DIALOG(widget), cr, width, height,
+                                     geometry.arrow);
 
         cairo_fill_preserve(cr);
         cairo_set_line_width(cr, 1.0);
@@ -636,6 +794,11 @@ awn_dialog_set_masks(GtkWidget* widget, gint width, gint height)
         }
 
         g_object_unref(shaped_bitmap);
+
+        priv->mask_geometry = geometry;
+        priv->mask_valid = TRUE;
+
+        AWN_STATS_COUNT(AWN_STATS_DIALOG_MASKS);
     }
 }
 
@@ -851,6 +1014,7 @@ awn_dialog_set_property(GObject*      object,
             g_object_unref(priv->dialog_bg);
         }
         priv->dialog_bg = (DesktopAgnosticColor*)g_value_dup_object(value);
+        awn_dialog_invalidate_chrome(AWN_DIALOG(object));
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
     case PROP_TITLE_BG:
@@ -858,6 +1022,7 @@ awn_dialog_set_property(GObject*      object,
             g_object_unref(priv->title_bg);
         }
         priv->title_bg = (DesktopAgnosticColor*)g_value_dup_object(value);
+        awn_dialog_invalidate_chrome(AWN_DIALOG(object));
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
     case PROP_BORDER:
@@ -865,6 +1030,7 @@ awn_dialog_set_property(GObject*      object,
             g_object_unref(priv->border_color);
         }
         priv->border_color = (DesktopAgnosticColor*)g_value_dup_object(value);
+        awn_dialog_invalidate_chrome(AWN_DIALOG(object));
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
     case PROP_HILIGHT:
@@ -872,6 +1038,7 @@ awn_dialog_set_property(GObject*      object,
             g_object_unref(priv->hilight_color);
         }
         priv->hilight_color = (DesktopAgnosticColor*)g_value_dup_object(value);
+        awn_dialog_invalidate_chrome(AWN_DIALOG(object));
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
 
@@ -948,6 +1115,11 @@ awn_dialog_finalize(GObject* object)
         priv->hilight_color = NULL;
     }
 
+    if (priv->chrome) {
+        cairo_surface_destroy(priv->chrome);
+        priv->chrome = NULL;
+    }
+
     G_OBJECT_CLASS(awn_dialog_parent_class)->finalize(object);
 }
 
@@ -1157,6 +1329,10 @@ awn_dialog_init(AwnDialog* dialog)
 
     gtk_box_pack_start(GTK_BOX(priv->vbox), priv->title, TRUE, TRUE, 0);
 
+    /* the title separator uses the title's text colour */
+    g_signal_connect_swapped(priv->title, "style-set",
+                             G_CALLBACK(awn_dialog_invalidate_chrome), dialog);
+
     /* See if the title has been set */
     g_signal_connect(dialog, "notify::title",
                      G_CALLBACK(_on_title_notify), NULL);
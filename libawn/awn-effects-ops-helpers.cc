@@ -20,6 +20,7 @@
  */
 
 #include "awn-effects-ops-helpers.h"
+#include "awn-surface-pool.h"
 
 
 void
@@ -220,9 +221,8 @@ lighten_surface(cairo_surface_t* src,
 
     g_return_if_fail(src);
 
-    temp_srfc = cairo_surface_create_similar(src,
-                CAIRO_CONTENT_COLOR_ALPHA,
-                surface_width, surface_height);
+    temp_srfc = awn_surface_pool_borrow(src, CAIRO_CONTENT_COLOR_ALPHA,
+                                        surface_width, surface_height);
     temp_ctx = cairo_create(temp_srfc);
     cairo_set_operator(temp_ctx, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_surface(temp_ctx, src, 0, 0);
@@ -245,7 +245,7 @@ lighten_surface(cairo_surface_t* src,
     cairo_paint_with_alpha(temp_ctx, CLAMP(amount * 0.1825, 0.0, 1.0));
 
     cairo_destroy(temp_ctx);
-    cairo_surface_destroy(temp_srfc);
+    awn_surface_pool_return(temp_srfc);
 }
 
 void
@@ -277,16 +277,15 @@ blur_surface_shadow_rgba(cairo_surface_t* src,
     g_return_if_fail(src);
 
     /* the original stuff */
-    temp_srfc = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                                           surface_width, surface_height);
+    temp_srfc = awn_surface_pool_borrow_image(surface_width, surface_height);
     temp_ctx = cairo_create(temp_srfc);
     cairo_set_operator(temp_ctx, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_surface(temp_ctx, src, 0, 0);
     cairo_paint(temp_ctx);
 
     /* the stuff we draw to */
-    temp_srfc_dest = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                     surface_width, surface_height);
+    temp_srfc_dest = awn_surface_pool_borrow_image(surface_width,
+                     surface_height);
     temp_ctx_dest = cairo_create(temp_srfc_dest);
     /* --- */
 
@@ -387,10 +386,93 @@ blur_surface_shadow_rgba(cairo_surface_t* src,
     g_assert(cairo_get_operator(temp_ctx) == CAIRO_OPERATOR_SOURCE);
     cairo_set_source_surface(temp_ctx, temp_srfc, 0, 0);
     cairo_paint(temp_ctx);
-    cairo_surface_destroy(temp_srfc);
-    cairo_surface_destroy(temp_srfc_dest);
     cairo_destroy(temp_ctx);
     cairo_destroy(temp_ctx_dest);
+    awn_surface_pool_return(temp_srfc);
+    awn_surface_pool_return(temp_srfc_dest);
+}
+
+/* one pass of the box filter used by blur_surface_shadow_rgba(), pixels
+ * outside of the line are the same as the edge ones */
+static inline void
+blur_alpha_line(const guchar* src, gint src_step,
+                guchar* dest, gint dest_step,
+                gint length, const int radius)
+{
+    const int kernel_size = radius * 2 + 1;
+    int total = src[0] * (radius + 1);
+    gint i;
+
+    for (i = 1; i <= MIN(radius, length - 1); i++) {
+        total += src[i * src_step];
+    }
+
+    for (i = 0; i < length; i++) {
+        if (i > 0) {
+            total -= src[MAX(i - radius - 1, 0) * src_step];
+            total += src[MIN(i + radius, length - 1) * src_step];
+        }
+        dest[i * dest_step] = (guchar)(total / kernel_size);
+    }
+}
+
+/*
+ * blur_alpha_surface:
+ * @src: A8 image surface.
+ * @dest: A8 image surface of the same size as @src.
+ * @radius: Radius of the blur.
+ *
+ * Blurs @src into @dest with the same box filter blur_surface_shadow_rgba()
+ * applies to the alpha channel, but only touches a single byte per pixel.
+ */
+void
+blur_alpha_surface(cairo_surface_t* src, cairo_surface_t* dest,
+                   const int radius)
+{
+    cairo_surface_t* temp_srfc;
+    const guchar* src_data;
+    guchar* temp_data;
+    guchar* dest_data;
+    gint width, height, src_stride, temp_stride, dest_stride;
+    gint x, y;
+
+    g_return_if_fail(cairo_image_surface_get_format(src) == CAIRO_FORMAT_A8);
+    g_return_if_fail(cairo_image_surface_get_format(dest) == CAIRO_FORMAT_A8);
+
+    width = cairo_image_surface_get_width(src);
+    height = cairo_image_surface_get_height(src);
+    g_return_if_fail(cairo_image_surface_get_width(dest) == width &&
+                     cairo_image_surface_get_height(dest) == height);
+
+    temp_srfc = awn_surface_pool_borrow(src, CAIRO_CONTENT_ALPHA,
+                                        width, height);
+
+    cairo_surface_flush(src);
+    cairo_surface_flush(temp_srfc);
+    cairo_surface_flush(dest);
+
+    src_data = cairo_image_surface_get_data(src);
+    src_stride = cairo_image_surface_get_stride(src);
+    temp_data = cairo_image_surface_get_data(temp_srfc);
+    temp_stride = cairo_image_surface_get_stride(temp_srfc);
+    dest_data = cairo_image_surface_get_data(dest);
+    dest_stride = cairo_image_surface_get_stride(dest);
+
+    for (y = 0; y < height; y++) {
+        blur_alpha_line(src_data + y * src_stride, 1,
+                        temp_data + y * temp_stride, 1,
+                        width, radius);
+    }
+
+    for (x = 0; x < width; x++) {
+        blur_alpha_line(temp_data + x, temp_stride,
+                        dest_data + x, dest_stride,
+                        height, radius);
+    }
+
+    cairo_surface_mark_dirty(dest);
+
+    awn_surface_pool_return(temp_srfc);
 }
 
 /**
@@ -440,10 +522,9 @@ surface_saturate_and_pixelate(cairo_surface_t* src,
     g_return_if_fail(cairo_xlib_surface_get_width(src) ==
                      cairo_xlib_surface_get_width(dest));
 
-    temp_dest_srfc = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                     cairo_xlib_surface_get_width(dest),
-                     cairo_xlib_surface_get_height(dest)
-                                               );
+    temp_dest_srfc = awn_surface_pool_borrow_image(
+                         cairo_xlib_surface_get_width(dest),
+                         cairo_xlib_surface_get_height(dest));
     temp_dest_ctx = cairo_create(temp_dest_srfc);
     cairo_set_source_surface(temp_dest_ctx, dest, 0, 0);
     cairo_set_operator(temp_dest_ctx, CAIRO_OPERATOR_SOURCE);
@@ -453,10 +534,9 @@ surface_saturate_and_pixelate(cairo_surface_t* src,
     if (src == dest) {
         temp_src_srfc = temp_dest_srfc;
     } else {
-        temp_src_srfc = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                        cairo_xlib_surface_get_width(src),
-                        cairo_xlib_surface_get_height(src)
-                                                  );
+        temp_src_srfc = awn_surface_pool_borrow_image(
+                            cairo_xlib_surface_get_width(src),
+                            cairo_xlib_surface_get_height(src));
         temp_src_ctx = cairo_create(temp_src_srfc);
         cairo_set_source_surface(temp_src_ctx, src, 0, 0);
         cairo_set_operator(temp_src_ctx, CAIRO_OPERATOR_SOURCE);
@@ -541,10 +621,10 @@ surface_saturate_and_pixelate(cairo_surface_t* src,
     cairo_destroy(tmp);
 
     if (temp_dest_srfc == temp_src_srfc) {
-        cairo_surface_destroy(temp_dest_srfc);
+        awn_surface_pool_return(temp_dest_srfc);
     } else {
-        cairo_surface_destroy(temp_dest_srfc);
-        cairo_surface_destroy(temp_src_srfc);
+        awn_surface_pool_return(temp_dest_srfc);
+        awn_surface_pool_return(temp_src_srfc);
     }
 }
 
@@ -555,3 +635,191 @@ surface_saturate(cairo_surface_t* icon_srfc, const gfloat saturation)
     surface_saturate_and_pixelate(icon_srfc, icon_srfc, saturation, FALSE);
 }
 
+
+static inline guint32
+extrude_sample(const guchar* data, gint stride, gint width, gint height,
+               gint x, gint y)
+{
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return 0;
+    }
+    return *(const guint32*)(data + y * stride + x * 4);
+}
+
+/*
+ * extrude_surface:
+ * @src: ARGB32 image surface with the icon.
+ * @face: ARGB32 image surface of the same size as @src, which receives the
+ * side face.
+ * @depth: Depth of the extrusion in pixels.
+ * @offset: Offset of the whole extrusion along the axis, may be fractional.
+ * @step: Direction of the extrusion along the axis (1 or -1).
+ * @vertical: Whether the axis is vertical.
+ *
+ * Computes the side face of an extruded icon in a single pass - that is the
+ * copies of @src shifted by @offset + @step, @offset + 2 * @step ... up to
+ * @depth - 1 steps, where the copies closer to @offset are on top. Every
+ * pixel composites its copies front to back and stops as soon as it's
+ * opaque. A fractional @offset is resampled the same way cairo's bilinear
+ * filter does it.
+ *
+ * Every pixel of @face is overwritten, painting @face over @src gives the
+ * extruded icon.
+ */
+void
+extrude_surface(cairo_surface_t* src, cairo_surface_t* face, gint depth,
+                gdouble offset, gint step, gboolean vertical)
+{
+    const guchar* src_data;
+    guchar* face_data;
+    gint width, height, src_stride, face_stride;
+    gint base, weight;
+    gint x, y, k, c;
+
+    g_return_if_fail(cairo_image_surface_get_format(src) ==
+                     CAIRO_FORMAT_ARGB32);
+    g_return_if_fail(cairo_image_surface_get_format(face) ==
+                     CAIRO_FORMAT_ARGB32);
+
+    width = cairo_image_surface_get_width(src);
+    height = cairo_image_surface_get_height(src);
+    g_return_if_fail(cairo_image_surface_get_width(face) == width &&
+                     cairo_image_surface_get_height(face) == height);
+
+    cairo_surface_flush(src);
+    cairo_surface_flush(face);
+
+    src_data = cairo_image_surface_get_data(src);
+    src_stride = cairo_image_surface_get_stride(src);
+    face_data = cairo_image_surface_get_data(face);
+    face_stride = cairo_image_surface_get_stride(face);
+
+    /* sample position = pixel - base - step * k - weight / 256 */
+    base = (gint)floor(offset);
+    weight = (gint)((offset - base) * 256 + 0.5);
+
+    for (y = 0; y < height; y++) {
+        guint32* row = (guint32*)(face_data + y * face_stride);
+
+        for (x = 0; x < width; x++) {
+            guint acc[4] = { 0, 0, 0, 0 }; /* B, G, R, A */
+
+            for (k = 1; k < depth && acc[3] < 0xFF; k++) {
+                gint shift = base + step * k;
+                gint sx = vertical ? x : x - shift;
+                gint sy = vertical ? y - shift : y;
+                guint32 p0 = extrude_sample(src_data, src_stride,
+                                            width, height, sx, sy);
+                guint32 p1 = 0;
+                guint remaining = 0xFF - acc[3];
+
+                if (weight) {
+                    p1 = extrude_sample(src_data, src_stride, width, height,
+                                        vertical ? sx : sx - 1,
+                                        vertical ? sy - 1 : sy);
+                }
+
+                for (c = 0; c < 4; c++) {
+                    guint v = (p0 >> (c * 8)) & 0xFF;
+                    guint t;
+
+                    if (weight) {
+                        v = (v * (256 - weight) +
+                             ((p1 >> (c * 8)) & 0xFF) * weight + 128) >> 8;
+                    }
+
+                    /* v * remaining / 255, rounded */
+                    t = v * remaining + 128;
+                    acc[c] += (t + (t >> 8)) >> 8;
+                }
+            }
+
+            row[x] = (MIN(acc[3], 0xFF) << 24) | (MIN(acc[2], 0xFF) << 16) |
+                     (MIN(acc[1], 0xFF) << 8) | MIN(acc[0], 0xFF);
+        }
+    }
+
+    cairo_surface_mark_dirty(face);
+}
+
+/*
+ * Returns a new image surface with @src scaled to @width x @height and then
+ * rotated by @turns quarter turns (the same direction as cairo_rotate()).
+ * @offset_x and @offset_y are set to the position of the result relative
+ * to the point where the rotated @src would be painted. Large downscales
+ * halve the image first, so every pixel of @src contributes.
+ */
+cairo_surface_t*
+scale_rotate_surface(cairo_surface_t* src, gint width, gint height,
+                     gint turns, gint* offset_x, gint* offset_y)
+{
+    cairo_surface_t* current = cairo_surface_reference(src);
+    cairo_surface_t* result;
+    cairo_t* cr;
+    gint src_width = cairo_image_surface_get_width(src);
+    gint src_height = cairo_image_surface_get_height(src);
+    gint ox = 0, oy = 0;
+
+    g_return_val_if_fail(width > 0 && height > 0, NULL);
+
+    while (src_width >= width * 2 || src_height >= height * 2) {
+        gint half_width = src_width >= width * 2 ? src_width / 2 : src_width;
+        gint half_height = src_height >= height * 2 ?
+                           src_height / 2 : src_height;
+        cairo_surface_t* half;
+
+        half = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                          half_width, half_height);
+        cr = cairo_create(half);
+        cairo_scale(cr, half_width / (double)src_width,
+                    half_height / (double)src_height);
+        cairo_set_source_surface(cr, current, 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        cairo_surface_destroy(current);
+        current = half;
+        src_width = half_width;
+        src_height = half_height;
+    }
+
+    turns &= 3;
+    switch (turns) {
+    case 1:
+        ox = -height;
+        break;
+    case 2:
+        ox = -width;
+        oy = -height;
+        break;
+    case 3:
+        oy = -width;
+        break;
+    default:
+        break;
+    }
+
+    result = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                        turns & 1 ? height : width,
+                                        turns & 1 ? width : height);
+    cr = cairo_create(result);
+    cairo_translate(cr, -ox, -oy);
+    cairo_rotate(cr, turns * M_PI / 2);
+    cairo_scale(cr, width / (double)src_width, height / (double)src_height);
+    cairo_set_source_surface(cr, current, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BEST);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    cairo_surface_destroy(current);
+
+    if (offset_x) {
+        *offset_x = ox;
+    }
+    if (offset_y) {
+        *offset_y = oy;
+    }
+
+    return result;
+}
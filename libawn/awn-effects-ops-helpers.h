@@ -56,8 +56,20 @@ blur_surface_shadow_rgba(cairo_surface_t* src,
                          gint surface_width, gint surface_height, const int radius,
                          guchar r, guchar g, guchar b, gfloat alpha_intensity);
 
+void
+blur_alpha_surface(cairo_surface_t* src, cairo_surface_t* dest,
+                   const int radius);
+
 void
 surface_saturate(cairo_surface_t* icon_srfc, const gfloat saturation);
 
+void
+extrude_surface(cairo_surface_t* src, cairo_surface_t* face, gint depth,
+                gdouble offset, gint step, gboolean vertical);
+
+cairo_surface_t*
+scale_rotate_surface(cairo_surface_t* src, gint width, gint height,
+                     gint turns, gint* offset_x, gint* offset_y);
+
 #endif
 
@@ -20,10 +20,16 @@
 
 #include "awn-effects-ops-new.h"
 #include "awn-effects-ops-helpers.h"
+#include "awn-effects-quality.h"
 #include "awn-cairo-utils.h"
+#include "awn-stats.h"
+#include "awn-surface-pool.h"
 
 #include "anims/awn-effects-shared.h"
 
+/* number of pre-scaled decorations kept around */
+#define DECORATIONS_MAX 12
+
 static
 cairo_surface_t* awn_effects_quark_to_surface(AwnEffects* fx, GQuark quark)
 {
@@ -34,6 +40,90 @@ cairo_surface_t* awn_effects_quark_to_surface(AwnEffects* fx, GQuark quark)
     return surface;
 }
 
+/*
+ * The custom arrow, active and spotlight images are painted scaled and
+ * rotated to the icon size and panel orientation. Instead of transforming
+ * them on every paint, the copies are made once and shared by all
+ * instances. Icon size, orientation and the image are all part of the key,
+ * so copies made for a previous theme or size are never used again and
+ * simply drop off the end of the list.
+ */
+typedef struct {
+    GQuark quark;
+    gint width;
+    gint height;
+    gint turns;
+    gint offset_x;
+    gint offset_y;
+    cairo_surface_t* surface;
+} AwnEffectsDecoration;
+
+/* the most recently used first */
+static GQueue decorations = G_QUEUE_INIT;
+
+static void
+awn_effects_decoration_free(AwnEffectsDecoration* decoration)
+{
+    cairo_surface_destroy(decoration->surface);
+    g_slice_free(AwnEffectsDecoration, decoration);
+}
+
+/* Returns the custom image @quark scaled to @width x @height and rotated by
+ * @turns quarter turns, @offset_x and @offset_y are set to where it should
+ * be painted relative to the point the original image was painted at.
+ */
+static cairo_surface_t*
+awn_effects_get_decoration(AwnEffects* fx, GQuark quark,
+                           gint width, gint height, gint turns,
+                           gint* offset_x, gint* offset_y)
+{
+    AwnEffectsDecoration* decoration;
+    cairo_surface_t* srfc;
+    GList* iter;
+
+    for (iter = decorations.head; iter != NULL; iter = iter->next) {
+        decoration = (AwnEffectsDecoration*)iter->data;
+
+        if (decoration->quark == quark && decoration->width == width &&
+                decoration->height == height && decoration->turns == turns) {
+            if (iter != decorations.head) {
+                g_queue_unlink(&decorations, iter);
+                g_queue_push_head_link(&decorations, iter);
+            }
+            AWN_STATS_COUNT(AWN_STATS_DECORATION_CACHE_HIT);
+
+            *offset_x = decoration->offset_x;
+            *offset_y = decoration->offset_y;
+            return decoration->surface;
+        }
+    }
+
+    srfc = awn_effects_quark_to_surface(fx, quark);
+    if (srfc == NULL || width <= 0 || height <= 0) {
+        return NULL;
+    }
+
+    decoration = g_slice_new(AwnEffectsDecoration);
+    decoration->quark = quark;
+    decoration->width = width;
+    decoration->height = height;
+    decoration->turns = turns;
+    decoration->surface = scale_rotate_surface(srfc, width, height, turns,
+                          &decoration->offset_x,
+                          &decoration->offset_y);
+    g_queue_push_head(&decorations, decoration);
+    AWN_STATS_COUNT(AWN_STATS_DECORATION_CACHE_MISS);
+
+    if (g_queue_get_length(&decorations) > DECORATIONS_MAX) {
+        awn_effects_decoration_free(
+            (AwnEffectsDecoration*)g_queue_pop_tail(&decorations));
+    }
+
+    *offset_x = decoration->offset_x;
+    *offset_y = decoration->offset_y;
+    return decoration->surface;
+}
+
 /* returns top left coordinates of the icon (without clipping and offsets) */
 void
 awn_effects_get_base_coords(AwnEffects* fx, double* x, double* y)
@@ -318,19 +408,15 @@ gboolean awn_effects_post_op_active(AwnEffects* fx,
             }
             cairo_stroke(cr);
         } else {
-            /* get the icon surface */
+            /* get the icon surface scaled to the icon size */
+            gint ox, oy;
             cairo_surface_t* srfc =
-                awn_effects_quark_to_surface(fx, fx->custom_active_icon);
+                awn_effects_get_decoration(fx, fx->custom_active_icon,
+                                           priv->icon_width + (2 * PADDING),
+                                           priv->icon_height + (2 * PADDING),
+                                           0, &ox, &oy);
             if (srfc) {
-                float srfc_width = cairo_image_surface_get_width(srfc);
-                float srfc_height = cairo_image_surface_get_height(srfc);
-
-                double w_ratio = (priv->icon_width + (2 * PADDING)) / srfc_width;
-                double h_ratio = (priv->icon_height + (2 * PADDING)) / srfc_height;
-
-                cairo_translate(cr, x - PADDING, y - PADDING);
-                cairo_scale(cr, w_ratio, h_ratio);
-                cairo_set_source_surface(cr, srfc, 0, 0);
+                cairo_set_source_surface(cr, srfc, x - PADDING, y - PADDING);
                 cairo_paint(cr);
             }
         }
@@ -363,6 +449,7 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
         }
 
         gdouble x, y, rotation;
+        gint turns;
         awn_effects_get_base_coords(fx, &x, &y);
         /* get coordinates of bottom center (for BOTTOM) and equivalents */
         switch (fx->position) {
@@ -372,6 +459,7 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
             y -= fx->icon_offset / 1.5;
             y += arrow_h;
             rotation = M_PI;
+            turns = 2;
             break;
 
         case GTK_POS_LEFT:
@@ -380,6 +468,7 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
             y += priv->icon_height / 2.0;
             y -= arrow_w / 2.0;
             rotation = M_PI * 0.5;
+            turns = 1;
             break;
 
         case GTK_POS_RIGHT:
@@ -389,6 +478,7 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
             y += priv->icon_height / 2.0;
             y += arrow_w / 2.0;
             rotation = M_PI * 1.5;
+            turns = 3;
             break;
 
         default: /* GTK_POS_BOTTOM: */
@@ -398,15 +488,28 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
             y += fx->icon_offset / 1.5;
             y -= arrow_h;
             rotation = 0;
+            turns = 0;
             break;
         }
         cairo_save(cr);
 
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-        cairo_translate(cr, x, y);
-        cairo_rotate(cr, rotation);
 
-        if (srfc == NULL) {
+        if (srfc) {
+            /* painted pre-rotated, without any transformation */
+            gint ox, oy;
+
+            srfc = awn_effects_get_decoration(fx, fx->arrow_icon,
+                                              arrow_w, arrow_h, turns,
+                                              &ox, &oy);
+            if (srfc) {
+                cairo_set_source_surface(cr, srfc, x + ox, y + oy);
+                cairo_paint(cr);
+            }
+        } else {
+            cairo_translate(cr, x, y);
+            cairo_rotate(cr, rotation);
+
             cairo_set_line_width(cr, 1.0);
 
             switch (fx->priv->arrow_type) {
@@ -444,9 +547,6 @@ gboolean awn_effects_post_op_arrow(AwnEffects* fx,
                 // we're here if user isn't using valid png / doesn't want arrows
                 break;
             }
-        } else {
-            cairo_set_source_surface(cr, srfc, 0, 0);
-            cairo_paint(cr);
         }
 
         cairo_restore(cr);
@@ -523,6 +623,75 @@ gboolean awn_effects_post_op_glow(AwnEffects* fx,
     return FALSE;
 }
 
+void
+awn_effects_set_content_serial(AwnEffects* fx, guint serial)
+{
+    g_return_if_fail(AWN_IS_EFFECTS(fx));
+
+    fx->priv->content_serial = serial;
+}
+
+void
+awn_effects_free_depth_cache(AwnEffects* fx)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    if (priv->depth_scratch) {
+        cairo_surface_destroy(priv->depth_scratch);
+        priv->depth_scratch = NULL;
+    }
+    if (priv->depth_face) {
+        cairo_surface_destroy(priv->depth_face);
+        priv->depth_face = NULL;
+    }
+    memset(&priv->depth_key, 0, sizeof(AwnEffectsDepthKey));
+}
+
+/*
+ * Fills @key with everything the side face depends on. Returns FALSE if
+ * that can't be told without looking at the pixels - the painter didn't
+ * identify its content, the target is the window itself (partial exposes
+ * leave old pixels there), or overlays are painted with the effects.
+ */
+static gboolean
+awn_effects_depth_key_init(AwnEffects* fx, AwnEffectsDepthKey* key)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    if (priv->content_serial == 0 || !fx->indirect_paint) {
+        return FALSE;
+    }
+
+    for (GList* iter = priv->overlays; iter != NULL; iter = iter->next) {
+        AwnOverlay* overlay = AWN_OVERLAY(iter->data);
+        gboolean active;
+
+        if (awn_overlay_get_apply_effects(overlay)) {
+            g_object_get(overlay, "active", &active, NULL);
+            if (active) {
+                return FALSE;
+            }
+        }
+    }
+
+    /* compared with memcmp() */
+    memset(key, 0, sizeof(AwnEffectsDepthKey));
+    key->content_serial = priv->content_serial;
+    key->width = priv->window_width;
+    key->height = priv->window_height;
+    key->depth = priv->icon_depth;
+    key->direction = priv->icon_depth_direction;
+    key->position = fx->position;
+    key->matrix = priv->paint_matrix;
+    key->clip = priv->clip;
+    if (priv->clip) {
+        key->clip_region = priv->clip_region;
+    }
+    key->border_clip = fx->border_clip;
+
+    return TRUE;
+}
+
 gboolean awn_effects_post_op_depth(AwnEffects* fx,
                                    cairo_t* cr,
                                    GtkAllocation* ds,
@@ -532,57 +701,122 @@ gboolean awn_effects_post_op_depth(AwnEffects* fx,
     AwnEffectsPrivate* priv = fx->priv;
 
     if (priv->icon_depth) {
-        double x = priv->icon_depth;
-        x /= priv->icon_depth_direction ? -2 : 2;
-        cairo_surface_flush(cairo_get_target(cr));
-        /* FIXME: we really could use the GtkAllocation here for optimization
-         * copy current surface look into temp one
-         */
-        cairo_surface_t* srfc = cairo_surface_create_similar(cairo_get_target(cr),
-                                CAIRO_CONTENT_COLOR_ALPHA,
-                                priv->window_width,
-                                priv->window_height
-                                                            );
-        cairo_t* ctx = cairo_create(srfc);
-        cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
-        cairo_set_source_surface(ctx, cairo_get_target(cr), 0, 0);
-        cairo_paint(ctx);
-        cairo_destroy(ctx);
-        cairo_surface_flush(srfc);
-
-        gint i, multiplier = priv->icon_depth_direction ? 1 : -1;
-        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_surface_t* target = cairo_get_target(cr);
+        gint w = priv->window_width, h = priv->window_height;
+        AwnEffectsDepthKey key;
+        gboolean cacheable;
+        gboolean vertical;
+        cairo_t* ctx;
+
         switch (fx->position) {
         case GTK_POS_TOP:
         case GTK_POS_BOTTOM:
-            for (i = 1; i < priv->icon_depth; i++) {
-                cairo_set_source_surface(cr,
-                                         srfc,
-                                         x + (multiplier * (priv->icon_depth - i)),
-                                         0);
-                cairo_paint(cr);
-            }
+            vertical = FALSE;
             break;
         case GTK_POS_LEFT:
         case GTK_POS_RIGHT:
-            for (i = 1; i < priv->icon_depth; i++) {
-                cairo_set_source_surface(cr,
-                                         srfc,
-                                         0,
-                                         x + (multiplier * (priv->icon_depth - i)));
-                cairo_paint(cr);
-            }
+            vertical = TRUE;
             break;
         default:
             return FALSE;
         }
 
-        cairo_surface_destroy(srfc);
+        cacheable = awn_effects_depth_key_init(fx, &key);
+
+        if (!cacheable || priv->depth_face == NULL ||
+                cairo_surface_get_type(priv->depth_face) !=
+                cairo_surface_get_type(target) ||
+                memcmp(&key, &priv->depth_key, sizeof(AwnEffectsDepthKey)) != 0) {
+            cairo_surface_t* face;
+            double offset = priv->icon_depth;
+            offset /= priv->icon_depth_direction ? -2 : 2;
+
+            /* read back the current look, the buffer is kept between frames */
+            if (priv->depth_scratch == NULL ||
+                    cairo_image_surface_get_width(priv->depth_scratch) != w ||
+                    cairo_image_surface_get_height(priv->depth_scratch) != h) {
+                if (priv->depth_scratch) {
+                    cairo_surface_destroy(priv->depth_scratch);
+                }
+                priv->depth_scratch =
+                    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+            }
+
+            cairo_surface_flush(target);
+            ctx = cairo_create(priv->depth_scratch);
+            cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(ctx, target, 0, 0);
+            cairo_paint(ctx);
+            cairo_destroy(ctx);
+            cairo_surface_flush(priv->depth_scratch);
+
+            /* all the copies of the icon composited at once */
+            face = awn_surface_pool_borrow_image(w, h);
+            extrude_surface(priv->depth_scratch, face, priv->icon_depth,
+                            offset, priv->icon_depth_direction ? 1 : -1,
+                            vertical);
+
+            /* keep the face next to the target, so the paint below doesn't
+             * upload it again while it's valid */
+            if (priv->depth_face &&
+                    (priv->depth_face_width != w ||
+                     priv->depth_face_height != h ||
+                     cairo_surface_get_type(priv->depth_face) !=
+                     cairo_surface_get_type(target))) {
+                cairo_surface_destroy(priv->depth_face);
+                priv->depth_face = NULL;
+            }
+            if (priv->depth_face == NULL) {
+                priv->depth_face = cairo_surface_create_similar(target,
+                                   CAIRO_CONTENT_COLOR_ALPHA,
+                                   w, h);
+                priv->depth_face_width = w;
+                priv->depth_face_height = h;
+            }
+            ctx = cairo_create(priv->depth_face);
+            cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(ctx, face, 0, 0);
+            cairo_paint(ctx);
+            cairo_destroy(ctx);
+            awn_surface_pool_return(face);
+
+            /* memcpy() keeps the zeroed padding, an all-zero key never
+             * matches as valid ones have a content serial */
+            if (cacheable) {
+                memcpy(&priv->depth_key, &key, sizeof(AwnEffectsDepthKey));
+            } else {
+                memset(&priv->depth_key, 0, sizeof(AwnEffectsDepthKey));
+            }
+        }
+
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_set_source_surface(cr, priv->depth_face, 0, 0);
+        cairo_paint(cr);
+
         return TRUE;
+    } else if (priv->depth_face) {
+        /* the icon is flat again */
+        awn_effects_free_depth_cache(fx);
     }
     return FALSE;
 }
 
+void
+awn_effects_free_shadow_cache(AwnEffects* fx)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    if (priv->shadow_scratch) {
+        cairo_surface_destroy(priv->shadow_scratch);
+        priv->shadow_scratch = NULL;
+    }
+    if (priv->shadow_mask) {
+        cairo_surface_destroy(priv->shadow_mask);
+        priv->shadow_mask = NULL;
+    }
+    memset(&priv->shadow_key, 0, sizeof(AwnEffectsShadowKey));
+}
+
 gboolean awn_effects_post_op_shadow(AwnEffects* fx,
                                     cairo_t* cr,
                                     GtkAllocation* ds,
@@ -592,35 +826,112 @@ gboolean awn_effects_post_op_shadow(AwnEffects* fx,
     AwnEffectsPrivate* priv = fx->priv;
 
     if (fx->make_shadow) {
-        cairo_surface_t* blur_srfc;
-        cairo_t* blur_ctx;
-
+        cairo_surface_t* target = cairo_get_target(cr);
         int w = priv->window_width, h = priv->window_height;
-        blur_srfc = cairo_surface_create_similar(cairo_get_target(cr),
-                    CAIRO_CONTENT_COLOR_ALPHA,
-                    w,
-                    h);
-        blur_ctx = cairo_create(blur_srfc);
+        AwnEffectsQuality level = awn_effects_quality_get_level();
+        gint radius = priv->shadow_radius;
+        AwnEffectsShadowKey key;
+        gboolean cacheable;
+        cairo_t* ctx;
+
+        if (level >= AWN_EFFECTS_QUALITY_REDUCED_BLUR) {
+            radius = (radius + 1) / 2;
+        }
 
-        cairo_set_operator(blur_ctx, CAIRO_OPERATOR_SOURCE);
-        cairo_set_source_surface(blur_ctx, cairo_get_target(cr), 0, 0);
-        cairo_paint(blur_ctx);
+        /* the shadow is cast by what the depth effect left in the target,
+         * so its key covers everything the side face depends on */
+        memset(&key, 0, sizeof(AwnEffectsShadowKey));
+        cacheable = awn_effects_depth_key_init(fx, &key.content);
+        if (cacheable) {
+            key.radius = radius;
+            key.surface_type = cairo_surface_get_type(target);
+        }
+
+        /* under load a running animation keeps the mask it started with */
+        if (priv->shadow_mask == NULL ||
+                cairo_surface_get_type(priv->shadow_mask) !=
+                cairo_surface_get_type(target) ||
+                priv->shadow_mask_width != w ||
+                priv->shadow_mask_height != h ||
+                ((level < AWN_EFFECTS_QUALITY_CACHED_SHADOWS ||
+                  priv->timer_id == 0) &&
+                 (!cacheable ||
+                  memcmp(&key, &priv->shadow_key,
+                         sizeof(AwnEffectsShadowKey)) != 0))) {
+            cairo_surface_t* blurred;
+
+            /* only the alpha of the icon is needed */
+            if (priv->shadow_scratch == NULL ||
+                    cairo_image_surface_get_width(priv->shadow_scratch) != w ||
+                    cairo_image_surface_get_height(priv->shadow_scratch) != h) {
+                if (priv->shadow_scratch) {
+                    cairo_surface_destroy(priv->shadow_scratch);
+                }
+                priv->shadow_scratch =
+                    cairo_image_surface_create(CAIRO_FORMAT_A8, w, h);
+            }
 
-        darken_surface(blur_ctx, priv->window_width, priv->window_height);
-        blur_surface_shadow(blur_srfc, priv->window_width, priv->window_height, 4);
+            cairo_surface_flush(target);
+            ctx = cairo_create(priv->shadow_scratch);
+            cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(ctx, target, 0, 0);
+            cairo_paint(ctx);
+            cairo_destroy(ctx);
+            cairo_surface_flush(priv->shadow_scratch);
+
+            blurred = awn_surface_pool_borrow(priv->shadow_scratch,
+                                              CAIRO_CONTENT_ALPHA, w, h);
+            blur_alpha_surface(priv->shadow_scratch, blurred, radius);
+
+            /* keep the mask next to the target, see the depth effect */
+            if (priv->shadow_mask &&
+                    (cairo_surface_get_type(priv->shadow_mask) !=
+                     cairo_surface_get_type(target) ||
+                     priv->shadow_mask_width != w ||
+                     priv->shadow_mask_height != h)) {
+                cairo_surface_destroy(priv->shadow_mask);
+                priv->shadow_mask = NULL;
+            }
+            if (priv->shadow_mask == NULL) {
+                priv->shadow_mask = cairo_surface_create_similar(target,
+                                    CAIRO_CONTENT_ALPHA,
+                                    w, h);
+                priv->shadow_mask_width = w;
+                priv->shadow_mask_height = h;
+            }
+            ctx = cairo_create(priv->shadow_mask);
+            cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(ctx, blurred, 0, 0);
+            cairo_paint(ctx);
+            cairo_destroy(ctx);
+            awn_surface_pool_return(blurred);
+
+            /* see the depth effect for the memcpy() */
+            if (cacheable) {
+                memcpy(&priv->shadow_key, &key, sizeof(AwnEffectsShadowKey));
+            } else {
+                memset(&priv->shadow_key, 0, sizeof(AwnEffectsShadowKey));
+            }
+        }
 
         cairo_save(cr);
         cairo_set_operator(cr, CAIRO_OPERATOR_DEST_OVER);
+        if (priv->shadow_color) {
+            awn_cairo_set_source_color(cr, priv->shadow_color);
+        } else {
+            cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.5);
+        }
+        cairo_translate(cr, priv->shadow_offset_x, priv->shadow_offset_y);
         const double SHADOW_SCALE = 1.0234375;
         cairo_scale(cr, SHADOW_SCALE, SHADOW_SCALE);
-        cairo_set_source_surface(cr, blur_srfc, (w - w * SHADOW_SCALE) / 2, (h - h * SHADOW_SCALE) / 2);
-        cairo_paint_with_alpha(cr, 0.5);
+        cairo_mask_surface(cr, priv->shadow_mask,
+                           (w - w * SHADOW_SCALE) / 2,
+                           (h - h * SHADOW_SCALE) / 2);
         cairo_restore(cr);
 
-        cairo_surface_destroy(blur_srfc);
-        cairo_destroy(blur_ctx);
-
         return TRUE;
+    } else if (priv->shadow_mask) {
+        awn_effects_free_shadow_cache(fx);
     }
     return FALSE;
 }
@@ -634,56 +945,51 @@ gboolean awn_effects_post_op_spotlight(AwnEffects* fx,
     AwnEffectsPrivate* priv = fx->priv;
 
     if (priv->spotlight && priv->spotlight_alpha > 0) {
-        cairo_surface_t* srfc =
-            awn_effects_quark_to_surface(fx, fx->spotlight_icon);
-        if (!srfc) {
-            return FALSE;
-        }
-
-        float srfc_width = cairo_image_surface_get_width(srfc);
-        float srfc_height = cairo_image_surface_get_height(srfc);
+        cairo_surface_t* srfc;
+        gint x, y, ox, oy, turns = 0;
+        /* the size along the panel edge and across it */
+        gint length, height = priv->icon_height * 5 / 4;
 
-        cairo_save(cr);
-        double x, y, rotate = 0;
         switch (fx->position) {
         case GTK_POS_TOP:
             x = priv->window_width;
             y = priv->icon_height - priv->icon_height / 12;
             y += fx->icon_offset;
-            rotate = M_PI;
+            length = priv->window_width;
+            turns = 2;
             break;
         case GTK_POS_RIGHT:
             x = priv->window_width - priv->icon_height + priv->icon_height / 12;
             x -= fx->icon_offset;
             y = priv->window_height;
-            rotate = -M_PI / 2;
+            length = priv->window_height;
+            turns = 3;
             break;
         case GTK_POS_BOTTOM:
             x = 0;
             y = priv->window_height - priv->icon_height + priv->icon_height / 12;
             y -= fx->icon_offset;
+            length = priv->window_width;
             break;
         case GTK_POS_LEFT:
             x = priv->icon_height - priv->icon_height / 12;
             x += fx->icon_offset;
             y = 0;
-            rotate = M_PI / 2;
+            length = priv->window_height;
+            turns = 1;
             break;
         default:
             return FALSE;
         }
-        cairo_translate(cr, x, y);
-        if (fx->position == GTK_POS_TOP ||
-                fx->position == GTK_POS_BOTTOM) {
-            cairo_scale(cr, priv->window_width / srfc_width,
-                        priv->icon_height * 5 / 4 / srfc_height);
-        } else {
-            cairo_scale(cr, priv->icon_height * 5 / 4 / srfc_height,
-                        priv->window_height / srfc_width);
+
+        srfc = awn_effects_get_decoration(fx, fx->spotlight_icon,
+                                          length, height, turns, &ox, &oy);
+        if (!srfc) {
+            return FALSE;
         }
-        cairo_rotate(cr, rotate);
 
-        cairo_set_source_surface(cr, srfc, 0, 0);
+        cairo_save(cr);
+        cairo_set_source_surface(cr, srfc, x + ox, y + oy);
         cairo_set_operator(cr, CAIRO_OPERATOR_DEST_OVER);
         cairo_paint_with_alpha(cr, priv->spotlight_alpha);
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
@@ -718,6 +1024,89 @@ gboolean awn_effects_post_op_alpha(AwnEffects* fx,
     return FALSE;
 }
 
+/* the old way - flipped copy of the whole window painted behind the icon */
+static void
+awn_effects_paint_reflection_compat(AwnEffects* fx, cairo_t* cr)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    int dx = priv->window_width - fx->icon_offset * 2 - fx->refl_offset;
+    int dy = priv->window_height - fx->icon_offset * 2 - fx->refl_offset;
+
+    cairo_surface_t* srfc = awn_surface_pool_borrow(cairo_get_target(cr),
+                            CAIRO_CONTENT_COLOR_ALPHA,
+                            priv->window_width,
+                            priv->window_height);
+    cairo_t* ctx = cairo_create(srfc);
+    cairo_matrix_t matrix;
+    switch (fx->position) {
+    case GTK_POS_TOP:
+        dy *= -1; /* careful no break here */
+    case GTK_POS_BOTTOM:
+        dx = 0;
+        cairo_matrix_init(&matrix,
+                          1, 0,
+                          0, -1,
+                          0, priv->window_height);
+        break;
+    case GTK_POS_LEFT:
+        dx *= -1; /* careful no break here */
+    case GTK_POS_RIGHT:
+        dy = 0;
+        cairo_matrix_init(&matrix,
+                          -1, 0,
+                          0, 1,
+                          priv->window_width, 0);
+        break;
+    }
+    cairo_transform(ctx, &matrix);
+    cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(ctx, cairo_get_target(cr), 0, 0);
+    cairo_paint(ctx);
+    cairo_destroy(ctx);
+
+    cairo_save(cr);
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_DEST_OVER);
+    cairo_set_source_surface(cr, srfc, dx, dy);
+    cairo_paint_with_alpha(cr, priv->alpha * fx->refl_alpha);
+    cairo_restore(cr);
+
+    awn_surface_pool_return(srfc);
+}
+
+/* linear fade from the mirror line to the edge of the window */
+static cairo_pattern_t*
+awn_effects_get_reflection_mask(AwnEffects* fx, gboolean vertical,
+                                double start, double end, double alpha)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    if (priv->refl_mask &&
+            priv->refl_mask_start == start && priv->refl_mask_end == end &&
+            priv->refl_mask_alpha == alpha &&
+            priv->refl_mask_fade == priv->refl_fade) {
+        return priv->refl_mask;
+    }
+
+    if (priv->refl_mask) {
+        cairo_pattern_destroy(priv->refl_mask);
+    }
+
+    priv->refl_mask = vertical ?
+                      cairo_pattern_create_linear(0, start, 0, end) :
+                      cairo_pattern_create_linear(start, 0, end, 0);
+    cairo_pattern_add_color_stop_rgba(priv->refl_mask, 0.0, 0, 0, 0, alpha);
+    cairo_pattern_add_color_stop_rgba(priv->refl_mask, 1.0, 0, 0, 0,
+                                      alpha * (1.0 - priv->refl_fade));
+
+    priv->refl_mask_start = start;
+    priv->refl_mask_end = end;
+    priv->refl_mask_alpha = alpha;
+    priv->refl_mask_fade = priv->refl_fade;
+
+    return priv->refl_mask;
+}
+
 gboolean awn_effects_post_op_reflection(AwnEffects* fx,
                                         cairo_t* cr,
                                         GtkAllocation* ds,
@@ -726,51 +1115,77 @@ gboolean awn_effects_post_op_reflection(AwnEffects* fx,
 {
     AwnEffectsPrivate* priv = fx->priv;
 
-    if (fx->do_reflection) {
-        int dx = priv->window_width - fx->icon_offset * 2 - fx->refl_offset;
-        int dy = priv->window_height - fx->icon_offset * 2 - fx->refl_offset;
-
-        cairo_surface_t* srfc = cairo_surface_create_similar(cairo_get_target(cr),
-                                CAIRO_CONTENT_COLOR_ALPHA,
-                                priv->window_width,
-                                priv->window_height
-                                                            );
-        cairo_t* ctx = cairo_create(srfc);
+    if (fx->do_reflection && (priv->timer_id == 0 ||
+                              awn_effects_quality_get_level() <
+                              AWN_EFFECTS_QUALITY_STATIC_REFLECTIONS)) {
+        /* the icon is mirrored along the line at half of the sum, so the
+         * source and the reflection area never overlap and we can paint
+         * the target straight onto itself */
+        int w = priv->window_width, h = priv->window_height;
+        int sum;
+        double mirror, edge, alpha;
+        gboolean vertical;
         cairo_matrix_t matrix;
+
+        if (priv->refl_compat) {
+            awn_effects_paint_reflection_compat(fx, cr);
+            return TRUE;
+        }
+
         switch (fx->position) {
         case GTK_POS_TOP:
-            dy *= -1; /* careful no break here */
+            sum = fx->icon_offset * 2 + fx->refl_offset;
+            mirror = ceil(sum / 2.0);
+            edge = 0;
+            vertical = TRUE;
+            break;
         case GTK_POS_BOTTOM:
-            dx = 0;
-            cairo_matrix_init(&matrix,
-                              1, 0,
-                              0, -1,
-                              0, priv->window_height);
+            sum = 2 * h - fx->icon_offset * 2 - fx->refl_offset;
+            mirror = floor(sum / 2.0);
+            edge = h;
+            vertical = TRUE;
             break;
         case GTK_POS_LEFT:
-            dx *= -1; /* careful no break here */
+            sum = fx->icon_offset * 2 + fx->refl_offset;
+            mirror = ceil(sum / 2.0);
+            edge = 0;
+            vertical = FALSE;
+            break;
         case GTK_POS_RIGHT:
-            dy = 0;
-            cairo_matrix_init(&matrix,
-                              -1, 0,
-                              0, 1,
-                              priv->window_width, 0);
+            sum = 2 * w - fx->icon_offset * 2 - fx->refl_offset;
+            mirror = floor(sum / 2.0);
+            edge = w;
+            vertical = FALSE;
             break;
+        default:
+            return FALSE;
         }
-        cairo_transform(ctx, &matrix);
-        cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
-        cairo_set_source_surface(ctx, cairo_get_target(cr), 0, 0);
-        cairo_paint(ctx);
-        cairo_destroy(ctx);
 
         cairo_save(cr);
 
+        if (vertical) {
+            cairo_rectangle(cr, 0, MIN(mirror, edge), w, ABS(edge - mirror));
+            cairo_matrix_init(&matrix, 1, 0, 0, -1, 0, sum);
+        } else {
+            cairo_rectangle(cr, MIN(mirror, edge), 0, ABS(edge - mirror), h);
+            cairo_matrix_init(&matrix, -1, 0, 0, 1, sum, 0);
+        }
+        cairo_clip(cr);
+
         cairo_set_operator(cr, CAIRO_OPERATOR_DEST_OVER);
-        cairo_set_source_surface(cr, srfc, dx, dy);
-        cairo_paint_with_alpha(cr, priv->alpha * fx->refl_alpha);
-        cairo_restore(cr);
+        cairo_set_source_surface(cr, cairo_get_target(cr), 0, 0);
+        cairo_pattern_set_matrix(cairo_get_source(cr), &matrix);
+
+        alpha = priv->alpha * fx->refl_alpha;
+        if (priv->refl_fade > 0.0) {
+            cairo_mask(cr, awn_effects_get_reflection_mask(fx, vertical,
+                       mirror, edge,
+                       alpha));
+        } else {
+            cairo_paint_with_alpha(cr, alpha);
+        }
 
-        cairo_surface_destroy(srfc);
+        cairo_restore(cr);
         return TRUE;
     }
     return FALSE;
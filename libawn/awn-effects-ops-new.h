@@ -23,6 +23,17 @@
 
 void awn_effects_get_base_coords(AwnEffects* fx, double* x, double* y);
 
+/* Identifies what was painted in the current frame (between
+ * awn_effects_cairo_create() and awn_effects_cairo_destroy()), equal
+ * non-zero serials mean identical content. It is reset when the frame
+ * ends, so frames of painters which don't set it aren't cached.
+ */
+void awn_effects_set_content_serial(AwnEffects* fx, guint serial);
+
+void awn_effects_free_depth_cache(AwnEffects* fx);
+
+void awn_effects_free_shadow_cache(AwnEffects* fx);
+
 gboolean awn_effects_pre_op_clear(AwnEffects* fx,
                                   cairo_t* cr,
                                   GtkAllocation* ds,
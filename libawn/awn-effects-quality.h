@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-effects-quality.h
+ *
+ * Private header - process-wide quality level of the effects. The time
+ * spent in awn_effects_cairo_destroy() is summed up per animation frame,
+ * when it stays over the budget for a few frames the effects step down
+ * one level, when it stays well under the budget for a while they step
+ * back up. The controller lives in awn-effects.cc.
+ */
+
+#ifndef _AWN_EFFECTS_QUALITY_H
+#define _AWN_EFFECTS_QUALITY_H
+
+#include <glib.h>
+
+/* every level includes the savings of the ones above it */
+typedef enum {
+    AWN_EFFECTS_QUALITY_FULL = 0,
+    AWN_EFFECTS_QUALITY_REDUCED_BLUR,       /* half the shadow radius */
+    AWN_EFFECTS_QUALITY_CACHED_SHADOWS,     /* no new shadow masks while
+                                               animating */
+    AWN_EFFECTS_QUALITY_STATIC_REFLECTIONS, /* no reflection while animating */
+    AWN_EFFECTS_QUALITY_HALF_FRAME_RATE,    /* animations paint every other
+                                               frame */
+
+    AWN_EFFECTS_QUALITY_LAST
+} AwnEffectsQuality;
+
+/* default share of the frame the post-ops may take (microseconds) */
+#define AWN_EFFECTS_QUALITY_BUDGET 20000
+/* consecutive frames over the budget before stepping down */
+#define AWN_EFFECTS_QUALITY_DOWN_FRAMES 3
+/* consecutive frames under half of the budget before stepping up */
+#define AWN_EFFECTS_QUALITY_UP_FRAMES 50
+
+AwnEffectsQuality
+awn_effects_quality_get_level(void);
+
+/* The controller never goes below @lowest, AWN_EFFECTS_QUALITY_FULL turns
+ * it off. Can be also set with the AWN_EFFECTS_QUALITY environment
+ * variable.
+ */
+void
+awn_effects_quality_set_lowest(AwnEffectsQuality lowest);
+
+void
+awn_effects_quality_set_budget(gint64 budget_us);
+
+/* Accounts @cost_us spent painting in the frame containing @now_us. */
+void
+awn_effects_quality_add_cost(gint64 now_us, gint64 cost_us);
+
+/* Back to full quality and the defaults. */
+void
+awn_effects_quality_reset(void);
+
+#endif
@@ -23,8 +23,11 @@
 #include "awn-config.h"
 #include "awn-effects.h"
 #include "awn-effects-ops-new.h"
+#include "awn-effects-quality.h"
 #include "awn-enum-types.h"
 #include "awn-overlay.h"
+#include "awn-stats.h"
+#include "awn-surface-pool.h"
 
 #include <math.h>
 #include <string.h>
@@ -88,7 +91,13 @@ enum {
     PROP_REFLECTION_OFFSET,
     PROP_REFLECTION_ALPHA,
     PROP_REFLECTION_VISIBLE,
+    PROP_REFLECTION_FADE,
+    PROP_REFLECTION_COMPAT,
     PROP_MAKE_SHADOW,
+    PROP_SHADOW_COLOR,
+    PROP_SHADOW_RADIUS,
+    PROP_SHADOW_OFFSET_X,
+    PROP_SHADOW_OFFSET_Y,
     PROP_IS_ACTIVE,
     PROP_IS_DEPRESSED,
     PROP_PROGRESS,
@@ -164,6 +173,19 @@ awn_effects_finalize(GObject* object)
         fx->priv->effect_queue = NULL;
     }
 
+    awn_effects_free_depth_cache(fx);
+    awn_effects_free_shadow_cache(fx);
+
+    if (fx->priv->shadow_color) {
+        g_object_unref(fx->priv->shadow_color);
+        fx->priv->shadow_color = NULL;
+    }
+
+    if (fx->priv->refl_mask) {
+        cairo_pattern_destroy(fx->priv->refl_mask);
+        fx->priv->refl_mask = NULL;
+    }
+
     G_OBJECT_CLASS(awn_effects_parent_class)->finalize(object);
 }
 
@@ -304,9 +326,27 @@ awn_effects_get_property(GObject*      object,
     case PROP_REFLECTION_VISIBLE:
         g_value_set_boolean(value, fx->do_reflection);
         break;
+    case PROP_REFLECTION_FADE:
+        g_value_set_float(value, priv->refl_fade);
+        break;
+    case PROP_REFLECTION_COMPAT:
+        g_value_set_boolean(value, priv->refl_compat);
+        break;
     case PROP_MAKE_SHADOW:
         g_value_set_boolean(value, fx->make_shadow);
         break;
+    case PROP_SHADOW_COLOR:
+        g_value_set_object(value, priv->shadow_color);
+        break;
+    case PROP_SHADOW_RADIUS:
+        g_value_set_int(value, priv->shadow_radius);
+        break;
+    case PROP_SHADOW_OFFSET_X:
+        g_value_set_int(value, priv->shadow_offset_x);
+        break;
+    case PROP_SHADOW_OFFSET_Y:
+        g_value_set_int(value, priv->shadow_offset_y);
+        break;
     case PROP_IS_ACTIVE:
         g_value_set_boolean(value, fx->is_active);
         break;
@@ -393,9 +433,31 @@ awn_effects_set_property(GObject*      object,
     case PROP_REFLECTION_VISIBLE:
         fx->do_reflection = g_value_get_boolean(value);
         break;
+    case PROP_REFLECTION_FADE:
+        priv->refl_fade = g_value_get_float(value);
+        break;
+    case PROP_REFLECTION_COMPAT:
+        priv->refl_compat = g_value_get_boolean(value);
+        break;
     case PROP_MAKE_SHADOW:
         fx->make_shadow = g_value_get_boolean(value);
         break;
+    case PROP_SHADOW_COLOR:
+        if (priv->shadow_color) {
+            g_object_unref(priv->shadow_color);
+            priv->shadow_color = NULL;
+        }
+        priv->shadow_color = g_value_dup_object(value);
+        break;
+    case PROP_SHADOW_RADIUS:
+        priv->shadow_radius = g_value_get_int(value);
+        break;
+    case PROP_SHADOW_OFFSET_X:
+        priv->shadow_offset_x = g_value_get_int(value);
+        break;
+    case PROP_SHADOW_OFFSET_Y:
+        priv->shadow_offset_y = g_value_get_int(value);
+        break;
     case PROP_IS_ACTIVE:
         fx->is_active = g_value_get_boolean(value);
         break;
@@ -461,6 +523,113 @@ awn_effects_prop_changed(GObject* object, GParamSpec* pspec)
     awn_effects_redraw(fx);
 }
 
+/*
+ * Adaptive quality
+ *
+ * One controller for the whole process, many icons animating together
+ * share the frame.
+ */
+
+#define AWN_EFFECTS_QUALITY_FRAME (G_USEC_PER_SEC / AWN_FRAMES_PER_SECOND(NULL))
+
+static struct {
+    AwnEffectsQuality level;
+    AwnEffectsQuality lowest;
+    gint64 budget;
+    gint64 frame_start;
+    gint64 frame_cost;
+    guint over_budget;  /* consecutive frames over the budget */
+    guint under_budget; /* consecutive frames under half of it */
+} quality = {
+    AWN_EFFECTS_QUALITY_FULL, (AwnEffectsQuality)(AWN_EFFECTS_QUALITY_LAST - 1),
+    AWN_EFFECTS_QUALITY_BUDGET, 0, 0, 0, 0
+};
+
+static void
+awn_effects_quality_finish_frame(gint64 cost)
+{
+    if (cost > quality.budget) {
+        quality.under_budget = 0;
+        if (++quality.over_budget >= AWN_EFFECTS_QUALITY_DOWN_FRAMES &&
+                quality.level < quality.lowest) {
+            quality.level = (AwnEffectsQuality)(quality.level + 1);
+            quality.over_budget = 0;
+            AWN_STATS_COUNT(AWN_STATS_EFFECTS_QUALITY_DOWN);
+        }
+    } else if (cost < quality.budget / 2) {
+        quality.over_budget = 0;
+        if (++quality.under_budget >= AWN_EFFECTS_QUALITY_UP_FRAMES &&
+                quality.level > AWN_EFFECTS_QUALITY_FULL) {
+            quality.level = (AwnEffectsQuality)(quality.level - 1);
+            quality.under_budget = 0;
+            AWN_STATS_COUNT(AWN_STATS_EFFECTS_QUALITY_UP);
+        }
+    } else {
+        /* between the thresholds the level stays */
+        quality.over_budget = 0;
+        quality.under_budget = 0;
+    }
+}
+
+void
+awn_effects_quality_add_cost(gint64 now_us, gint64 cost_us)
+{
+    gint64 frames = (now_us - quality.frame_start) / AWN_EFFECTS_QUALITY_FRAME;
+
+    if (frames > 0) {
+        gint64 idle;
+
+        awn_effects_quality_finish_frame(quality.frame_cost);
+        /* nothing was painted in the frames in between */
+        for (idle = MIN(frames - 1, AWN_EFFECTS_QUALITY_UP_FRAMES);
+                idle > 0; idle--) {
+            awn_effects_quality_finish_frame(0);
+        }
+
+        quality.frame_start += frames * AWN_EFFECTS_QUALITY_FRAME;
+        quality.frame_cost = 0;
+    }
+
+    quality.frame_cost += cost_us;
+}
+
+AwnEffectsQuality
+awn_effects_quality_get_level(void)
+{
+    return quality.level;
+}
+
+void
+awn_effects_quality_set_lowest(AwnEffectsQuality lowest)
+{
+    g_return_if_fail(lowest < AWN_EFFECTS_QUALITY_LAST);
+
+    quality.lowest = lowest;
+    if (quality.level > lowest) {
+        quality.level = lowest;
+    }
+}
+
+void
+awn_effects_quality_set_budget(gint64 budget_us)
+{
+    g_return_if_fail(budget_us > 0);
+
+    quality.budget = budget_us;
+}
+
+void
+awn_effects_quality_reset(void)
+{
+    quality.level = AWN_EFFECTS_QUALITY_FULL;
+    quality.lowest = (AwnEffectsQuality)(AWN_EFFECTS_QUALITY_LAST - 1);
+    quality.budget = AWN_EFFECTS_QUALITY_BUDGET;
+    quality.frame_start = 0;
+    quality.frame_cost = 0;
+    quality.over_budget = 0;
+    quality.under_budget = 0;
+}
+
 /**
  * awn_effects_redraw:
  * @fx: #AwnEffects instance.
@@ -471,6 +640,19 @@ awn_effects_prop_changed(GObject* object, GParamSpec* pspec)
 void
 awn_effects_redraw(AwnEffects* fx)
 {
+    if (G_UNLIKELY(awn_stats_enabled) && fx->priv->timer_id) {
+        awn_stats_add(AWN_STATS_EFFECTS_ANIMATION_FRAME, 0);
+    }
+
+    /* the animation keeps its speed, only every other frame is painted,
+     * the last one is painted when the timer stops */
+    if (fx->priv->timer_id && !fx->priv->redraw_skipped &&
+            quality.level >= AWN_EFFECTS_QUALITY_HALF_FRAME_RATE) {
+        fx->priv->redraw_skipped = TRUE;
+        return;
+    }
+    fx->priv->redraw_skipped = FALSE;
+
     if (fx->widget && gtk_widget_is_drawable(GTK_WIDGET(fx->widget))) {
         gint x, y, w, h;
         gint dx = 0, dy = 0;
@@ -559,6 +741,13 @@ awn_effects_class_init(AwnEffectsClass* klass)
     obj_class->dispose = awn_effects_dispose;
     obj_class->finalize = awn_effects_finalize;
 
+    if (g_getenv("AWN_EFFECTS_QUALITY")) {
+        gint lowest = atoi(g_getenv("AWN_EFFECTS_QUALITY"));
+        awn_effects_quality_set_lowest((AwnEffectsQuality)
+                                       CLAMP(lowest, AWN_EFFECTS_QUALITY_FULL,
+                                             AWN_EFFECTS_QUALITY_LAST - 1));
+    }
+
     /**
      * AwnEffects::animation-start:
      *
@@ -807,6 +996,37 @@ awn_effects_class_init(AwnEffectsClass* klass)
                              TRUE,
                              G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
                              G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:reflection-fade:
+     *
+     * Determines how much the reflection fades out towards the edge of the
+     * window, 0.0 keeps the whole reflection equally opaque, 1.0 makes it
+     * fully transparent at the edge.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_REFLECTION_FADE,
+        g_param_spec_float("reflection-fade",
+                           "Reflection fade",
+                           "How much the reflection fades out",
+                           0.0, 1.0, 0.0,
+                           G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                           G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:reflection-compat:
+     *
+     * Paints the reflection through a flipped copy of the whole icon window,
+     * which exactly matches the output of older versions (including the
+     * reflected bits which end up behind the icon). Ignores
+     * #AwnEffects:reflection-fade.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_REFLECTION_COMPAT,
+        g_param_spec_boolean("reflection-compat",
+                             "Reflection compatibility mode",
+                             "Paint the reflection the way older versions did",
+                             FALSE,
+                             G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                             G_PARAM_STATIC_STRINGS));
     /**
      * AwnEffects:make-shadow:
      *
@@ -820,6 +1040,58 @@ awn_effects_class_init(AwnEffectsClass* klass)
                              FALSE,
                              G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
                              G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:shadow-color:
+     *
+     * Color of the shadow, if it isn't set the shadow is half-transparent
+     * black.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_SHADOW_COLOR,
+        g_param_spec_object("shadow-color",
+                            "Shadow color",
+                            "Color used for painting the shadow",
+                            DESKTOP_AGNOSTIC_TYPE_COLOR,
+                            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:shadow-radius:
+     *
+     * Radius of the blur applied to the shadow.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_SHADOW_RADIUS,
+        g_param_spec_int("shadow-radius",
+                         "Shadow radius",
+                         "Radius of the shadow blur",
+                         0, 32, 4,
+                         G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:shadow-offset-x:
+     *
+     * Horizontal offset of the shadow.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_SHADOW_OFFSET_X,
+        g_param_spec_int("shadow-offset-x",
+                         "Shadow X offset",
+                         "Horizontal offset of the shadow",
+                         -32, 32, 0,
+                         G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:shadow-offset-y:
+     *
+     * Vertical offset of the shadow.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_SHADOW_OFFSET_Y,
+        g_param_spec_int("shadow-offset-y",
+                         "Shadow Y offset",
+                         "Vertical offset of the shadow",
+                         -32, 32, 0,
+                         G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS));
     /**
      * AwnEffects:active:
      *
@@ -1379,6 +1651,9 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
     g_return_val_if_fail(cairo_status(cr) == CAIRO_STATUS_SUCCESS, NULL);
     fx->window_ctx = cr;
 
+    /* stopped by awn_effects_cairo_destroy() */
+    AWN_STATS_TIMER_START(priv->paint_start);
+
     /*
      * Oh right, first we used cairo_xlib_surface_get_width/height, but we
      * discovered that is causes artifacts, so now we use simple allocation
@@ -1422,14 +1697,15 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
     if (fx->indirect_paint) {
         cairo_surface_t* targetSurface = cairo_get_target(cr);
         /* we'll give to user virtual context and later paint everything on real one */
-        targetSurface = cairo_surface_create_similar(targetSurface,
-                        CAIRO_CONTENT_COLOR_ALPHA,
-                        priv->window_width,
-                        priv->window_height
-                                                    );
+        targetSurface = awn_surface_pool_borrow(targetSurface,
+                                                CAIRO_CONTENT_COLOR_ALPHA,
+                                                priv->window_width,
+                                                priv->window_height);
         g_return_val_if_fail(
             cairo_surface_status(targetSurface) == CAIRO_STATUS_SUCCESS, NULL);
         cr = cairo_create(targetSurface);
+        /* pooled surfaces still contain the previous frame */
+        awn_effects_pre_op_clear(fx, cr, NULL, NULL);
     }
     /* if we're painting directly virtual_ctx == window_ctx */
     fx->virtual_ctx = cr;
@@ -1453,6 +1729,8 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
     awn_effects_pre_op_rotate(fx, cr, &ds, NULL);
     awn_effects_pre_op_flip(fx, cr, &ds, NULL);
 
+    cairo_get_matrix(cr, &priv->paint_matrix);
+
     return cr;
 }
 
@@ -1465,6 +1743,7 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
 void awn_effects_cairo_destroy(AwnEffects* fx)
 {
     cairo_t* cr = fx->virtual_ctx;
+    gint64 start = awn_stats_now();
 
     /* FIXME: divide overlays into two lists - those where effects should be
      *  applied and where they shouldn't
@@ -1524,12 +1803,14 @@ void awn_effects_cairo_destroy(AwnEffects* fx)
     }
 
     if (fx->indirect_paint) {
+        cairo_surface_t* scratch = cairo_get_target(cr);
+
         cairo_set_operator(fx->window_ctx, CAIRO_OPERATOR_OVER);
-        cairo_set_source_surface(fx->window_ctx, cairo_get_target(cr), 0, 0);
+        cairo_set_source_surface(fx->window_ctx, scratch, 0, 0);
         cairo_paint(fx->window_ctx);
 
-        cairo_surface_destroy(cairo_get_target(cr));
         cairo_destroy(fx->virtual_ctx);
+        awn_surface_pool_return(scratch);
     }
     cairo_destroy(fx->window_ctx);
 
@@ -1538,6 +1819,14 @@ void awn_effects_cairo_destroy(AwnEffects* fx)
 
     fx->window_ctx = NULL;
     fx->virtual_ctx = NULL;
+    fx->priv->content_serial = 0;
+
+    if (quality.lowest > AWN_EFFECTS_QUALITY_FULL) {
+        gint64 now = awn_stats_now();
+        awn_effects_quality_add_cost(now, now - start);
+    }
+
+    AWN_STATS_TIMER_STOP(AWN_STATS_EFFECTS_PAINT, fx->priv->paint_start);
 }
 
 /**
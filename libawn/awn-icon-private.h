@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2008 Neil Jagdish Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-icon-private.h
+ *
+ * Private helper - lets libawn hand AwnIcon surfaces which stay unchanged,
+ * so effects derived from the look of the icon can be cached.
+ */
+
+#ifndef _AWN_ICON_PRIVATE_H
+#define _AWN_ICON_PRIVATE_H
+
+#include "awn-icon.h"
+
+void awn_icon_set_from_static_surface(AwnIcon* icon,
+                                      cairo_surface_t* surface);
+
+#endif /* _AWN_ICON_PRIVATE_H */
@@ -21,7 +21,9 @@
 #include <cairo/cairo-xlib.h>
 
 #include "awn-config.h"
+#include "awn-effects-ops-new.h"
 #include "awn-icon.h"
+#include "awn-icon-private.h"
 #include "awn-utils.h"
 #include "awn-overlayable.h"
 
@@ -66,6 +68,11 @@ struct _AwnIconPrivate {
 
     /* Info relating to the current icon */
     cairo_surface_t* icon_srfc;
+    /* changes with every icon set, lets the effects cache what they make
+     * out of it */
+    guint icon_serial;
+    /* nobody draws into icon_srfc behind our back */
+    gboolean icon_static;
 };
 
 enum {
@@ -179,6 +186,10 @@ awn_icon_expose_event(GtkWidget* widget, GdkEventExpose* event)
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     cairo_set_source_surface(cr, priv->icon_srfc, 0, 0);
     cairo_paint(cr);
+    /* a surface set from the outside may have been drawn into since */
+    if (priv->icon_static) {
+        awn_effects_set_content_serial(priv->effects, priv->icon_serial);
+    }
 
     /* let effects know we're finished */
     awn_effects_cairo_destroy(priv->effects);
@@ -351,6 +362,10 @@ awn_icon_constructed(GObject* object)
                                         fx, "reflection-alpha", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
                                         NULL);
+    desktop_agnostic_config_client_bind(client, "effects", "reflection_fade",
+                                        fx, "reflection-fade", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
     desktop_agnostic_config_client_bind(client, "effects", "reflection_offset",
                                         fx, "reflection-offset", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
@@ -371,6 +386,22 @@ awn_icon_constructed(GObject* object)
                                         fx, "make-shadow", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
                                         NULL);
+    desktop_agnostic_config_client_bind(client, "effects", "shadow_color",
+                                        fx, "shadow-color", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(client, "effects", "shadow_radius",
+                                        fx, "shadow-radius", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(client, "effects", "shadow_offset_x",
+                                        fx, "shadow-offset-x", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(client, "effects", "shadow_offset_y",
+                                        fx, "shadow-offset-y", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
     desktop_agnostic_config_client_bind(client, "effects", "arrow_icon",
                                         fx, "arrow-png", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
@@ -887,6 +918,17 @@ free_existing_icon(AwnIcon* icon)
     priv->icon_srfc = NULL;
 }
 
+static void
+bump_icon_serial(AwnIcon* icon)
+{
+    AwnIconPrivate* priv = icon->priv;
+
+    /* zero means unknown content to the effects */
+    if (++priv->icon_serial == 0) {
+        priv->icon_serial = 1;
+    }
+}
+
 /**
  * awn_icon_set_from_pixbuf:
  * @icon: an #AwnIcon.
@@ -919,6 +961,8 @@ awn_icon_set_from_pixbuf(AwnIcon* icon, GdkPixbuf* pixbuf)
     cairo_paint(temp_cr);
 
     cairo_destroy(temp_cr);
+    bump_icon_serial(icon);
+    priv->icon_static = TRUE;
 
     /* Queue a redraw */
     update_widget_size(icon);
@@ -948,6 +992,8 @@ awn_icon_set_from_surface(AwnIcon* icon, cairo_surface_t* surface)
     case CAIRO_SURFACE_TYPE_IMAGE:
         free_existing_icon(icon);
         priv->icon_srfc = cairo_surface_reference(surface);
+        bump_icon_serial(icon);
+        priv->icon_static = FALSE;
         break;
     default:
         g_warning("Invalid surface type: Surfaces must be either xlib or image");
@@ -958,6 +1004,20 @@ awn_icon_set_from_surface(AwnIcon* icon, cairo_surface_t* surface)
     gtk_widget_queue_draw(GTK_WIDGET(icon));
 }
 
+/* Like awn_icon_set_from_surface(), for surfaces which are never drawn into
+ * once they're set, so the effects may cache what they make out of them.
+ */
+void
+awn_icon_set_from_static_surface(AwnIcon* icon, cairo_surface_t* surface)
+{
+    g_return_if_fail(AWN_IS_ICON(icon));
+
+    awn_icon_set_from_surface(icon, surface);
+    if (icon->priv->icon_srfc == surface) {
+        icon->priv->icon_static = TRUE;
+    }
+}
+
 /**
  * awn_icon_set_from_context:
  * @icon: an #AwnIcon.
@@ -46,8 +46,10 @@
 
 #include <string.h>
 #include <math.h>
+#include <glib/gstdio.h>
 
 #include "awn-overlay-pixbuf-file.h"
+#include "awn-pixbuf-cache.h"
 
 extern "C" {
     G_DEFINE_TYPE(AwnOverlayPixbufFile, awn_overlay_pixbuf_file, AWN_TYPE_OVERLAY_PIXBUF)
@@ -60,10 +62,16 @@ typedef struct _AwnOverlayPixbufFilePrivate AwnOverlayPixbufFilePrivate;
 
 struct _AwnOverlayPixbufFilePrivate {
     gchar* file_name;
-    GHashTable* pixbufs;
 
     gint  icon_width;
     gint  icon_height;
+    /*the size the current pixbuf was requested at, -1 if nothing is loaded*/
+    gint  loaded_width;
+    gint  loaded_height;
+    /*modification time of the file when it was loaded*/
+    time_t loaded_mtime;
+    /*monotonic time the modification time was last looked at*/
+    gint64 mtime_checked;
     /*Used to keep missing file from spamming the console messages*/
     gboolean  emitted_warning;
 };
@@ -73,6 +81,9 @@ enum {
     PROP_FILE_NAME
 };
 
+/*how often render looks for a changed file (microseconds)*/
+#define MTIME_CHECK_INTERVAL G_USEC_PER_SEC
+
 static gboolean
 awn_overlay_pixbuf_file_load(AwnOverlayPixbufFile* overlay,
                              gchar* filename);
@@ -134,7 +145,6 @@ awn_overlay_pixbuf_file_finalize(GObject* object)
     AwnOverlayPixbufFilePrivate* priv = AWN_OVERLAY_PIXBUF_FILE_GET_PRIVATE(object);
 
     g_free(priv->file_name);
-    g_hash_table_destroy(priv->pixbufs);
 
     G_OBJECT_CLASS(awn_overlay_pixbuf_file_parent_class)->finalize(object);
 }
@@ -149,9 +159,9 @@ _awn_overlaid_pixbuf_file_clear_hash(GObject* pspec,
 
     g_object_set(overlay, "pixbuf", NULL, NULL);
 
-    /*clear the hash table... the icon has changed in some fundamental way*/
-    g_hash_table_remove_all(priv->pixbufs);
-
+    /*the file has changed... force a (cached) load on the next render*/
+    priv->loaded_width = -1;
+    priv->loaded_height = -1;
 }
 
 static void
@@ -199,8 +209,11 @@ awn_overlay_pixbuf_file_init(AwnOverlayPixbufFile* self)
 
     priv->icon_height = 48;  /*FIXME replaces with a named constant */
     priv->icon_width = 48;
+    priv->loaded_width = -1;
+    priv->loaded_height = -1;
+    priv->loaded_mtime = 0;
+    priv->mtime_checked = 0;
     priv->file_name = NULL;
-    priv->pixbufs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
 }
 
 AwnOverlayPixbufFile*
@@ -212,12 +225,25 @@ awn_overlay_pixbuf_file_new(gchar* file_name)
 }
 
 
-/*
- FIXME
+static time_t
+awn_overlay_pixbuf_file_get_mtime(const gchar* file_name)
+{
+    struct stat st;
 
- This function needs a little bit of work.  It can be cleaner.
+    if (g_stat(file_name, &st) != 0) {
+        return 0;
+    }
+    return st.st_mtime;
+}
 
- Also need to decide if it merits pixbuf caching... probably a good idea
+/*
+ The file is only (re)loaded when the requested size differs from the size
+ the current pixbuf was loaded at, or when the file changed on disk (looked
+ at once per MTIME_CHECK_INTERVAL).  Loaded pixbufs are shared through the
+ default AwnPixbufCache, keyed by path, modification time and size, so
+ stale entries are never hit and age out under the cache's size limit.
+ AwnOverlayPixbuf attaches its converted surface to the pixbuf, so overlays
+ showing the same file share the decoded surface.
  */
 
 static void
@@ -238,8 +264,8 @@ _awn_overlay_pixbuf_file_render(AwnOverlay* _overlay,
 
     g_return_if_fail(priv->file_name);
 
-    priv->icon_height = icon_width;  /*stored so we know what size to ask for when file name changed*/
-    priv->icon_width = icon_height;
+    priv->icon_width = icon_width;  /*stored so we know what size to ask for when file name changed*/
+    priv->icon_height = icon_height;
 
 
     g_object_get(_overlay,
@@ -252,13 +278,22 @@ _awn_overlay_pixbuf_file_render(AwnOverlay* _overlay,
                            scaled_width /
                            icon_width);
 
-    if (!current_pixbuf) {
+    if (!current_pixbuf ||
+            (priv->loaded_width != scaled_width) ||
+            (priv->loaded_height != scaled_height)) {
         good = awn_overlay_pixbuf_file_load(overlay, priv->file_name);
-    } else if ((gdk_pixbuf_get_width(current_pixbuf) != scaled_width) &&
-               (gdk_pixbuf_get_height(current_pixbuf) != scaled_height)) {
-        g_object_unref(current_pixbuf);
-        awn_overlay_pixbuf_file_load(overlay, priv->file_name);
     } else {
+        gint64 now = g_get_monotonic_time();
+
+        if (now - priv->mtime_checked > MTIME_CHECK_INTERVAL) {
+            priv->mtime_checked = now;
+            if (awn_overlay_pixbuf_file_get_mtime(priv->file_name) !=
+                    priv->loaded_mtime) {
+                good = awn_overlay_pixbuf_file_load(overlay, priv->file_name);
+            }
+        }
+    }
+    if (current_pixbuf) {
         g_object_unref(current_pixbuf);
     }
 
@@ -276,6 +311,8 @@ awn_overlay_pixbuf_file_load(AwnOverlayPixbufFile* overlay,
     GdkPixbuf* pixbuf;
     gint scaled_width;
     gint scaled_height;
+    time_t mtime;
+    gchar* key;
     AwnOverlayPixbufFilePrivate* priv = AWN_OVERLAY_PIXBUF_FILE_GET_PRIVATE(overlay);
 
     g_object_get(overlay,
@@ -295,15 +332,34 @@ awn_overlay_pixbuf_file_load(AwnOverlayPixbufFile* overlay,
                            scaled_width /
                            priv->icon_width);
 
-    pixbuf = gdk_pixbuf_new_from_file_at_scale(file_name,
-             scaled_width,
-             scaled_height,
-             TRUE, NULL);
+    mtime = awn_overlay_pixbuf_file_get_mtime(file_name);
+    priv->mtime_checked = g_get_monotonic_time();
+
+    key = g_strdup_printf("awn-overlay-pixbuf-file::%s::%ld::%dx%d",
+                          file_name, (glong)mtime,
+                          scaled_width, scaled_height);
+    pixbuf = awn_pixbuf_cache_lookup_simple_key(awn_pixbuf_cache_get_default(),
+             key, scaled_width, scaled_height);
+    if (!pixbuf) {
+        pixbuf = gdk_pixbuf_new_from_file_at_scale(file_name,
+                 scaled_width,
+                 scaled_height,
+                 TRUE, NULL);
+        if (pixbuf) {
+            awn_pixbuf_cache_insert_pixbuf_simple_key(awn_pixbuf_cache_get_default(),
+                    pixbuf, key);
+        }
+    }
+    g_free(key);
+
     if (pixbuf) {
         g_object_set(overlay,
                      "pixbuf", pixbuf,
                      NULL);
         g_object_unref(pixbuf);
+        priv->loaded_width = scaled_width;
+        priv->loaded_height = scaled_height;
+        priv->loaded_mtime = mtime;
     } else {
         if (!priv->emitted_warning) {
             g_warning("%s: Failed to load pixbuf (%s)", __func__, file_name);
@@ -46,6 +46,7 @@
 #include <math.h>
 
 #include "awn-overlay-pixbuf.h"
+#include "awn-cairo-utils.h"
 
 enum {
     PROP_0,
@@ -65,11 +66,17 @@ typedef struct _AwnOverlayPixbufPrivate AwnOverlayPixbufPrivate;
 
 struct _AwnOverlayPixbufPrivate {
     GdkPixbuf* pixbuf;
-    GdkPixbuf* scaled_pixbuf;
+    /* premultiplied copy of the pixbuf at the size last rendered */
+    cairo_surface_t* surface;
     gdouble scale;
     gdouble alpha;
 };
 
+/* Key used to attach the converted surface to a pixbuf, so overlays sharing
+ * a pixbuf (via the pixbuf cache, for example) share the conversion as well.
+ */
+#define SURFACE_DATA_KEY "awn-overlay-pixbuf-surface"
+
 
 static void
 _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
@@ -109,9 +116,9 @@ awn_overlay_pixbuf_set_property(GObject* object, guint property_id,
             g_object_unref(priv->pixbuf);
         }
         priv->pixbuf = g_value_dup_object(value);
-        if (priv->scaled_pixbuf) {
-            g_object_unref(priv->scaled_pixbuf);
-            priv->scaled_pixbuf = NULL;
+        if (priv->surface) {
+            cairo_surface_destroy(priv->surface);
+            priv->surface = NULL;
         }
         break;
     case PROP_SCALE:
@@ -138,8 +145,8 @@ awn_overlay_pixbuf_finalize(GObject* object)
     if (priv->pixbuf) {
         g_object_unref(priv->pixbuf);
     }
-    if (priv->scaled_pixbuf) {
-        g_object_unref(priv->scaled_pixbuf);
+    if (priv->surface) {
+        cairo_surface_destroy(priv->surface);
     }
     G_OBJECT_CLASS(awn_overlay_pixbuf_parent_class)->finalize(object);
 }
@@ -210,7 +217,7 @@ awn_overlay_pixbuf_init(AwnOverlayPixbuf* self)
 {
     AwnOverlayPixbufPrivate* priv = AWN_OVERLAY_PIXBUF_GET_PRIVATE(self);
 
-    priv->scaled_pixbuf = NULL;
+    priv->surface = NULL;
 }
 
 /**
@@ -240,6 +247,23 @@ awn_overlay_pixbuf_new_with_pixbuf(GdkPixbuf* pixbuf)
     return ret;
 }
 
+/* Returns a new reference to the surface attached to pixbuf, converting it
+ * on first use.
+ */
+static cairo_surface_t*
+_awn_overlay_pixbuf_get_surface(GdkPixbuf* pixbuf)
+{
+    cairo_surface_t* surface;
+
+    surface = g_object_get_data(G_OBJECT(pixbuf), SURFACE_DATA_KEY);
+    if (!surface) {
+        surface = awn_cairo_image_surface_new_from_pixbuf(pixbuf);
+        g_object_set_data_full(G_OBJECT(pixbuf), SURFACE_DATA_KEY, surface,
+                               (GDestroyNotify)cairo_surface_destroy);
+    }
+    return cairo_surface_reference(surface);
+}
+
 static void
 _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
                            GtkWidget* widget,
@@ -272,21 +296,27 @@ _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
     }
 
     /* Why do we do this?  Well the gdk pixbuf scaling gives a better result than
-     the cairo scaling when dealing with a source pixbuf */
-    if (!priv->scaled_pixbuf || (scaled_width != gdk_pixbuf_get_width(priv->scaled_pixbuf)) ||
-            (scaled_height != gdk_pixbuf_get_height(priv->scaled_pixbuf))) {
-        if (priv->scaled_pixbuf) {
-            g_object_unref(priv->scaled_pixbuf);
-            priv->scaled_pixbuf = NULL;
+     the cairo scaling when dealing with a source pixbuf.  The scaled result is
+     converted to a premultiplied image surface once, and reused until the
+     pixbuf or the target size changes */
+    if (!priv->surface ||
+            (scaled_width != cairo_image_surface_get_width(priv->surface)) ||
+            (scaled_height != cairo_image_surface_get_height(priv->surface))) {
+        if (priv->surface) {
+            cairo_surface_destroy(priv->surface);
+            priv->surface = NULL;
         }
         if ((scaled_width == pixbuf_width) && (scaled_height == pixbuf_height)) {
-            g_object_ref(priv->pixbuf);
-            priv->scaled_pixbuf = priv->pixbuf;
+            priv->surface = _awn_overlay_pixbuf_get_surface(priv->pixbuf);
         } else {
-            priv->scaled_pixbuf = gdk_pixbuf_scale_simple(priv->pixbuf,
-                                  scaled_width,
-                                  scaled_height,
-                                  GDK_INTERP_BILINEAR);
+            GdkPixbuf* scaled_pixbuf;
+
+            scaled_pixbuf = gdk_pixbuf_scale_simple(priv->pixbuf,
+                                                    scaled_width,
+                                                    scaled_height,
+                                                    GDK_INTERP_BILINEAR);
+            priv->surface = awn_cairo_image_surface_new_from_pixbuf(scaled_pixbuf);
+            g_object_unref(scaled_pixbuf);
         }
     }
 
@@ -304,7 +334,7 @@ _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     }
 
-    gdk_cairo_set_source_pixbuf(cr, priv->scaled_pixbuf, coord.x, coord.y);
+    cairo_set_source_surface(cr, priv->surface, coord.x, coord.y);
     cairo_paint_with_alpha(cr, priv->alpha);
     cairo_restore(cr);
 }
@@ -23,6 +23,7 @@
 #include <math.h>
 
 #include "awn-overlay-throbber.h"
+#include "awn-throbber-sprite.h"
 
 /**
  * SECTION: awn-overlay-throbber
@@ -55,6 +56,8 @@ struct _AwnOverlayThrobberPrivate {
     guint       timer_id;
     guint       timeout;
     gdouble     scale;
+
+    AwnThrobberSprite sprite;
 };
 
 enum {
@@ -110,9 +113,10 @@ awn_overlay_throbber_dispose(GObject* object)
     AwnOverlayThrobberPrivate* priv = AWN_OVERLAY_THROBBER_GET_PRIVATE(object);
 
     if (priv->timer_id) {
-        g_source_remove(priv->timer_id);
+        awn_throbber_tick_remove(priv->timer_id);
         priv->timer_id = 0;
     }
+    awn_throbber_sprite_clear(&priv->sprite);
 
     G_OBJECT_CLASS(awn_overlay_throbber_parent_class)->dispose(object);
 }
@@ -146,11 +150,13 @@ _awn_overlay_throbber_active_changed(GObject*    pspec,
                  NULL);
     if (active_val) {
         if (!priv->timer_id) {
-            priv->timer_id = g_timeout_add(priv->timeout, _awn_overlay_throbber_timeout, throbber);
+            priv->timer_id = awn_throbber_tick_add(priv->timeout,
+                                                   _awn_overlay_throbber_timeout,
+                                                   throbber);
         }
     } else {
         if (priv->timer_id) {
-            g_source_remove(priv->timer_id);
+            awn_throbber_tick_remove(priv->timer_id);
             priv->timer_id = 0;
         }
     }
@@ -170,9 +176,11 @@ _awn_overlay_throbber_timeout_changed(GObject*    pspec,
                  NULL);
     if (active_val) {
         if (priv->timer_id) {
-            g_source_remove(priv->timer_id);
+            awn_throbber_tick_remove(priv->timer_id);
         }
-        priv->timer_id = g_timeout_add(priv->timeout, _awn_overlay_throbber_timeout, throbber);
+        priv->timer_id = awn_throbber_tick_add(priv->timeout,
+                                               _awn_overlay_throbber_timeout,
+                                               throbber);
     }
 }
 
@@ -244,6 +252,9 @@ awn_overlay_throbber_class_init(AwnOverlayThrobberClass* klass)
 static void
 awn_overlay_throbber_init(AwnOverlayThrobber* self)
 {
+    AwnOverlayThrobberPrivate* priv = AWN_OVERLAY_THROBBER_GET_PRIVATE(self);
+
+    priv->sprite.strip = NULL;
 }
 
 
@@ -272,22 +283,24 @@ _awn_overlay_throbber_render(AwnOverlay* overlay,
 {
     AwnOverlayThrobberPrivate* priv = AWN_OVERLAY_THROBBER_GET_PRIVATE(overlay);
 
-    const gdouble RADIUS = 0.0625;
-    const gdouble DIST = 0.3;
-    const gdouble OTHER = DIST * 0.707106781; /* sqrt(2)/2 */
-    const gint COUNT = 8;
-    const gint counter = priv->counter;
+    const gdouble WHITE[4] = {1.0, 1.0, 1.0, 1.0};
     gdouble scale;
     AwnOverlayCoord coord;
-    gdouble scaled_height;
-    gdouble scaled_width;
+    gint scaled_height;
+    gint scaled_width;
 
     g_object_get(overlay,
                  "scale", &scale,
                  NULL);
 
-    scaled_height = icon_height * scale;
-    scaled_width = icon_width * scale;
+    scaled_height = lround(icon_height * scale);
+    scaled_width = lround(icon_width * scale);
+
+    /* all frames are pre-rendered into a strip, rebuilt only on size change */
+    awn_throbber_sprite_ensure(&priv->sprite, cr,
+                               scaled_width, scaled_height,
+                               WHITE, NULL, 0.0);
+
     cairo_save(cr);
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     cairo_save(cr);
@@ -299,43 +312,9 @@ _awn_overlay_throbber_render(AwnOverlay* overlay,
                         scaled_height,
                         &coord);
     cairo_restore(cr);
-    cairo_translate(cr, coord.x  , coord.y);
-    cairo_scale(cr, scaled_width, scaled_height);
-
-    cairo_translate(cr, 0.50, 0.50);
-    cairo_scale(cr, 1, -1);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 0) % COUNT) / (float)COUNT);
-    cairo_arc(cr, 0, DIST, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 1) % COUNT) / (float)COUNT);
-    cairo_arc(cr, OTHER, OTHER, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 2) % COUNT) / (float)COUNT);
-    cairo_arc(cr, DIST, 0, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 3) % COUNT) / (float)COUNT);
-    cairo_arc(cr, OTHER, -OTHER, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 4) % COUNT) / (float)COUNT);
-    cairo_arc(cr, 0, -DIST, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 5) % COUNT) / (float)COUNT);
-    cairo_arc(cr, -OTHER, -OTHER, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
-
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 6) % COUNT) / (float)COUNT);
-    cairo_arc(cr, -DIST, 0, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
 
-    cairo_set_source_rgba(cr, 1, 1, 1, ((counter + 7) % COUNT) / (float)COUNT);
-    cairo_arc(cr, -OTHER, OTHER, RADIUS, 0, 2 * M_PI);
-    cairo_fill(cr);
+    awn_throbber_sprite_paint(&priv->sprite, cr, priv->counter,
+                              coord.x, coord.y);
 
     cairo_restore(cr);
 }
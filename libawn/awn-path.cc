@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "awn-path.h"
+
+/*
+ * Profiles are sampled once per pixel whenever the panel geometry changes,
+ * lookups are then a single array access. The ellipse profile is the half
+ * sine used by awn_utils_get_offset_modifier_by_path_type() split into eight
+ * cubic Hermite pieces (max error ~1e-4 of the curve height). Further path
+ * types only need another entry in path_profiles.
+ */
+
+static const AwnPathSegment ellipse_segments[] = {
+    { 0.000f, 0.125f, { 0.0000000f, 0.1308997f, 0.2617479f, 0.3826834f } },
+    { 0.125f, 0.250f, { 0.3826834f, 0.5036190f, 0.6145467f, 0.7071068f } },
+    { 0.250f, 0.375f, { 0.7071068f, 0.7996668f, 0.8737864f, 0.9238795f } },
+    { 0.375f, 0.500f, { 0.9238795f, 0.9739727f, 1.0000000f, 1.0000000f } },
+    { 0.500f, 0.625f, { 1.0000000f, 1.0000000f, 0.9739727f, 0.9238795f } },
+    { 0.625f, 0.750f, { 0.9238795f, 0.8737864f, 0.7996668f, 0.7071068f } },
+    { 0.750f, 0.875f, { 0.7071068f, 0.6145467f, 0.5036190f, 0.3826834f } },
+    { 0.875f, 1.000f, { 0.3826834f, 0.2617479f, 0.1308997f, 0.0000000f } }
+};
+
+typedef struct {
+    const AwnPathSegment* segments;
+    guint n_segments;
+} AwnPathProfile;
+
+static const AwnPathProfile path_profiles[AWN_PATH_LAST] = {
+    /* AWN_PATH_LINEAR */
+    { NULL, 0 },
+    /* AWN_PATH_ELLIPSE */
+    { ellipse_segments, G_N_ELEMENTS(ellipse_segments) }
+};
+
+/* Whether the curve height grows with the offset (see the ellipse). */
+static gboolean
+path_type_scales_with_offset(AwnPathType path_type)
+{
+    return path_type != AWN_PATH_LINEAR;
+}
+
+/**
+ * awn_path_profile_evaluate:
+ * @path_type: the path type.
+ * @relative_pos: position along the panel, 0.0 to 1.0.
+ *
+ * Returns: height of the profile at @relative_pos, 0.0 to 1.0.
+ */
+gfloat
+awn_path_profile_evaluate(AwnPathType path_type, gfloat relative_pos)
+{
+    const AwnPathProfile* profile;
+    const AwnPathSegment* seg;
+    gfloat t, u;
+    guint i;
+
+    if (path_type < 0 || path_type >= AWN_PATH_LAST) {
+        return 0.0f;
+    }
+
+    profile = &path_profiles[path_type];
+    if (profile->n_segments == 0 ||
+            relative_pos < profile->segments[0].x0 ||
+            relative_pos > profile->segments[profile->n_segments - 1].x1) {
+        return 0.0f;
+    }
+
+    for (i = 0; i < profile->n_segments - 1; i++) {
+        if (relative_pos < profile->segments[i].x1) {
+            break;
+        }
+    }
+    seg = &profile->segments[i];
+
+    t = (relative_pos - seg->x0) / (seg->x1 - seg->x0);
+    u = 1.0f - t;
+
+    return u * u * u * seg->y[0] + 3.0f * u * u * t * seg->y[1] +
+           3.0f * u * t * t * seg->y[2] + t * t * t * seg->y[3];
+}
+
+/**
+ * awn_path_table_ensure:
+ * @table: an #AwnPathTable, zero-filled before first use.
+ * @path_type: the path type.
+ * @offset: panel offset.
+ * @offset_modifier: curve height.
+ * @length: length of the panel in pixels.
+ *
+ * Rebuilds @table if any of the parameters changed since the last call.
+ *
+ * Returns: TRUE if the table was rebuilt.
+ */
+gboolean
+awn_path_table_ensure(AwnPathTable* table,
+                      AwnPathType path_type,
+                      gint offset, gfloat offset_modifier,
+                      gint length)
+{
+    gfloat height;
+    gint i;
+
+    g_return_val_if_fail(table, FALSE);
+
+    if (table->valid && table->path_type == path_type &&
+            table->offset == offset &&
+            table->offset_modifier == offset_modifier &&
+            table->length == length) {
+        return FALSE;
+    }
+
+    table->path_type = path_type;
+    table->offset = offset;
+    table->offset_modifier = offset_modifier;
+    table->length = length;
+    table->valid = TRUE;
+
+    if (length <= 0) {
+        return TRUE;
+    }
+
+    // one entry for each pixel including both ends
+    if (table->allocated < length + 1) {
+        g_free(table->offsets);
+        table->offsets = g_new(gfloat, length + 1);
+        table->allocated = length + 1;
+    }
+
+    if (!path_type_scales_with_offset(path_type)) {
+        for (i = 0; i <= length; i++) {
+            table->offsets[i] = offset;
+        }
+        return TRUE;
+    }
+
+    // let the max raise with higher offset
+    height = offset_modifier + sqrt(offset);
+    for (i = 0; i <= length; i++) {
+        table->offsets[i] =
+            awn_path_profile_evaluate(path_type, i / (gfloat)length) * height
+            + offset;
+    }
+
+    return TRUE;
+}
+
+/**
+ * awn_path_table_get_offset:
+ * @table: an #AwnPathTable.
+ * @pos: position along the panel in pixels.
+ *
+ * Returns: offset at @pos, positions outside of the panel are clamped.
+ */
+gfloat
+awn_path_table_get_offset(AwnPathTable* table, gint pos)
+{
+    g_return_val_if_fail(table && table->valid, 0.0f);
+
+    if (table->length <= 0) {
+        return table->offset;
+    }
+
+    return table->offsets[CLAMP(pos, 0, table->length)];
+}
+
+void
+awn_path_table_clear(AwnPathTable* table)
+{
+    g_free(table->offsets);
+    memset(table, 0, sizeof(AwnPathTable));
+}
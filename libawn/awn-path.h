@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-path.h
+ *
+ * Private helpers shared by the panel and AwnApplet: a lookup table with the
+ * curve offset for every pixel along the panel, built from a piecewise cubic
+ * Bezier profile registered for each AwnPathType.
+ */
+
+#ifndef _AWN_PATH_H
+#define _AWN_PATH_H
+
+#include <glib.h>
+
+#include "awn-defines.h"
+
+typedef struct _AwnPathSegment AwnPathSegment;
+typedef struct _AwnPathTable AwnPathTable;
+
+/* One cubic Bezier piece of a profile; the curve goes from x0 to x1 (both
+ * in 0..1 along the panel) through the control values y[0]..y[3]. */
+struct _AwnPathSegment {
+    gfloat x0, x1;
+    gfloat y[4];
+};
+
+struct _AwnPathTable {
+    gfloat* offsets;
+    gint    allocated;
+
+    /* inputs the table was built for */
+    AwnPathType path_type;
+    gint        offset;
+    gfloat      offset_modifier;
+    gint        length;
+    gboolean    valid;
+};
+
+gfloat
+awn_path_profile_evaluate(AwnPathType path_type, gfloat relative_pos);
+
+gboolean
+awn_path_table_ensure(AwnPathTable* table,
+                      AwnPathType path_type,
+                      gint offset, gfloat offset_modifier,
+                      gint length);
+
+gfloat
+awn_path_table_get_offset(AwnPathTable* table, gint pos);
+
+void
+awn_path_table_clear(AwnPathTable* table);
+
+#endif
@@ -36,6 +36,7 @@
 #include "glib.h"
 
 #include "awn-pixbuf-cache.h"
+#include "awn-stats.h"
 
 extern "C" {
     G_DEFINE_TYPE(AwnPixbufCache, awn_pixbuf_cache, G_TYPE_OBJECT)
@@ -54,6 +55,10 @@ enum {
 
 struct _AwnPixbufCachePrivate {
     GHashTable*   pixbufs;
+    GHashTable*   surfaces;
+    /*bumped on every invalidate so holders of cached items can tell*/
+    guint               generation;
+    /*pixbufs and surfaces, most recently used first*/
     GList*                accessed;
     /*maintain this ourselves... yes we could get this GHashTable or GList*/
     guint               num_pixbufs;
@@ -97,6 +102,10 @@ awn_pixbuf_cache_dispose(GObject* object)
         g_hash_table_destroy(priv->pixbufs);
         priv->pixbufs = NULL;
     }
+    if (priv->surfaces) {
+        g_hash_table_destroy(priv->surfaces);
+        priv->surfaces = NULL;
+    }
     if (priv->accessed) {
         /* The list does not own any references to the data*/
         g_list_free(priv->accessed);
@@ -133,7 +142,7 @@ awn_pixbuf_cache_class_init(AwnPixbufCacheClass* klass)
 
     pspec = g_param_spec_uint("max_cache_size",
                               "max_cache_size",
-                              "Maximum number of pixbufs in the cache",
+                              "Maximum number of pixbufs and surfaces in the cache",
                               0,
                               10000,
                               25,
@@ -157,6 +166,9 @@ awn_pixbuf_cache_init(AwnPixbufCache* self)
     AwnPixbufCachePrivate* priv = GET_PRIVATE(self);
     priv->pixbufs = g_hash_table_new_full(g_str_hash, g_str_equal,
                                           g_free, (GDestroyNotify)awn_pixbuf_cache_item_unref);
+    priv->surfaces = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                           g_free, (GDestroyNotify)cairo_surface_destroy);
+    priv->generation = 0;
     priv->accessed = NULL;
     priv->num_pixbufs = 0;
     g_get_current_time(&priv->last_prune);
@@ -190,6 +202,23 @@ awn_pixbuf_cache_get_default(void)
     return def_cache;
 }
 
+static void
+awn_pixbuf_cache_prune_table(GHashTable* table, GList* accessed,
+                             gint target_size)
+{
+    GList* keys = g_hash_table_get_keys(table);
+    GList* iter_keys;
+
+    for (iter_keys = keys; iter_keys; iter_keys = g_list_next(iter_keys)) {
+        gpointer value = g_hash_table_lookup(table, iter_keys->data);
+        if (g_list_position(accessed, g_list_find(accessed, value)) >= target_size) {
+            g_message("%s: removing item %p", __func__, value);
+            g_hash_table_remove(table, iter_keys->data);
+        }
+    }
+    g_list_free(keys);
+}
+
 /*
  Relatively lazy about pruning the cache.  It will get done though.
  */
@@ -207,47 +236,94 @@ awn_pixbuf_cache_prune(AwnPixbufCache* pixbuf_cache)
     if (priv->num_pixbufs > priv->max_cache_size) {
         if (current_time.tv_sec - priv->last_prune.tv_sec > MAX_PRUNE_FREQ) {
             gint target_size = priv->max_cache_size * PRUNE_PERCENT;
-            GList* keys = g_hash_table_get_keys(priv->pixbufs);
-            GList* iter_keys;
-            for (iter_keys = keys; iter_keys; iter_keys = g_list_next(iter_keys)) {
-                GdkPixbuf* value = g_hash_table_lookup(priv->pixbufs, iter_keys->data);
-                if (g_list_position(priv->accessed, g_list_find(priv->accessed, value)) >= target_size) {
-                    g_message("%s: removing pixbuf %p", __func__, value);
-                    g_hash_table_remove(priv->pixbufs, iter_keys->data);
-                }
-            }
+            awn_pixbuf_cache_prune_table(priv->pixbufs, priv->accessed,
+                                         target_size);
+            awn_pixbuf_cache_prune_table(priv->surfaces, priv->accessed,
+                                         target_size);
             /*nasty*/
             while ((gint)g_list_length(priv->accessed) >= target_size) {
                 priv->accessed = g_list_delete_link(priv->accessed, g_list_last(priv->accessed));
                 priv->num_pixbufs--;
             }
             priv->last_prune = current_time;
-            g_list_free(keys);
         } else {
             g_warning("%s: Frequent pruning is occurring last prune was %lds ago.  This should, generally, not occur (panel resizes being an acception). Consider increasing the max-cache-size property of the applet's AwnPixbufCache object", __func__, current_time.tv_sec - priv->last_prune.tv_sec);
         }
     }
 }
 
+/*
+ @item is either a GdkPixbuf or a cairo_surface_t, both count towards
+ max_cache_size.
+ */
 static void
-awn_pixbuf_cache_check(AwnPixbufCache* pixbuf_cache, GdkPixbuf* pbuf)
+awn_pixbuf_cache_check(AwnPixbufCache* pixbuf_cache, gpointer item)
 {
     AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
     GList* needle;
 
-    needle = g_list_find(priv->accessed, pbuf);
+    needle = g_list_find(priv->accessed, item);
     if (needle) {
         priv->accessed = g_list_delete_link(priv->accessed, needle);
     } else {
         priv->num_pixbufs++;
     }
-    priv->accessed = g_list_prepend(priv->accessed, pbuf);
+    priv->accessed = g_list_prepend(priv->accessed, item);
     if (priv->num_pixbufs > priv->max_cache_size) {
         awn_pixbuf_cache_prune(pixbuf_cache);
     }
     g_assert(priv->num_pixbufs == g_list_length(priv->accessed));
 }
 
+/*
+ @item was found by a lookup, it's the last one to be pruned now.
+ */
+static void
+awn_pixbuf_cache_touch(AwnPixbufCache* pixbuf_cache, gpointer item)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+    GList* needle;
+
+    needle = g_list_find(priv->accessed, item);
+    if (needle && needle != priv->accessed) {
+        priv->accessed = g_list_remove_link(priv->accessed, needle);
+        priv->accessed = g_list_concat(needle, priv->accessed);
+    }
+}
+
+static gboolean
+awn_pixbuf_cache_value_equal(gpointer key, gpointer value, gpointer item)
+{
+    return value == item;
+}
+
+/*
+ Stores @value under @key in @table.  An item which was replaced doesn't
+ count towards max_cache_size any more, unless another key still holds it.
+ Only the pointer of the replaced item is compared, it may be gone already.
+ */
+static void
+awn_pixbuf_cache_replace(AwnPixbufCache* pixbuf_cache, GHashTable* table,
+                         gchar* key, gpointer value)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+    gpointer old = g_hash_table_lookup(table, key);
+    GList* needle;
+
+    g_hash_table_insert(table, key, value);
+
+    if (old == NULL || old == value ||
+            g_hash_table_find(table, awn_pixbuf_cache_value_equal, old)) {
+        return;
+    }
+
+    needle = g_list_find(priv->accessed, old);
+    if (needle) {
+        priv->accessed = g_list_delete_link(priv->accessed, needle);
+        priv->num_pixbufs--;
+    }
+}
+
 /**
  * awn_pixbuf_cache_insert_pixbuf:
  * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
@@ -275,8 +351,8 @@ awn_pixbuf_cache_insert_pixbuf(AwnPixbufCache* pixbuf_cache,
                           icon_name,
                           -1,
                           gdk_pixbuf_get_height(pbuf));
-    g_hash_table_insert(priv->pixbufs, key, pbuf);
-    g_object_ref(pbuf);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->pixbufs, key,
+                             g_object_ref(pbuf));
 
     key = g_strdup_printf("%s::%s::%s::%dx%d",
                           scope ? scope : "__NONE__",
@@ -285,8 +361,8 @@ awn_pixbuf_cache_insert_pixbuf(AwnPixbufCache* pixbuf_cache,
                           gdk_pixbuf_get_width(pbuf),
                           -1
                          );
-    g_hash_table_insert(priv->pixbufs, key, pbuf);
-    g_object_ref(pbuf);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->pixbufs, key,
+                             g_object_ref(pbuf));
 
     key = g_strdup_printf("%s::%s::%s::%dx%d",
                           scope ? scope : "__NONE__",
@@ -294,8 +370,8 @@ awn_pixbuf_cache_insert_pixbuf(AwnPixbufCache* pixbuf_cache,
                           icon_name,
                           gdk_pixbuf_get_width(pbuf),
                           gdk_pixbuf_get_height(pbuf));
-    g_hash_table_insert(priv->pixbufs, key, pbuf);
-    g_object_ref(pbuf);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->pixbufs, key,
+                             g_object_ref(pbuf));
     awn_pixbuf_cache_check(pixbuf_cache, pbuf);
 }
 
@@ -307,7 +383,8 @@ awn_pixbuf_cache_insert_pixbuf(AwnPixbufCache* pixbuf_cache,
  *
  * Inserts the pixbuf into the icon cache using simple_key as the key.  Use
  * in conjunction with awn_pixbuf_cache_lookup_simple_key.  It's normally best
- * to use awn_pixbuf_cache_insert_pixbuf() instead.
+ * to use awn_pixbuf_cache_insert_pixbuf() instead.  The pixbuf counts towards
+ * the max_cache_size property like the ones inserted with the other keys.
  */
 
 void
@@ -317,8 +394,9 @@ awn_pixbuf_cache_insert_pixbuf_simple_key(AwnPixbufCache* pixbuf_cache,
 {
     AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
 
-    g_hash_table_insert(priv->pixbufs, g_strdup(simple_key), pbuf);
-    g_object_ref(pbuf);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->pixbufs,
+                             g_strdup(simple_key), g_object_ref(pbuf));
+    awn_pixbuf_cache_check(pixbuf_cache, pbuf);
 }
 
 /**
@@ -351,7 +429,7 @@ awn_pixbuf_cache_insert_null_result(AwnPixbufCache* pixbuf_cache,
                           width,
                           height);
 
-    g_hash_table_insert(priv->pixbufs, key, NULL);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->pixbufs, key, NULL);
 
 }
 
@@ -377,7 +455,10 @@ awn_pixbuf_cache_lookup_simple_key(AwnPixbufCache* pixbuf_cache,
     AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
 
     pixbuf = g_hash_table_lookup(priv->pixbufs, simple_key);
+    AWN_STATS_COUNT(pixbuf ? AWN_STATS_PIXBUF_CACHE_HIT :
+                    AWN_STATS_PIXBUF_CACHE_MISS);
     if (pixbuf) {
+        awn_pixbuf_cache_touch(pixbuf_cache, pixbuf);
         g_object_ref(pixbuf);
     }
     return pixbuf;
@@ -419,7 +500,11 @@ awn_pixbuf_cache_lookup(AwnPixbufCache* pixbuf_cache,
     gboolean success;
 
     success = g_hash_table_lookup_extended(priv->pixbufs, key, NULL, &pixbuf);
+    /* a cached failure to load saves as much work as a cached pixbuf */
+    AWN_STATS_COUNT(success ? AWN_STATS_PIXBUF_CACHE_HIT :
+                    AWN_STATS_PIXBUF_CACHE_MISS);
     if (pixbuf) {
+        awn_pixbuf_cache_touch(pixbuf_cache, pixbuf);
         g_object_ref(pixbuf);
     }
     if (null_result && !pixbuf) {
@@ -447,9 +532,112 @@ awn_pixbuf_cache_invalidate(AwnPixbufCache* pixbuf_cache)
     AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
 
     g_hash_table_remove_all(priv->pixbufs);
+    g_hash_table_remove_all(priv->surfaces);
+    priv->generation++;
     g_list_free(priv->accessed);
     priv->accessed = NULL;
     priv->num_pixbufs = 0;
     g_get_current_time(&priv->last_prune);
 }
 
+
+/**
+ * awn_pixbuf_cache_insert_surface:
+ * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
+ * @surface: A premultiplied #cairo_surface_t to be added to the cache.
+ * @scope: An arbitrary scope if desired.  NULL indicates the default scope.
+ * @theme_name: An #GtkIconTheme name.  NULL indicates this is not a surface was not loaded from a Gtk Icon theme.
+ * @icon_name: The name assigned to the surface.  In the case of a theme icon this should be the icon name.
+ * @width: Width the surface was requested at, or -1.
+ * @height: Height the surface was requested at, or -1.
+ *
+ * Inserts a reference to the surface into the cache. Replaces any surface
+ * already stored for the same key.  Surfaces count towards the
+ * max_cache_size property and are pruned together with the pixbufs.
+ */
+
+void
+awn_pixbuf_cache_insert_surface(AwnPixbufCache* pixbuf_cache,
+                                cairo_surface_t* surface,
+                                const gchar* scope,
+                                const gchar* theme_name,
+                                const gchar* icon_name,
+                                gint width,
+                                gint height)
+{
+    gchar* key;
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+
+    g_return_if_fail(surface);
+
+    key = g_strdup_printf("%s::%s::%s::%dx%d",
+                          scope ? scope : "__NONE__",
+                          theme_name ? theme_name : "__NONE__",
+                          icon_name,
+                          width,
+                          height);
+    awn_pixbuf_cache_replace(pixbuf_cache, priv->surfaces, key,
+                             cairo_surface_reference(surface));
+    awn_pixbuf_cache_check(pixbuf_cache, surface);
+}
+
+/**
+ * awn_pixbuf_cache_lookup_surface:
+ * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
+ * @scope: An arbitrary scope if desired.  NULL indicates the default scope.
+ * @theme_name: An #GtkIconTheme name.  NULL indicates this is not a surface was not loaded from a Gtk Icon theme.
+ * @icon_name: The name assigned to the surface.
+ * @width: Width the surface was requested at, or -1.
+ * @height: Height the surface was requested at, or -1.
+ *
+ * Attempts to lookup a surface previously stored with
+ * awn_pixbuf_cache_insert_surface().
+ * Returns: a new reference to the matching surface or NULL.
+ */
+
+cairo_surface_t*
+awn_pixbuf_cache_lookup_surface(AwnPixbufCache* pixbuf_cache,
+                                const gchar* scope,
+                                const gchar* theme_name,
+                                const gchar* icon_name,
+                                gint width,
+                                gint height)
+{
+    cairo_surface_t* surface;
+    gchar* key = g_strdup_printf("%s::%s::%s::%dx%d",
+                                 scope ? scope : "__NONE__",
+                                 theme_name ? theme_name : "__NONE__",
+                                 icon_name,
+                                 width,
+                                 height);
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+
+    surface = g_hash_table_lookup(priv->surfaces, key);
+    AWN_STATS_COUNT(surface ? AWN_STATS_PIXBUF_CACHE_HIT :
+                    AWN_STATS_PIXBUF_CACHE_MISS);
+    g_free(key);
+
+    if (surface == NULL) {
+        return NULL;
+    }
+    awn_pixbuf_cache_touch(pixbuf_cache, surface);
+    return cairo_surface_reference(surface);
+}
+
+/**
+ * awn_pixbuf_cache_get_generation:
+ * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
+ *
+ * Returns a counter incremented every time the cache is invalidated.  Objects
+ * holding on to cached pixbufs or surfaces can compare it to the value seen
+ * when they got them to find out if they are stale.
+ * Returns: the current generation of the cache.
+ */
+
+guint
+awn_pixbuf_cache_get_generation(AwnPixbufCache* pixbuf_cache)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+
+    return priv->generation;
+}
@@ -26,6 +26,7 @@
 
 #include <glib-object.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,6 +87,22 @@ void awn_pixbuf_cache_insert_pixbuf_simple_key(AwnPixbufCache* pixbuf_cache,
         GdkPixbuf* pbuf,
         const gchar* simple_key);
 
+void awn_pixbuf_cache_insert_surface(AwnPixbufCache* pixbuf_cache,
+                                     cairo_surface_t* surface,
+                                     const gchar* scope,
+                                     const gchar* theme_name,
+                                     const gchar* icon_name,
+                                     gint width,
+                                     gint height);
+
+cairo_surface_t* awn_pixbuf_cache_lookup_surface(AwnPixbufCache* pixbuf_cache,
+        const gchar* scope,
+        const gchar* theme_name,
+        const gchar* icon_name,
+        gint width,
+        gint height);
+
+guint awn_pixbuf_cache_get_generation(AwnPixbufCache* pixbuf_cache);
 
 GType awn_pixbuf_cache_get_type(void);
 
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <dbus/dbus-glib.h>
+
+#include "awn-dbus-watcher.h"
+#include "awn-stats.h"
+
+/*
+ * Process-wide rendering statistics.
+ *
+ * Every process using libawn (the panel and each applet) keeps one table of
+ * counters, exported with dbus-glib at AWN_STATS_DBUS_PATH on the
+ * connection the process already has - the panel's object is reachable as
+ * AWN_STATS_DBUS_PANEL_NAME, applets register their unique names with it
+ * (RegisterProcess), so a client finds all of them with ListProcesses.
+ * Only the counters of the process itself are served, summing them up is
+ * left to the client (awn-stats does), as the panel would otherwise have
+ * to block on every applet. Collection is off until either AWN_STATS is
+ * set in the environment or a client calls SetEnabled.
+ */
+
+typedef struct {
+    guint64 count;
+    guint64 total_us;
+    guint64 max_us;
+} AwnStatsEntry;
+
+gboolean awn_stats_enabled = FALSE;
+
+static AwnStatsEntry stats[AWN_STATS_LAST];
+
+static const gchar* stats_names[AWN_STATS_LAST] = {
+    "panel-expose",
+    "panel-masks",
+    "background-draw",
+    "effects-paint",
+    "effects-animation-frame",
+    "pixbuf-cache-hit",
+    "pixbuf-cache-miss",
+    "surface-pool-hit",
+    "surface-pool-miss",
+    "background-geometry",
+    "background-tile-render",
+    "background-tile-blit",
+    "effects-quality-down",
+    "effects-quality-up",
+    "decoration-cache-hit",
+    "decoration-cache-miss",
+    "dialog-chrome-render",
+    "dialog-chrome-blit",
+    "dialog-masks",
+    "tooltip-background-render",
+    "tooltip-masks",
+    "tooltip-layout-cache-hit",
+    "tooltip-layout-cache-miss"
+};
+
+static gchar* stats_process_name = NULL;
+
+/* the D-Bus face of the table */
+typedef struct {
+    GObject parent;
+} AwnStatsService;
+
+typedef struct {
+    GObjectClass parent_class;
+} AwnStatsServiceClass;
+
+static GType awn_stats_service_get_type(void);
+
+G_DEFINE_TYPE(AwnStatsService, awn_stats_service, G_TYPE_OBJECT)
+
+/* unique names of the registered applets, only used by the panel */
+static GHashTable* stats_processes = NULL;
+
+static gboolean awn_stats_service_get_statistics(AwnStatsService* service,
+        gchar** process, gboolean* enabled, GPtrArray** counters,
+        GError** error);
+static gboolean awn_stats_service_set_enabled(AwnStatsService* service,
+        gboolean enabled, GError** error);
+static gboolean awn_stats_service_reset(AwnStatsService* service,
+                                        GError** error);
+static gboolean awn_stats_service_register_process(AwnStatsService* service,
+        DBusGMethodInvocation* context);
+static gboolean awn_stats_service_list_processes(AwnStatsService* service,
+        gchar*** names, GError** error);
+
+#include "awn-stats-glue.h"
+
+static void
+awn_stats_service_class_init(AwnStatsServiceClass* klass)
+{
+    dbus_g_object_type_install_info(G_TYPE_FROM_CLASS(klass),
+                                    &dbus_glib_awn_stats_service_object_info);
+}
+
+static void
+awn_stats_service_init(AwnStatsService* service)
+{
+}
+
+gint64
+awn_stats_now(void)
+{
+#if GLIB_CHECK_VERSION(2, 28, 0)
+    return g_get_monotonic_time();
+#else
+    GTimeVal now;
+
+    g_get_current_time(&now);
+    return (gint64)now.tv_sec * G_USEC_PER_SEC + now.tv_usec;
+#endif
+}
+
+void
+awn_stats_add(AwnStatsCounter counter, gint64 elapsed_us)
+{
+    AwnStatsEntry* entry;
+
+    g_return_if_fail(counter < AWN_STATS_LAST);
+
+    entry = &stats[counter];
+    entry->count++;
+
+    if (elapsed_us > 0) {
+        entry->total_us += elapsed_us;
+        if ((guint64)elapsed_us > entry->max_us) {
+            entry->max_us = elapsed_us;
+        }
+    }
+}
+
+void
+awn_stats_set_enabled(gboolean enabled)
+{
+    awn_stats_enabled = enabled;
+}
+
+void
+awn_stats_reset(void)
+{
+    memset(stats, 0, sizeof(stats));
+}
+
+guint64
+awn_stats_get_count(AwnStatsCounter counter)
+{
+    g_return_val_if_fail(counter < AWN_STATS_LAST, 0);
+
+    return stats[counter].count;
+}
+
+static gboolean
+awn_stats_service_get_statistics(AwnStatsService* service, gchar** process,
+                                 gboolean* enabled, GPtrArray** counters,
+                                 GError** error)
+{
+    GType entry_type;
+    gint i;
+
+    entry_type = dbus_g_type_get_struct("GValueArray", G_TYPE_STRING,
+                                        G_TYPE_UINT64, G_TYPE_UINT64,
+                                        G_TYPE_UINT64, G_TYPE_INVALID);
+
+    *process = g_strdup(stats_process_name ? stats_process_name : "");
+    *enabled = awn_stats_enabled;
+    *counters = g_ptr_array_sized_new(AWN_STATS_LAST);
+
+    for (i = 0; i < AWN_STATS_LAST; i++) {
+        GValue entry = {0};
+
+        g_value_init(&entry, entry_type);
+        g_value_take_boxed(&entry,
+                           dbus_g_type_specialized_construct(entry_type));
+        dbus_g_type_struct_set(&entry,
+                               0, stats_names[i],
+                               1, stats[i].count,
+                               2, stats[i].total_us,
+                               3, stats[i].max_us,
+                               G_MAXUINT);
+        // the array owns the entry now, dbus-glib frees both after replying
+        g_ptr_array_add(*counters, g_value_get_boxed(&entry));
+    }
+
+    return TRUE;
+}
+
+static gboolean
+awn_stats_service_set_enabled(AwnStatsService* service, gboolean enabled,
+                              GError** error)
+{
+    awn_stats_set_enabled(enabled);
+    return TRUE;
+}
+
+static gboolean
+awn_stats_service_reset(AwnStatsService* service, GError** error)
+{
+    awn_stats_reset();
+    return TRUE;
+}
+
+static void
+awn_stats_process_vanished(AwnDBusWatcher* watcher, const gchar* name,
+                           gpointer data)
+{
+    if (g_hash_table_remove(stats_processes, name)) {
+        awn_dbus_watcher_unwatch_name(watcher, name);
+    }
+}
+
+static gboolean
+awn_stats_service_register_process(AwnStatsService* service,
+                                   DBusGMethodInvocation* context)
+{
+    gchar* sender = dbus_g_method_get_sender(context);
+    AwnDBusWatcher* watcher = awn_dbus_watcher_get_default();
+
+    if (stats_processes == NULL) {
+        stats_processes = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                g_free, NULL);
+        g_signal_connect(watcher, "name-disappeared",
+                         G_CALLBACK(awn_stats_process_vanished), NULL);
+    }
+
+    if (!g_hash_table_lookup_extended(stats_processes, sender, NULL, NULL)) {
+        awn_dbus_watcher_watch_name(watcher, sender);
+        g_hash_table_insert(stats_processes, sender, NULL);
+    } else {
+        g_free(sender);
+    }
+
+    dbus_g_method_return(context);
+    return TRUE;
+}
+
+static gboolean
+awn_stats_service_list_processes(AwnStatsService* service, gchar*** names,
+                                 GError** error)
+{
+    GHashTableIter iter;
+    gpointer name;
+    guint i = 0;
+
+    *names = g_new0(gchar*, stats_processes ?
+                    g_hash_table_size(stats_processes) + 1 : 1);
+
+    if (stats_processes) {
+        g_hash_table_iter_init(&iter, stats_processes);
+        while (g_hash_table_iter_next(&iter, &name, NULL)) {
+            (*names)[i++] = g_strdup((const gchar*)name);
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * awn_stats_export:
+ * @connection: Session bus connection.
+ * @process_name: Human readable name of this process (eg. applet name).
+ *
+ * Exports the statistics of this process on the bus. Only the first call
+ * in a process has any effect.
+ */
+void
+awn_stats_export(DBusGConnection* connection, const gchar* process_name)
+{
+    GObject* service;
+
+    g_return_if_fail(connection != NULL);
+
+    if (stats_process_name) {
+        return;
+    }
+
+    stats_process_name = g_strdup(process_name ? process_name : g_get_prgname());
+
+    if (g_getenv("AWN_STATS")) {
+        awn_stats_set_enabled(TRUE);
+    }
+
+    // lives as long as the process
+    service = G_OBJECT(g_object_new(awn_stats_service_get_type(), NULL));
+    dbus_g_connection_register_g_object(connection, AWN_STATS_DBUS_PATH,
+                                        service);
+}
+
+/**
+ * awn_stats_register_process:
+ * @connection: Session bus connection the statistics were exported on.
+ *
+ * Tells the panel about the statistics of this applet, so they're listed
+ * by its ListProcesses method.
+ */
+void
+awn_stats_register_process(DBusGConnection* connection)
+{
+    DBusGProxy* proxy;
+
+    g_return_if_fail(connection != NULL);
+
+    proxy = dbus_g_proxy_new_for_name(connection, AWN_STATS_DBUS_PANEL_NAME,
+                                      AWN_STATS_DBUS_PATH,
+                                      AWN_STATS_DBUS_INTERFACE);
+    dbus_g_proxy_call_no_reply(proxy, "RegisterProcess", G_TYPE_INVALID);
+    g_object_unref(proxy);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Private header - rendering statistics shared by libawn and the panel. */
+
+#ifndef __AWN_STATS_H__
+#define __AWN_STATS_H__
+
+#include <glib.h>
+#include <dbus/dbus-glib.h>
+
+#define AWN_STATS_DBUS_PANEL_NAME "org.awnproject.Awn"
+#define AWN_STATS_DBUS_PATH "/org/awnproject/Awn/Statistics"
+#define AWN_STATS_DBUS_INTERFACE "org.awnproject.Awn.Statistics"
+
+typedef enum {
+    AWN_STATS_PANEL_EXPOSE = 0,
+    AWN_STATS_PANEL_MASKS,
+    AWN_STATS_BACKGROUND_DRAW,
+    AWN_STATS_EFFECTS_PAINT,
+    AWN_STATS_EFFECTS_ANIMATION_FRAME,
+    AWN_STATS_PIXBUF_CACHE_HIT,
+    AWN_STATS_PIXBUF_CACHE_MISS,
+    AWN_STATS_SURFACE_POOL_HIT,
+    AWN_STATS_SURFACE_POOL_MISS,
+    AWN_STATS_BACKGROUND_GEOMETRY,
+    AWN_STATS_BACKGROUND_TILE_RENDER,
+    AWN_STATS_BACKGROUND_TILE_BLIT,
+    AWN_STATS_EFFECTS_QUALITY_DOWN,
+    AWN_STATS_EFFECTS_QUALITY_UP,
+    AWN_STATS_DECORATION_CACHE_HIT,
+    AWN_STATS_DECORATION_CACHE_MISS,
+    AWN_STATS_DIALOG_CHROME_RENDER,
+    AWN_STATS_DIALOG_CHROME_BLIT,
+    AWN_STATS_DIALOG_MASKS,
+    AWN_STATS_TOOLTIP_BACKGROUND_RENDER,
+    AWN_STATS_TOOLTIP_MASKS,
+    AWN_STATS_TOOLTIP_LAYOUT_CACHE_HIT,
+    AWN_STATS_TOOLTIP_LAYOUT_CACHE_MISS,
+
+    AWN_STATS_LAST
+} AwnStatsCounter;
+
+/* Read directly by the macros below, so a disabled site costs one branch. */
+extern gboolean awn_stats_enabled;
+
+#define AWN_STATS_COUNT(counter) \
+    G_STMT_START { \
+        if (G_UNLIKELY(awn_stats_enabled)) awn_stats_add(counter, 0); \
+    } G_STMT_END
+
+/*
+ * Times @call into @counter. @call is expanded on both sides of the one
+ * branch, so it should be a single function call; every return path of
+ * that function is timed.
+ */
+#define AWN_STATS_TIME(counter, call) \
+    G_STMT_START { \
+        if (G_UNLIKELY(awn_stats_enabled)) { \
+            gint64 awn_stats_start_ = awn_stats_now(); \
+            call; \
+            awn_stats_add(counter, awn_stats_now() - awn_stats_start_); \
+        } else { \
+            call; \
+        } \
+    } G_STMT_END
+
+/*
+ * For spans which start and end in different functions. @start is a gint64
+ * which stays zero while the statistics are disabled.
+ */
+#define AWN_STATS_TIMER_START(start) \
+    G_STMT_START { \
+        (start) = G_UNLIKELY(awn_stats_enabled) ? awn_stats_now() : 0; \
+    } G_STMT_END
+
+#define AWN_STATS_TIMER_STOP(counter, start) \
+    G_STMT_START { \
+        if (G_UNLIKELY(start)) { \
+            awn_stats_add(counter, awn_stats_now() - (start)); \
+            (start) = 0; \
+        } \
+    } G_STMT_END
+
+gint64 awn_stats_now(void);
+
+void awn_stats_add(AwnStatsCounter counter, gint64 elapsed_us);
+
+void awn_stats_set_enabled(gboolean enabled);
+
+void awn_stats_reset(void);
+
+guint64 awn_stats_get_count(AwnStatsCounter counter);
+
+void awn_stats_export(DBusGConnection* connection, const gchar* process_name);
+
+void awn_stats_register_process(DBusGConnection* connection);
+
+#endif /* __AWN_STATS_H__ */
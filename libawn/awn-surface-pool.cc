@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-surface-pool.c */
+
+#include <cairo/cairo-xlib.h>
+
+#include "awn-surface-pool.h"
+#include "awn-stats.h"
+
+/*
+ * With xlib surfaces every scratch surface is a pixmap created and freed on
+ * the X server, so instead of destroying them we keep the last few returned
+ * ones around. Surfaces are only compatible if they were created the same
+ * way, hence the key - backend, X screen, content and size.
+ */
+
+/* maximum number of surfaces kept in the pool */
+#define POOL_MAX_IDLE 16
+/* idle surfaces are freed after this long (seconds) */
+#define POOL_IDLE_TIMEOUT 10
+#define POOL_TRIM_INTERVAL 5
+
+typedef struct {
+    cairo_surface_type_t type;
+    gpointer screen;
+    cairo_content_t content;
+    gint width;
+    gint height;
+} AwnSurfacePoolKey;
+
+typedef struct {
+    cairo_surface_t* surface;
+    gint64 idle_since;
+} AwnSurfacePoolEntry;
+
+static const cairo_user_data_key_t pool_key_quark = { 0 };
+
+/* idle entries, the most recently returned first */
+static GQueue pool_idle = G_QUEUE_INIT;
+static guint pool_trim_id = 0;
+static AwnSurfacePoolCounters pool_counters = { 0, 0, 0, 0 };
+
+static gboolean
+awn_surface_pool_key_equal(const AwnSurfacePoolKey* a,
+                           const AwnSurfacePoolKey* b)
+{
+    return a->type == b->type && a->screen == b->screen &&
+           a->content == b->content &&
+           a->width == b->width && a->height == b->height;
+}
+
+static void
+awn_surface_pool_entry_free(AwnSurfacePoolEntry* entry)
+{
+    cairo_surface_destroy(entry->surface);
+    g_slice_free(AwnSurfacePoolEntry, entry);
+    pool_counters.idle--;
+}
+
+static gboolean
+awn_surface_pool_trim_cb(gpointer data)
+{
+    gint64 now = awn_stats_now();
+    AwnSurfacePoolEntry* entry;
+
+    /* the oldest entries are at the tail */
+    while ((entry = (AwnSurfacePoolEntry*)g_queue_peek_tail(&pool_idle)) &&
+            now - entry->idle_since >= POOL_IDLE_TIMEOUT * G_USEC_PER_SEC) {
+        g_queue_pop_tail(&pool_idle);
+        awn_surface_pool_entry_free(entry);
+    }
+
+    if (g_queue_is_empty(&pool_idle)) {
+        pool_trim_id = 0;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_surface_t*
+awn_surface_pool_get(const AwnSurfacePoolKey* key, cairo_surface_t* like)
+{
+    cairo_surface_t* surface;
+    GList* iter;
+
+    for (iter = pool_idle.head; iter != NULL; iter = iter->next) {
+        AwnSurfacePoolEntry* entry = (AwnSurfacePoolEntry*)iter->data;
+        AwnSurfacePoolKey* entry_key;
+
+        entry_key = (AwnSurfacePoolKey*)cairo_surface_get_user_data(
+                        entry->surface, &pool_key_quark);
+        if (awn_surface_pool_key_equal(entry_key, key)) {
+            surface = entry->surface;
+            g_queue_delete_link(&pool_idle, iter);
+            g_slice_free(AwnSurfacePoolEntry, entry);
+
+            pool_counters.idle--;
+            pool_counters.reused++;
+            pool_counters.outstanding++;
+            AWN_STATS_COUNT(AWN_STATS_SURFACE_POOL_HIT);
+
+            return surface;
+        }
+    }
+
+    if (like) {
+        surface = cairo_surface_create_similar(like, key->content,
+                                               key->width, key->height);
+    } else {
+        cairo_format_t format = key->content == CAIRO_CONTENT_ALPHA ?
+                                CAIRO_FORMAT_A8 :
+                                key->content == CAIRO_CONTENT_COLOR ?
+                                CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32;
+        surface = cairo_image_surface_create(format, key->width, key->height);
+    }
+
+    cairo_surface_set_user_data(surface, &pool_key_quark,
+                                g_memdup(key, sizeof(AwnSurfacePoolKey)),
+                                g_free);
+
+    pool_counters.allocated++;
+    pool_counters.outstanding++;
+    AWN_STATS_COUNT(AWN_STATS_SURFACE_POOL_MISS);
+
+    return surface;
+}
+
+/**
+ * awn_surface_pool_borrow:
+ * @like: Surface the borrowed one should be similar to.
+ * @content: Content of the surface.
+ * @width: Width of the surface.
+ * @height: Height of the surface.
+ *
+ * Borrows a surface which works like one returned by
+ * cairo_surface_create_similar(), except that its contents are undefined.
+ * It has to be given back with awn_surface_pool_return() (after destroying
+ * all contexts drawing on it) before the current frame is finished.
+ *
+ * Returns: The borrowed surface.
+ */
+cairo_surface_t*
+awn_surface_pool_borrow(cairo_surface_t* like, cairo_content_t content,
+                        gint width, gint height)
+{
+    AwnSurfacePoolKey key;
+
+    g_return_val_if_fail(like != NULL, NULL);
+
+    key.type = cairo_surface_get_type(like);
+    key.screen = key.type == CAIRO_SURFACE_TYPE_XLIB ?
+                 (gpointer)cairo_xlib_surface_get_screen(like) : NULL;
+    key.content = content;
+    key.width = width;
+    key.height = height;
+
+    /* similar surfaces of an image surface are image surfaces */
+    return awn_surface_pool_get(&key,
+                                key.type == CAIRO_SURFACE_TYPE_IMAGE ?
+                                NULL : like);
+}
+
+/**
+ * awn_surface_pool_borrow_image:
+ * @width: Width of the surface.
+ * @height: Height of the surface.
+ *
+ * Borrows an ARGB32 image surface, see awn_surface_pool_borrow().
+ *
+ * Returns: The borrowed surface.
+ */
+cairo_surface_t*
+awn_surface_pool_borrow_image(gint width, gint height)
+{
+    AwnSurfacePoolKey key;
+
+    key.type = CAIRO_SURFACE_TYPE_IMAGE;
+    key.screen = NULL;
+    key.content = CAIRO_CONTENT_COLOR_ALPHA;
+    key.width = width;
+    key.height = height;
+
+    return awn_surface_pool_get(&key, NULL);
+}
+
+/**
+ * awn_surface_pool_return:
+ * @surface: Surface obtained from awn_surface_pool_borrow().
+ *
+ * Gives the surface back to the pool.
+ */
+void
+awn_surface_pool_return(cairo_surface_t* surface)
+{
+    AwnSurfacePoolEntry* entry;
+
+    g_return_if_fail(surface != NULL);
+    g_return_if_fail(cairo_surface_get_user_data(surface,
+                     &pool_key_quark) != NULL);
+
+    pool_counters.outstanding--;
+
+    entry = g_slice_new(AwnSurfacePoolEntry);
+    entry->surface = surface;
+    entry->idle_since = awn_stats_now();
+    g_queue_push_head(&pool_idle, entry);
+    pool_counters.idle++;
+
+    if (pool_counters.idle > POOL_MAX_IDLE) {
+        awn_surface_pool_entry_free(
+            (AwnSurfacePoolEntry*)g_queue_pop_tail(&pool_idle));
+    }
+
+    if (pool_trim_id == 0) {
+        pool_trim_id = g_timeout_add_seconds(POOL_TRIM_INTERVAL,
+                                             awn_surface_pool_trim_cb, NULL);
+    }
+}
+
+/**
+ * awn_surface_pool_trim:
+ *
+ * Frees all idle surfaces.
+ */
+void
+awn_surface_pool_trim(void)
+{
+    AwnSurfacePoolEntry* entry;
+
+    while ((entry = (AwnSurfacePoolEntry*)g_queue_pop_head(&pool_idle))) {
+        awn_surface_pool_entry_free(entry);
+    }
+
+    if (pool_trim_id) {
+        g_source_remove(pool_trim_id);
+        pool_trim_id = 0;
+    }
+}
+
+void
+awn_surface_pool_get_counters(AwnSurfacePoolCounters* counters)
+{
+    g_return_if_fail(counters != NULL);
+
+    *counters = pool_counters;
+}
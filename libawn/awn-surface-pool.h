@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-surface-pool.h
+ *
+ * Private helper - process-wide pool of scratch surfaces used while
+ * painting a single frame. A surface is borrowed, used and returned before
+ * the expose handler finishes; returned surfaces are handed out again to
+ * the next borrower asking for the same size, content and backend, and are
+ * freed after they weren't needed for a while.
+ */
+
+#ifndef _AWN_SURFACE_POOL_H
+#define _AWN_SURFACE_POOL_H
+
+#include <glib.h>
+#include <cairo.h>
+
+typedef struct {
+    guint allocated;   /* surfaces created by the pool */
+    guint reused;      /* borrows served by an idle surface */
+    guint outstanding; /* surfaces borrowed and not returned yet */
+    guint idle;        /* surfaces waiting in the pool */
+} AwnSurfacePoolCounters;
+
+/* The contents of a borrowed surface are undefined. */
+cairo_surface_t*
+awn_surface_pool_borrow(cairo_surface_t* like, cairo_content_t content,
+                        gint width, gint height);
+
+cairo_surface_t*
+awn_surface_pool_borrow_image(gint width, gint height);
+
+void
+awn_surface_pool_return(cairo_surface_t* surface);
+
+void
+awn_surface_pool_trim(void);
+
+void
+awn_surface_pool_get_counters(AwnSurfacePoolCounters* counters);
+
+#endif
@@ -38,6 +38,7 @@
 #include <libdesktop-agnostic/vfs.h>
 
 #include "awn-themed-icon.h"
+#include "awn-icon-private.h"
 #include "libawn.h"
 
 #include "gseal-transition.h"
@@ -149,6 +150,11 @@ struct _AwnThemedIconPrivate {
     AwnPixbufCache* pixbufs;    /*our pixbuf cache*/
     int  cache_sentinel;
 
+    /*state -> AwnThemedIconSurface at current_size, so state switches
+     are just a lookup*/
+    GHashTable* surfaces;
+    guint       surfaces_generation;
+
     /*used in management of "Remove Custom Icon" menu items */
     gboolean    awn_theme_hit;
     GtkWidget* remove_custom_icon_item;
@@ -163,6 +169,12 @@ typedef struct {
     guint         id;
 } AwnThemedIconPreloadItem;
 
+typedef struct {
+    cairo_surface_t* surface;
+    gchar*           custom_icon_name;
+    gboolean         awn_theme_hit;
+} AwnThemedIconSurface;
+
 enum {
     SCOPE_UID = 0,
     SCOPE_APPLET,
@@ -197,6 +209,12 @@ static gboolean on_idle_preload(gpointer item);
 
 static void ensure_icon(AwnThemedIcon* icon);
 
+static void update_custom_icon_item(AwnThemedIcon* icon);
+
+static void awn_themed_icon_surface_free(AwnThemedIconSurface* entry);
+
+static void awn_themed_icon_clear_surfaces(AwnThemedIcon* icon);
+
 static void awn_themed_icon_preload_all(AwnThemedIcon* icon);
 
 static GtkIconTheme* get_awn_theme(void);
@@ -343,6 +361,7 @@ awn_themed_icon_invalidate_pixbuf_cache(AwnThemedIcon* icon)
     if (priv->pixbufs) {
         awn_pixbuf_cache_invalidate(priv->pixbufs);
     }
+    awn_themed_icon_clear_surfaces(icon);
 }
 
 
@@ -382,6 +401,7 @@ awn_themed_icon_set_property(GObject* object, guint property_id,
     switch (property_id) {
     case PROP_ROTATE:
         priv->rotate = g_value_get_enum(value);
+        awn_themed_icon_clear_surfaces(AWN_THEMED_ICON(object));
         ensure_icon(AWN_THEMED_ICON(object));
         break;
     case PROP_APPLET_NAME:
@@ -461,6 +481,7 @@ awn_themed_icon_finalize(GObject* object)
     if (priv->preload_list) {
         g_list_free(priv->preload_list);
     }
+    g_hash_table_destroy(priv->surfaces);
     G_OBJECT_CLASS(awn_themed_icon_parent_class)->finalize(object);
 }
 
@@ -605,6 +626,9 @@ awn_themed_icon_init(AwnThemedIcon* icon)
     priv->preload_list = NULL;
     priv->pixbufs = awn_pixbuf_cache_get_default();
     priv->cache_sentinel = 0;
+    priv->surfaces = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                           (GDestroyNotify)awn_themed_icon_surface_free);
+    priv->surfaces_generation = awn_pixbuf_cache_get_generation(priv->pixbufs);
 
     /* Set-up the gtk-theme */
     priv->gtk_theme = gtk_icon_theme_get_default();
@@ -869,12 +893,7 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
 
                 /* Check if we got a valid pixbuf on this run */
                 if (pixbuf) {
-                    /* FIXME: Should we make this position-aware? */
-                    if (priv->awn_theme_hit && priv->remove_custom_icon_item) {
-                        gtk_widget_show(priv->remove_custom_icon_item);
-                    } else if (priv->remove_custom_icon_item) {
-                        gtk_widget_hide(priv->remove_custom_icon_item);
-                    }
+                    update_custom_icon_item(icon);
 
                     if (gdk_pixbuf_get_height(pixbuf) > size) {
                         GdkPixbuf* temp = pixbuf;
@@ -903,6 +922,126 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
 }
 
 
+static void
+update_custom_icon_item(AwnThemedIcon* icon)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+
+    /* FIXME: Should we make this position-aware? */
+    if (priv->awn_theme_hit && priv->remove_custom_icon_item) {
+        gtk_widget_show(priv->remove_custom_icon_item);
+    } else if (priv->remove_custom_icon_item) {
+        gtk_widget_hide(priv->remove_custom_icon_item);
+    }
+}
+
+/*
+ * Returns the premultiplied surface for a state.  Surfaces for the current
+ * size are kept per state, so switching between already shown states only
+ * swaps pointers.  Converted surfaces are also shared with other icons
+ * through the pixbuf cache.
+ */
+static cairo_surface_t*
+get_surface_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
+{
+    AwnThemedIconPrivate* priv;
+    AwnThemedIconSurface* entry;
+    AwnThemedIconItem*    item = NULL;
+    cairo_surface_t*      surface;
+    GdkPixbuf*            pixbuf;
+    GList*                iter;
+    gchar*                key;
+    guint                 generation;
+
+    priv = icon->priv;
+    g_return_val_if_fail(state, NULL);
+
+    /* somebody invalidated the shared cache (theme change, custom icon...) */
+    generation = awn_pixbuf_cache_get_generation(priv->pixbufs);
+    if (generation != priv->surfaces_generation) {
+        awn_themed_icon_clear_surfaces(icon);
+        priv->surfaces_generation = generation;
+    }
+
+    if (size == priv->current_size) {
+        entry = g_hash_table_lookup(priv->surfaces, state);
+        if (entry) {
+            if (g_strcmp0(priv->custom_icon_name, entry->custom_icon_name) != 0) {
+                g_free(priv->custom_icon_name);
+                priv->custom_icon_name = g_strdup(entry->custom_icon_name);
+            }
+            priv->awn_theme_hit = entry->awn_theme_hit;
+            update_custom_icon_item(icon);
+            return cairo_surface_reference(entry->surface);
+        }
+    }
+
+    for (iter = priv->list; iter; iter = g_list_next(iter)) {
+        if (g_strcmp0(((AwnThemedIconItem*)iter->data)->state, state) == 0) {
+            item = iter->data;
+            break;
+        }
+    }
+    g_return_val_if_fail(item, NULL);
+
+    pixbuf = get_pixbuf_at_size(icon, size, state);
+    g_return_val_if_fail(pixbuf, NULL);
+
+    /* identifies what get_pixbuf_at_size() resolved the state to */
+    key = g_strdup_printf("%s::%s::%s::%s::%d",
+                          priv->custom_icon_name ? priv->custom_icon_name : item->name,
+                          priv->applet_name ? priv->applet_name : "__NONE__",
+                          priv->override_theme ?
+                          priv->override_theme->priv->current_theme : "__NONE__",
+                          priv->awn_theme_hit ? "awn" : "gtk",
+                          priv->rotate);
+    surface = awn_pixbuf_cache_lookup_surface(priv->pixbufs, "awn-themed-icon",
+              priv->gtk_theme->priv->current_theme,
+              key, -1, size);
+    if (!surface) {
+        if (priv->rotate) {
+            GdkPixbuf* rotated;
+            rotated = gdk_pixbuf_rotate_simple(pixbuf, priv->rotate);
+            g_object_unref(pixbuf);
+            pixbuf = rotated;
+        }
+        surface = awn_cairo_image_surface_new_from_pixbuf(pixbuf);
+        awn_pixbuf_cache_insert_surface(priv->pixbufs, surface, "awn-themed-icon",
+                                        priv->gtk_theme->priv->current_theme,
+                                        key, -1, size);
+    }
+    g_object_unref(pixbuf);
+    g_free(key);
+
+    if (size == priv->current_size) {
+        entry = g_new0(AwnThemedIconSurface, 1);
+        entry->surface = cairo_surface_reference(surface);
+        entry->custom_icon_name = g_strdup(priv->custom_icon_name);
+        entry->awn_theme_hit = priv->awn_theme_hit;
+        g_hash_table_replace(priv->surfaces, g_strdup(state), entry);
+    }
+
+    return surface;
+}
+
+static void
+awn_themed_icon_surface_free(AwnThemedIconSurface* entry)
+{
+    cairo_surface_destroy(entry->surface);
+    g_free(entry->custom_icon_name);
+    g_free(entry);
+}
+
+static void
+awn_themed_icon_clear_surfaces(AwnThemedIcon* icon)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+
+    if (priv->surfaces) {
+        g_hash_table_remove_all(priv->surfaces);
+    }
+}
+
 /*
  * Main function to ensure the icon
  */
@@ -910,7 +1049,7 @@ static void
 ensure_icon(AwnThemedIcon* icon)
 {
     AwnThemedIconPrivate* priv;
-    GdkPixbuf*            pixbuf;
+    cairo_surface_t*      surface;
 
     priv = icon->priv;
 
@@ -919,17 +1058,17 @@ ensure_icon(AwnThemedIcon* icon)
         return;
     }
     /* Get the icon first */
-    pixbuf = get_pixbuf_at_size(icon, priv->current_size, priv->current_item->state);
-
-    if (priv->rotate) {
-        GdkPixbuf* rotated;
-        rotated = gdk_pixbuf_rotate_simple(pixbuf, priv->rotate);
-        g_object_unref(pixbuf);
-        pixbuf = rotated;
+    surface = get_surface_at_size(icon, priv->current_size,
+                                  priv->current_item->state);
+    if (!surface) {
+        return;
     }
-    awn_icon_set_from_pixbuf(AWN_ICON(icon), pixbuf);
 
-    g_object_unref(pixbuf);
+    /* AwnIcon only references the surface, no copy is made, the cached
+     * surfaces are never drawn into */
+    awn_icon_set_from_static_surface(AWN_ICON(icon), surface);
+
+    cairo_surface_destroy(surface);
 }
 
 /*
@@ -1020,6 +1159,7 @@ awn_themed_icon_set_size(AwnThemedIcon* icon,
         if (priv->current_size > 0) {
             awn_themed_icon_invalidate_pixbuf_cache(icon);
         }
+        awn_themed_icon_clear_surfaces(icon);
         priv->current_size = size;
         ensure_icon(icon);
         awn_themed_icon_preload_all(icon);
@@ -1093,6 +1233,7 @@ awn_themed_icon_set_info(AwnThemedIcon*  icon,
     g_return_if_fail(states);
     g_return_if_fail(icon_names);
     priv = icon->priv;
+    awn_themed_icon_clear_surfaces(icon);
     /*clear out the non-sticky*/
     for (iter = priv->list; iter; iter = g_list_next(iter)) {
         AwnThemedIconItem* item = iter->data;
@@ -1265,6 +1406,8 @@ awn_themed_icon_set_info_append(AwnThemedIcon*  icon,
         priv->uid = g_strdup("__invisible__");
     }
 
+    awn_themed_icon_clear_surfaces(icon);
+
     item = g_malloc(sizeof(AwnThemedIconItem));
 
     item->original_name = g_strdup(icon_name);
@@ -1343,6 +1486,7 @@ awn_themed_icon_override_gtk_theme(AwnThemedIcon* icon,
         g_object_unref(priv->override_theme);
         awn_themed_icon_invalidate_pixbuf_cache(icon);
     }
+    awn_themed_icon_clear_surfaces(icon);
 
     if (theme_name && strlen(theme_name)) {
         priv->override_theme = gtk_icon_theme_new();
@@ -1520,6 +1664,7 @@ awn_themed_icon_clear_info(AwnThemedIcon* icon)
 
     /* Free the old states & icon_names */
     priv->current_item = NULL;
+    awn_themed_icon_clear_surfaces(icon);
 
     for (iter = priv->list; iter; iter = g_list_next(iter)) {
         AwnThemedIconItem* item = iter->data;
@@ -1607,6 +1752,7 @@ on_idle_preload(gpointer data)
 {
     AwnThemedIconPreloadItem* item = data;
     GdkPixbuf* pixbuf;
+    cairo_surface_t* surface;
     AwnThemedIconPrivate* priv;
     g_return_val_if_fail(item, FALSE);
     priv = item->icon->priv;
@@ -1616,12 +1762,22 @@ on_idle_preload(gpointer data)
         return FALSE;
     }
 
-    /*CONDITIONAL operator*/
-    pixbuf = get_pixbuf_at_size(item->icon,
-                                item->size > 0 ? item->size : priv->current_size,
-                                item->state);
-
-    g_object_unref(pixbuf);
+    /*icons for the current size are preloaded as ready to use surfaces*/
+    if (item->size <= 0 || item->size == priv->current_size) {
+        surface = NULL;
+        if (priv->current_size > 0) {
+            surface = get_surface_at_size(item->icon, priv->current_size,
+                                          item->state);
+        }
+        if (surface) {
+            cairo_surface_destroy(surface);
+        }
+    } else {
+        pixbuf = get_pixbuf_at_size(item->icon, item->size, item->state);
+        if (pixbuf) {
+            g_object_unref(pixbuf);
+        }
+    }
     priv->preload_list = g_list_remove(priv->preload_list, item);
     g_free(item->state);
     g_free(item);
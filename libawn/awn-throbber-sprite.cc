@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-throbber-sprite.c */
+
+#include <math.h>
+#include <string.h>
+
+#include "awn-throbber-sprite.h"
+
+/*
+ * Sprite strip
+ *
+ * All AWN_THROBBER_SPRITE_FRAMES frames are rendered side by side into one
+ * surface whenever the cell size or the colors change, painting a frame is
+ * then a single clipped blit.
+ */
+
+static void
+awn_throbber_sprite_render_frame(AwnThrobberSprite* sprite,
+                                 cairo_t* cr, gint frame)
+{
+    const gdouble RADIUS = 0.0625;
+    const gdouble DIST = 0.3;
+    const gdouble OTHER = DIST * 0.707106781; /* sqrt(2)/2 */
+    const gint COUNT = AWN_THROBBER_SPRITE_FRAMES;
+    const gdouble pos[AWN_THROBBER_SPRITE_FRAMES][2] = {
+        {0, DIST}, {OTHER, OTHER}, {DIST, 0}, {OTHER, -OTHER},
+        {0, -DIST}, {-OTHER, -OTHER}, {-DIST, 0}, {-OTHER, OTHER}
+    };
+    gint i;
+
+    cairo_save(cr);
+    cairo_translate(cr, frame * sprite->cell_width, 0);
+    cairo_scale(cr, sprite->cell_width, sprite->cell_height);
+    cairo_translate(cr, 0.5, 0.5);
+    cairo_scale(cr, 1, -1);
+    cairo_set_line_width(cr, sprite->line_width);
+
+    for (i = 0; i < COUNT; i++) {
+        gdouble alpha = ((frame + i) % COUNT) / (gdouble)COUNT;
+
+        cairo_arc(cr, pos[i][0], pos[i][1], RADIUS, 0, 2 * M_PI);
+        cairo_set_source_rgba(cr, sprite->fill[0], sprite->fill[1],
+                              sprite->fill[2], sprite->fill[3] * alpha);
+        if (sprite->has_outline) {
+            cairo_fill_preserve(cr);
+            cairo_set_source_rgba(cr, sprite->outline[0], sprite->outline[1],
+                                  sprite->outline[2], sprite->outline[3] * alpha);
+            cairo_stroke(cr);
+        } else {
+            cairo_fill(cr);
+        }
+    }
+
+    cairo_restore(cr);
+}
+
+/*
+ * Makes sure the strip matches the requested cell size and colors,
+ * re-rendering it if it doesn't.  @outline can be NULL for throbbers
+ * without outline.  Returns TRUE if the strip was (re)built.
+ */
+gboolean
+awn_throbber_sprite_ensure(AwnThrobberSprite* sprite,
+                           cairo_t* cr,
+                           gint cell_width, gint cell_height,
+                           const gdouble fill[4],
+                           const gdouble* outline,
+                           gdouble line_width)
+{
+    cairo_t* strip_cr;
+    gint i;
+
+    g_return_val_if_fail(sprite, FALSE);
+
+    if (sprite->strip &&
+            sprite->cell_width == cell_width &&
+            sprite->cell_height == cell_height &&
+            memcmp(sprite->fill, fill, sizeof(sprite->fill)) == 0 &&
+            sprite->has_outline == (outline != NULL) &&
+            (!outline ||
+             memcmp(sprite->outline, outline, sizeof(sprite->outline)) == 0) &&
+            sprite->line_width == line_width) {
+        return FALSE;
+    }
+
+    awn_throbber_sprite_clear(sprite);
+
+    if (cell_width <= 0 || cell_height <= 0) {
+        return FALSE;
+    }
+
+    sprite->cell_width = cell_width;
+    sprite->cell_height = cell_height;
+    memcpy(sprite->fill, fill, sizeof(sprite->fill));
+    sprite->has_outline = outline != NULL;
+    if (outline) {
+        memcpy(sprite->outline, outline, sizeof(sprite->outline));
+    }
+    sprite->line_width = line_width;
+
+    sprite->strip = cairo_surface_create_similar(cairo_get_target(cr),
+                    CAIRO_CONTENT_COLOR_ALPHA,
+                    cell_width * AWN_THROBBER_SPRITE_FRAMES,
+                    cell_height);
+    strip_cr = cairo_create(sprite->strip);
+    cairo_set_operator(strip_cr, CAIRO_OPERATOR_OVER);
+    for (i = 0; i < AWN_THROBBER_SPRITE_FRAMES; i++) {
+        awn_throbber_sprite_render_frame(sprite, strip_cr, i);
+    }
+    cairo_destroy(strip_cr);
+
+    return TRUE;
+}
+
+void
+awn_throbber_sprite_paint(AwnThrobberSprite* sprite,
+                          cairo_t* cr,
+                          gint frame,
+                          gdouble x, gdouble y)
+{
+    g_return_if_fail(sprite);
+
+    if (!sprite->strip) {
+        return;
+    }
+
+    frame %= AWN_THROBBER_SPRITE_FRAMES;
+    x = round(x);
+    y = round(y);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, x, y, sprite->cell_width, sprite->cell_height);
+    cairo_clip(cr);
+    cairo_set_source_surface(cr, sprite->strip,
+                             x - frame * sprite->cell_width, y);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+void
+awn_throbber_sprite_clear(AwnThrobberSprite* sprite)
+{
+    g_return_if_fail(sprite);
+
+    if (sprite->strip) {
+        cairo_surface_destroy(sprite->strip);
+        sprite->strip = NULL;
+    }
+    sprite->cell_width = 0;
+    sprite->cell_height = 0;
+}
+
+/*
+ * Shared tick
+ *
+ * Throbbers asking for the same interval share a single timeout source,
+ * which is removed once the last of them stops.
+ */
+
+typedef struct {
+    guint   interval;
+    guint   source_id;
+    GSList* subscribers;
+} AwnThrobberTick;
+
+typedef struct {
+    guint            id;
+    AwnThrobberTick* tick;
+    GSourceFunc      func;
+    gpointer         data;
+} AwnThrobberTickSubscriber;
+
+static GHashTable* ticks = NULL;       /* interval -> AwnThrobberTick */
+static GHashTable* subscribers = NULL; /* id -> AwnThrobberTickSubscriber */
+static guint       last_tick_id = 0;
+
+static gboolean
+awn_throbber_tick_dispatch(gpointer user_data)
+{
+    AwnThrobberTick* tick = (AwnThrobberTick*)user_data;
+    GSList* ids = NULL;
+    GSList* iter;
+
+    /* callbacks are allowed to remove (any) subscriber, so work on ids */
+    for (iter = tick->subscribers; iter; iter = iter->next) {
+        AwnThrobberTickSubscriber* sub = (AwnThrobberTickSubscriber*)iter->data;
+        ids = g_slist_prepend(ids, GUINT_TO_POINTER(sub->id));
+    }
+
+    for (iter = ids; iter; iter = iter->next) {
+        AwnThrobberTickSubscriber* sub;
+
+        sub = g_hash_table_lookup(subscribers, iter->data);
+        if (sub && !sub->func(sub->data)) {
+            awn_throbber_tick_remove(sub->id);
+        }
+    }
+    g_slist_free(ids);
+
+    /* the last subscriber already removed the source */
+    return g_hash_table_lookup(ticks, GUINT_TO_POINTER(tick->interval)) == tick;
+}
+
+/*
+ * Calls @func every @interval milliseconds until it returns FALSE or
+ * awn_throbber_tick_remove() is called with the returned id.
+ */
+guint
+awn_throbber_tick_add(guint interval, GSourceFunc func, gpointer data)
+{
+    AwnThrobberTick* tick;
+    AwnThrobberTickSubscriber* sub;
+
+    g_return_val_if_fail(func, 0);
+
+    if (!ticks) {
+        ticks = g_hash_table_new(g_direct_hash, g_direct_equal);
+        subscribers = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                            NULL, g_free);
+    }
+
+    tick = g_hash_table_lookup(ticks, GUINT_TO_POINTER(interval));
+    if (!tick) {
+        tick = g_new0(AwnThrobberTick, 1);
+        tick->interval = interval;
+        // we want lower prio than HIGH_IDLE
+        tick->source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, interval,
+                                             awn_throbber_tick_dispatch,
+                                             tick, g_free);
+        g_hash_table_insert(ticks, GUINT_TO_POINTER(interval), tick);
+    }
+
+    sub = g_new0(AwnThrobberTickSubscriber, 1);
+    sub->id = ++last_tick_id;
+    sub->tick = tick;
+    sub->func = func;
+    sub->data = data;
+
+    tick->subscribers = g_slist_prepend(tick->subscribers, sub);
+    g_hash_table_insert(subscribers, GUINT_TO_POINTER(sub->id), sub);
+
+    return sub->id;
+}
+
+void
+awn_throbber_tick_remove(guint tick_id)
+{
+    AwnThrobberTickSubscriber* sub;
+    AwnThrobberTick* tick;
+
+    if (!subscribers) {
+        return;
+    }
+
+    sub = g_hash_table_lookup(subscribers, GUINT_TO_POINTER(tick_id));
+    g_return_if_fail(sub);
+
+    tick = sub->tick;
+    tick->subscribers = g_slist_remove(tick->subscribers, sub);
+    g_hash_table_remove(subscribers, GUINT_TO_POINTER(tick_id));
+
+    if (!tick->subscribers) {
+        g_hash_table_remove(ticks, GUINT_TO_POINTER(tick->interval));
+        /* frees the tick */
+        g_source_remove(tick->source_id);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-throbber-sprite.h
+ *
+ * Private helpers shared by AwnOverlayThrobber and the panel's AwnThrobber:
+ * a pre-rendered strip holding every frame of the throbber animation and a
+ * per-process tick driving all running throbbers.
+ */
+
+#ifndef _AWN_THROBBER_SPRITE_H
+#define _AWN_THROBBER_SPRITE_H
+
+#include <glib.h>
+#include <cairo.h>
+
+#define AWN_THROBBER_SPRITE_FRAMES 8
+
+typedef struct _AwnThrobberSprite AwnThrobberSprite;
+
+struct _AwnThrobberSprite {
+    cairo_surface_t* strip;
+
+    gint    cell_width;
+    gint    cell_height;
+    gdouble fill[4];
+    gdouble outline[4];
+    gboolean has_outline;
+    gdouble line_width;
+};
+
+gboolean
+awn_throbber_sprite_ensure(AwnThrobberSprite* sprite,
+                           cairo_t* cr,
+                           gint cell_width, gint cell_height,
+                           const gdouble fill[4],
+                           const gdouble* outline,
+                           gdouble line_width);
+
+void
+awn_throbber_sprite_paint(AwnThrobberSprite* sprite,
+                          cairo_t* cr,
+                          gint frame,
+                          gdouble x, gdouble y);
+
+void
+awn_throbber_sprite_clear(AwnThrobberSprite* sprite);
+
+guint
+awn_throbber_tick_add(guint interval, GSourceFunc func, gpointer data);
+
+void
+awn_throbber_tick_remove(guint tick_id);
+
+#endif
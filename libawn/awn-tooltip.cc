@@ -31,6 +31,7 @@
 
 #include "awn-cairo-utils.h"
 #include "awn-config.h"
+#include "awn-stats.h"
 
 #include "gseal-transition.h"
 
@@ -52,6 +53,10 @@ extern "C" {
 
 #define TOOLTIP_ROUND_RADIUS 7.0
 
+/* number of parsed tooltip texts kept around, a couple for every icon of
+ * a full dock */
+#define TOOLTIP_LAYOUTS_MAX 128
+
 struct _AwnTooltipPrivate {
     DesktopAgnosticConfigClient* client;
 
@@ -78,8 +83,35 @@ struct _AwnTooltipPrivate {
 
     gulong enter_id, leave_id, press_id;
     gint old_w, old_h;
+
+    /* rounded rectangle painted for bg_width x bg_height */
+    cairo_surface_t* background;
+    gint bg_width, bg_height;
+
+    /* shape mask used when not composited */
+    GdkBitmap* mask;
+    gint mask_width, mask_height;
+    /* the widget is shaped with the mask above */
+    gboolean mask_applied;
+
+    /* markup the label shows */
+    gchar* markup;
 };
 
+/*
+ * Parsed tooltip markup shared by all tooltips in the process. Hovering
+ * along the dock keeps setting the same few texts, so the label gets the
+ * plain text and attributes from here instead of parsing the markup again.
+ */
+typedef struct {
+    gchar* markup;
+    gchar* text;
+    PangoAttrList* attrs;
+} AwnTooltipLayout;
+
+/* the most recently used first */
+static GQueue layouts = G_QUEUE_INIT;
+
 enum {
     PROP_0,
 
@@ -103,36 +135,87 @@ static gboolean awn_tooltip_hide(AwnTooltip* tooltip,
                                  GdkEventCrossing* event,
                                  GtkWidget* widget);
 
-/* GObject Stuff */
-static gboolean
-awn_tooltip_expose_event(GtkWidget* widget, GdkEventExpose* expose)
+static void
+awn_tooltip_layout_free(AwnTooltipLayout* layout)
 {
-    AwnTooltipPrivate* priv;
-    cairo_t*           cr;
-    GtkAllocation      alloc;
-    gint               width, height;
+    g_free(layout->markup);
+    g_free(layout->text);
+    pango_attr_list_unref(layout->attrs);
+    g_slice_free(AwnTooltipLayout, layout);
+}
 
-    priv = AWN_TOOLTIP(widget)->priv;
+/* Returns the parsed @markup, or NULL if it isn't valid markup. */
+static AwnTooltipLayout*
+awn_tooltip_lookup_layout(const gchar* markup)
+{
+    AwnTooltipLayout* layout;
+    PangoAttrList* attrs;
+    gchar* text;
+    GList* iter;
+
+    for (iter = layouts.head; iter != NULL; iter = iter->next) {
+        layout = (AwnTooltipLayout*)iter->data;
+
+        if (strcmp(layout->markup, markup) == 0) {
+            if (iter != layouts.head) {
+                g_queue_unlink(&layouts, iter);
+                g_queue_push_head_link(&layouts, iter);
+            }
+            AWN_STATS_COUNT(AWN_STATS_TOOLTIP_LAYOUT_CACHE_HIT);
+
+            return layout;
+        }
+    }
 
-    gtk_widget_get_allocation(widget, &alloc);
+    AWN_STATS_COUNT(AWN_STATS_TOOLTIP_LAYOUT_CACHE_MISS);
 
-    width = alloc.width;
-    height = alloc.height;
+    if (!pango_parse_markup(markup, -1, 0, &attrs, &text, NULL, NULL)) {
+        return NULL;
+    }
 
-    cr = gdk_cairo_create(gtk_widget_get_window(widget));
+    layout = g_slice_new(AwnTooltipLayout);
+    layout->markup = g_strdup(markup);
+    layout->text = text;
+    layout->attrs = attrs;
+    g_queue_push_head(&layouts, layout);
 
-    if (!cr) {
-        return FALSE;
+    if (g_queue_get_length(&layouts) > TOOLTIP_LAYOUTS_MAX) {
+        awn_tooltip_layout_free(
+            (AwnTooltipLayout*)g_queue_pop_tail(&layouts));
     }
 
-    /* Clear the background to transparent */
-    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(cr);
+    return layout;
+}
+
+/* The background only depends on the size and the colours, so it's painted
+ * once and then just copied to the window on every expose.
+ */
+static cairo_surface_t*
+awn_tooltip_get_background(AwnTooltip* tooltip, cairo_t* target,
+                           gint width, gint height)
+{
+    AwnTooltipPrivate* priv = tooltip->priv;
+    cairo_t* cr;
+
+    if (priv->background &&
+            priv->bg_width == width && priv->bg_height == height) {
+        return priv->background;
+    }
+
+    if (priv->background) {
+        cairo_surface_destroy(priv->background);
+    }
+
+    priv->background = cairo_surface_create_similar(cairo_get_target(target),
+                       CAIRO_CONTENT_COLOR_ALPHA,
+                       width, height);
+    priv->bg_width = width;
+    priv->bg_height = height;
+
+    cr = cairo_create(priv->background);
 
-    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     cairo_set_line_width(cr, 1.0);
 
-    /* Draw */
     awn_cairo_set_source_color(cr, priv->bg);
 
     awn_cairo_rounded_rect(cr, 0, 0, width, height,
@@ -146,6 +229,51 @@ awn_tooltip_expose_event(GtkWidget* widget, GdkEventExpose* expose)
         cairo_fill(cr);
     }
 
+    cairo_destroy(cr);
+
+    AWN_STATS_COUNT(AWN_STATS_TOOLTIP_BACKGROUND_RENDER);
+
+    return priv->background;
+}
+
+static void
+awn_tooltip_invalidate_background(AwnTooltip* tooltip)
+{
+    AwnTooltipPrivate* priv = tooltip->priv;
+
+    if (priv->background) {
+        cairo_surface_destroy(priv->background);
+        priv->background = NULL;
+    }
+}
+
+/* GObject Stuff */
+static gboolean
+awn_tooltip_expose_event(GtkWidget* widget, GdkEventExpose* expose)
+{
+    cairo_t*           cr;
+    cairo_surface_t*   background;
+    GtkAllocation      alloc;
+
+    gtk_widget_get_allocation(widget, &alloc);
+
+    cr = gdk_cairo_create(gtk_widget_get_window(widget));
+
+    if (!cr) {
+        return FALSE;
+    }
+
+    background = awn_tooltip_get_background(AWN_TOOLTIP(widget), cr,
+                                            alloc.width, alloc.height);
+
+    gdk_cairo_region(cr, expose->region);
+    cairo_clip(cr);
+
+    /* Replaces the damaged area, including the transparent corners */
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, background, 0.0, 0.0);
+    cairo_paint(cr);
+
     /* Clean up */
     cairo_destroy(cr);
 
@@ -159,35 +287,53 @@ awn_tooltip_expose_event(GtkWidget* widget, GdkEventExpose* expose)
 static void
 awn_tooltip_set_mask(AwnTooltip* tooltip, gint width, gint height)
 {
+    AwnTooltipPrivate* priv = tooltip->priv;
     GtkWidget* widget = GTK_WIDGET(tooltip);
 
-    if (gtk_widget_is_composited(widget) == FALSE) {
-        GdkBitmap* shaped_bitmap;
-        shaped_bitmap = (GdkBitmap*) gdk_pixmap_new(NULL, width, height, 1);
+    if (gtk_widget_is_composited(widget)) {
+        return;
+    }
 
-        if (shaped_bitmap) {
-            cairo_t* cr = gdk_cairo_create(shaped_bitmap);
+    /* the outline only depends on the size, keep it for the next time */
+    if (priv->mask == NULL ||
+            priv->mask_width != width || priv->mask_height != height) {
+        priv->mask_applied = FALSE;
 
-            cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-            cairo_paint(cr);
+        if (priv->mask) {
+            g_object_unref(priv->mask);
+        }
 
-            cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-            cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
-            cairo_translate(cr, 0.5, 0.5);
+        priv->mask = (GdkBitmap*) gdk_pixmap_new(NULL, width, height, 1);
+        priv->mask_width = width;
+        priv->mask_height = height;
 
+        if (priv->mask == NULL) {
+            return;
+        }
 
-            awn_cairo_rounded_rect(cr, 0, 0, width, height,
-                                   TOOLTIP_ROUND_RADIUS, ROUND_ALL);
-            cairo_fill(cr);
+        cairo_t* cr = gdk_cairo_create(priv->mask);
 
-            cairo_destroy(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
 
-            gtk_widget_shape_combine_mask(widget, NULL, 0, 0);
-            gtk_widget_shape_combine_mask(widget, shaped_bitmap, 0, 0);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_translate(cr, 0.5, 0.5);
 
-            g_object_unref(shaped_bitmap);
-        }
+
+        awn_cairo_rounded_rect(cr, 0, 0, width, height,
+                               TOOLTIP_ROUND_RADIUS, ROUND_ALL);
+        cairo_fill(cr);
+
+        cairo_destroy(cr);
+
+        AWN_STATS_COUNT(AWN_STATS_TOOLTIP_MASKS);
+    } else if (priv->mask_applied) {
+        return;
     }
+
+    gtk_widget_shape_combine_mask(widget, priv->mask, 0, 0);
+    priv->mask_applied = TRUE;
 }
 
 static gboolean
@@ -217,6 +363,7 @@ _on_composited_changed(GtkWidget* widget)
         awn_tooltip_set_mask(AWN_TOOLTIP(widget), alloc.width, alloc.height);
     } else {
         gtk_widget_shape_combine_mask(widget, NULL, 0, 0);
+        AWN_TOOLTIP(widget)->priv->mask_applied = FALSE;
     }
 }
 
@@ -450,6 +597,18 @@ awn_tooltip_finalize(GObject* obj)
         g_object_unref(priv->outline_color);
         priv->outline_color = NULL;
     }
+    if (priv->markup) {
+        g_free(priv->markup);
+        priv->markup = NULL;
+    }
+    if (priv->background) {
+        cairo_surface_destroy(priv->background);
+        priv->background = NULL;
+    }
+    if (priv->mask) {
+        g_object_unref(priv->mask);
+        priv->mask = NULL;
+    }
 
     G_OBJECT_CLASS(awn_tooltip_parent_class)->finalize(obj);
 }
@@ -692,6 +851,7 @@ static void
 ensure_tooltip(AwnTooltip* tooltip)
 {
     AwnTooltipPrivate* priv = tooltip->priv;
+    AwnTooltipLayout* layout;
     gchar* normal = NULL;
     GdkColor clr;
     gchar* color = NULL;
@@ -707,13 +867,30 @@ ensure_tooltip(AwnTooltip* tooltip)
     markup = g_strdup_printf("<span foreground='%s' font_desc='%s'>%s</span>",
                              color, priv->font_name, normal);
 
+    g_free(normal);
+    g_free(color);
+
+    /* nothing changed, so neither did the size */
+    if (g_strcmp0(markup, priv->markup) == 0) {
+        g_free(markup);
+        return;
+    }
+
     gtk_label_set_max_width_chars(GTK_LABEL(priv->label), 120);
     gtk_label_set_ellipsize(GTK_LABEL(priv->label), PANGO_ELLIPSIZE_END);
-    gtk_label_set_markup(GTK_LABEL(priv->label), markup);
 
-    g_free(normal);
-    g_free(color);
-    g_free(markup);
+    layout = awn_tooltip_lookup_layout(markup);
+    if (layout) {
+        /* the attributes have to be in place before the text is set */
+        gtk_label_set_attributes(GTK_LABEL(priv->label), layout->attrs);
+        gtk_label_set_text(GTK_LABEL(priv->label), layout->text);
+    } else {
+        gtk_label_set_attributes(GTK_LABEL(priv->label), NULL);
+        gtk_label_set_markup(GTK_LABEL(priv->label), markup);
+    }
+
+    g_free(priv->markup);
+    priv->markup = markup;
 
     if (gtk_widget_get_mapped(GTK_WIDGET(tooltip)) && GTK_IS_WIDGET(priv->focus)) {
         awn_tooltip_update_position(tooltip);
@@ -970,6 +1147,7 @@ awn_tooltip_set_outline_color(AwnTooltip*           tooltip,
             desktop_agnostic_color_new_from_string("#00000000", NULL);
     }
 
+    awn_tooltip_invalidate_background(tooltip);
     gtk_widget_queue_draw(GTK_WIDGET(tooltip));
 }
 
@@ -993,6 +1171,7 @@ awn_tooltip_set_background_color(AwnTooltip*           tooltip,
         priv->bg = desktop_agnostic_color_new_from_string("#000000B3", NULL);
     }
 
+    awn_tooltip_invalidate_background(tooltip);
     gtk_widget_queue_draw(GTK_WIDGET(tooltip));
 }
 
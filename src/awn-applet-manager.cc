@@ -21,8 +21,11 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <libawn/libawn.h>
 #include <libawn/awn-utils.h>
+#include "libawn/awn-path.h"
 #include "libawn/gseal-transition.h"
 
 #include "awn-defines.h"
@@ -66,8 +69,31 @@ struct _AwnAppletManagerPrivate {
     GQuark           touch_quark;
     GQuark           visibility_quark;
     GQuark           shape_mask_quark;
+
+    AwnPathTable     path_table;
+
+    /* input mask: per-child pieces are kept as qdata, the union is rebuilt
+     * only when one of them (or the set of them) changes */
+    GQuark           mask_piece_quark;
+    GdkRegion*       mask_region;
+    GPtrArray*       mask_pieces;
+    guint            mask_generation;
+    guint            mask_serial;
+    AwnPathType      mask_path_type;
+    gfloat           mask_offset_modifier;
+    gint             mask_size;
+    gint             mask_offset;
+    GtkPositionType  mask_position;
+    GtkAllocation    mask_alloc;
 };
 
+typedef struct {
+    GdkRegion*    region;
+    GtkAllocation alloc;
+    /* serial of the curve parameters, 0 for pieces made from shape masks */
+    guint         serial;
+} AwnMaskPiece;
+
 enum {
     PROP_0,
 
@@ -277,6 +303,18 @@ awn_applet_manager_dispose(GObject* object)
         priv->extra_widgets = NULL;
     }
 
+    awn_path_table_clear(&priv->path_table);
+
+    if (priv->mask_region) {
+        gdk_region_destroy(priv->mask_region);
+        priv->mask_region = NULL;
+    }
+
+    if (priv->mask_pieces) {
+        g_ptr_array_free(priv->mask_pieces, TRUE);
+        priv->mask_pieces = NULL;
+    }
+
     desktop_agnostic_config_client_unbind_all_for_object(priv->client,
             object, NULL);
 
@@ -415,6 +453,8 @@ awn_applet_manager_init(AwnAppletManager* manager)
     priv->touch_quark = g_quark_from_string("applets-touch-quark");
     priv->visibility_quark = g_quark_from_string("visibility-quark");
     priv->shape_mask_quark = g_quark_from_string("shape-mask-quark");
+    priv->mask_piece_quark = g_quark_from_string("mask-piece-quark");
+    priv->mask_pieces = g_ptr_array_new();
     priv->applets = g_hash_table_new_full(g_str_hash, g_str_equal,
                                           g_free, NULL);
     priv->extra_widgets = g_hash_table_new(g_direct_hash, g_direct_equal);
@@ -505,12 +545,15 @@ awn_applet_manager_set_applet_flags(AwnAppletManager* manager,
                 g_object_set_qdata_full(G_OBJECT(applet), priv->shape_mask_quark,
                                         xutils_get_input_shape(win),
                                         (GDestroyNotify) gdk_region_destroy);
+                g_object_set_qdata(G_OBJECT(applet), priv->mask_piece_quark, NULL);
                 g_signal_emit(manager, _applet_manager_signals[SHAPE_MASK_CHANGED], 0);
             } else {
                 gpointer region = g_object_get_qdata(G_OBJECT(applet),
                                                      priv->shape_mask_quark);
                 if (region) {
                     g_object_set_qdata(G_OBJECT(applet), priv->shape_mask_quark, NULL);
+                    g_object_set_qdata(G_OBJECT(applet), priv->mask_piece_quark,
+                                       NULL);
                     g_signal_emit(manager, _applet_manager_signals[SHAPE_MASK_CHANGED],
                                   0);
                 }
@@ -903,6 +946,40 @@ awn_applet_manager_remove_widget(AwnAppletManager* manager, GtkWidget* widget)
     }
 }
 
+/* Curve offset at [x, y] relative to the manager, looked up in a table
+ * which is only rebuilt when the path parameters or our length change. */
+static gint
+awn_applet_manager_get_offset_at(AwnAppletManager* manager,
+                                 AwnPathType path_type,
+                                 gfloat offset_modifier,
+                                 GtkAllocation* manager_alloc,
+                                 gint x, gint y)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gint length, pos;
+
+    if (manager_alloc->width == 0 || manager_alloc->height == 0) {
+        return priv->offset;
+    }
+
+    switch (priv->position) {
+    case GTK_POS_LEFT:
+    case GTK_POS_RIGHT:
+        length = manager_alloc->height;
+        pos = y;
+        break;
+    default:
+        length = manager_alloc->width;
+        pos = x;
+        break;
+    }
+
+    awn_path_table_ensure(&priv->path_table, path_type,
+                          priv->offset, offset_modifier, length);
+
+    return round(awn_path_table_get_offset(&priv->path_table, pos));
+}
+
 static void
 on_icon_size_alloc(GtkWidget* widget, GtkAllocation* alloc,
                    AwnAppletManager* manager)
@@ -926,13 +1003,10 @@ on_icon_size_alloc(GtkWidget* widget, GtkAllocation* alloc,
                  NULL);
 
     // get curve offset
-    gfloat temp = awn_utils_get_offset_modifier_by_path_type(path_type,
-                  priv->position, priv->offset, offset_modifier,
+    gint offset = awn_applet_manager_get_offset_at(manager,
+                  path_type, offset_modifier, &manager_alloc,
                   alloc->x + alloc->width / 2 - manager_alloc.x,
-                  alloc->y + alloc->height / 2 - manager_alloc.y,
-                  manager_alloc.width,
-                  manager_alloc.height);
-    gint offset = round(temp);
+                  alloc->y + alloc->height / 2 - manager_alloc.y);
 
     if (AWN_IS_ICON(widget)) {
         awn_icon_set_offset(AWN_ICON(widget), offset);
@@ -1059,17 +1133,17 @@ awn_ua_add_applet(AwnAppletManager* manager,
         }
     }
     array = awn_utils_gslist_to_gvaluearray(priv->ua_list);
-    desktop_agnostic_config_client_set_list(priv->client,
-                                            AWN_GROUP_PANEL, AWN_PANEL_UA_LIST,
-                                            array, NULL);
+    awn_config_set_list_deferred(priv->client,
+                                 AWN_GROUP_PANEL, AWN_PANEL_UA_LIST,
+                                 array);
     g_value_array_free(array);
     /*Add our newly active screenlet to thend of the active list */
     priv->ua_active_list = g_slist_append(priv->ua_active_list, g_strdup(ua_list_entry));
     array = awn_utils_gslist_to_gvaluearray(priv->ua_active_list);
-    desktop_agnostic_config_client_set_list(priv->client,
-                                            AWN_GROUP_PANEL,
-                                            AWN_PANEL_UA_ACTIVE_LIST,
-                                            array, NULL);
+    awn_config_set_list_deferred(priv->client,
+                                 AWN_GROUP_PANEL,
+                                 AWN_PANEL_UA_ACTIVE_LIST,
+                                 array);
     g_value_array_free(array);
 
     return TRUE;
@@ -1181,69 +1255,168 @@ awn_applet_manager_redraw_throbbers(AwnAppletManager* manager)
     g_list_free(list);
 }
 
+static void
+awn_mask_piece_free(AwnMaskPiece* piece)
+{
+    gdk_region_destroy(piece->region);
+    g_free(piece);
+}
+
+static AwnMaskPiece*
+awn_applet_manager_get_mask_piece(AwnAppletManager* manager,
+                                  GtkWidget* widget,
+                                  AwnPathType path_type,
+                                  gfloat offset_modifier,
+                                  gboolean* rebuilt)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    AwnMaskPiece* piece;
+    GtkAllocation alloc;
+    gpointer mask;
+
+    gtk_widget_get_allocation(widget, &alloc);
+    mask = g_object_get_qdata(G_OBJECT(widget), priv->shape_mask_quark);
+
+    piece = (AwnMaskPiece*)g_object_get_qdata(G_OBJECT(widget),
+            priv->mask_piece_quark);
+    if (piece && memcmp(&piece->alloc, &alloc, sizeof(GtkAllocation)) == 0 &&
+            (mask || piece->serial == priv->mask_serial)) {
+        return piece;
+    }
+
+    piece = g_new0(AwnMaskPiece, 1);
+    piece->alloc = alloc;
+
+    if (mask) {
+        piece->region = gdk_region_copy((GdkRegion*)mask);
+        gdk_region_offset(piece->region, alloc.x, alloc.y);
+    } else {
+        // GtkAllocation and GdkRectangle are the same, we can do this
+        GdkRectangle rect = alloc;
+        GtkAllocation* manager_alloc = &priv->mask_alloc;
+
+        // get curve offset
+        gint offset = awn_applet_manager_get_offset_at(manager,
+                      path_type, offset_modifier, manager_alloc,
+                      rect.x + rect.width / 2 - manager_alloc->x,
+                      rect.y + rect.height / 2 - manager_alloc->y);
+
+        gint size = priv->size + offset;
+
+        switch (priv->position) {
+        case GTK_POS_BOTTOM:
+            rect.y += rect.height - size;
+            // no break!
+        case GTK_POS_TOP:
+            rect.height = size;
+            break;
+        case GTK_POS_RIGHT:
+            rect.x += rect.width - size;
+            // no break!
+        case GTK_POS_LEFT:
+            rect.width = size;
+            break;
+        }
+        piece->region = gdk_region_rectangle(&rect);
+        piece->serial = priv->mask_serial;
+    }
+
+    g_object_set_qdata_full(G_OBJECT(widget), priv->mask_piece_quark, piece,
+                            (GDestroyNotify)awn_mask_piece_free);
+    *rebuilt = TRUE;
+
+    return piece;
+}
+
+/**
+ * awn_applet_manager_get_mask:
+ * @manager: an #AwnAppletManager.
+ * @path_type: current path type of the panel.
+ * @offset_modifier: current offset modifier of the panel.
+ * @generation: (out) (allow-none): location for the mask generation.
+ *
+ * The mask is the union of one cached piece per child; a piece is only
+ * recomputed when the child's allocation or shape mask changes (or the curve
+ * parameters for children without a shape mask). The generation changes
+ * whenever the returned region does.
+ *
+ * Returns: a newly allocated #GdkRegion, free with gdk_region_destroy().
+ */
 GdkRegion*
 awn_applet_manager_get_mask(AwnAppletManager* manager,
                             AwnPathType path_type,
-                            gfloat offset_modifier)
+                            gfloat offset_modifier,
+                            guint* generation)
 {
     g_return_val_if_fail(AWN_IS_APPLET_MANAGER(manager), NULL);
     AwnAppletManagerPrivate* priv = manager->priv;
+    GtkAllocation manager_alloc;
+    gboolean dirty = FALSE;
+    guint n = 0;
+
+    gtk_widget_get_allocation(GTK_WIDGET(manager), &manager_alloc);
+    if (priv->mask_path_type != path_type ||
+            priv->mask_offset_modifier != offset_modifier ||
+            priv->mask_size != priv->size ||
+            priv->mask_offset != priv->offset ||
+            priv->mask_position != priv->position ||
+            memcmp(&priv->mask_alloc, &manager_alloc,
+                   sizeof(GtkAllocation)) != 0) {
+        priv->mask_path_type = path_type;
+        priv->mask_offset_modifier = offset_modifier;
+        priv->mask_size = priv->size;
+        priv->mask_offset = priv->offset;
+        priv->mask_position = priv->position;
+        priv->mask_alloc = manager_alloc;
+        priv->mask_serial++;
+    }
 
-    GdkRegion* region = gdk_region_new();
     GList* children = gtk_container_get_children(GTK_CONTAINER(manager));
 
     for (GList* iter = children; iter != NULL; iter = g_list_next(iter)) {
         GtkWidget* widget = (GtkWidget*)iter->data;
         if (gtk_widget_get_visible(widget) && gtk_widget_get_has_window(widget)) {
-            gpointer mask = g_object_get_qdata(G_OBJECT(widget),
-                                               priv->shape_mask_quark);
-            if (mask) {
-                GdkRegion* temp_region = gdk_region_copy(mask);
-                GtkAllocation alloc;
-
-                gtk_widget_get_allocation(widget, &alloc);
-                gdk_region_offset(temp_region, alloc.x, alloc.y);
-                gdk_region_union(region, temp_region);
-                gdk_region_destroy(temp_region);
-            } else {
-                // GtkAllocation and GdkRectangle are the same, we can do this
-                GtkAllocation manager_alloc;
-                GdkRectangle rect;
-
-                gtk_widget_get_allocation(GTK_WIDGET(manager), &manager_alloc);
-                gtk_widget_get_allocation(widget, &rect);
-                // get curve offset
-                gfloat temp = awn_utils_get_offset_modifier_by_path_type(path_type,
-                              priv->position, priv->offset, offset_modifier,
-                              rect.x + rect.width / 2 - manager_alloc.x,
-                              rect.y + rect.height / 2 - manager_alloc.y,
-                              manager_alloc.width,
-                              manager_alloc.height);
-                gint offset = round(temp);
-
-                gint size = priv->size + offset;
-
-                switch (priv->position) {
-                case GTK_POS_BOTTOM:
-                    rect.y += rect.height - size;
-                    // no break!
-                case GTK_POS_TOP:
-                    rect.height = size;
-                    break;
-                case GTK_POS_RIGHT:
-                    rect.x += rect.width - size;
-                    // no break!
-                case GTK_POS_LEFT:
-                    rect.width = size;
-                    break;
+            AwnMaskPiece* piece = awn_applet_manager_get_mask_piece(manager,
+                                  widget, path_type, offset_modifier, &dirty);
+            // the pieces are compared only by address, a rebuilt one is
+            // already reported through dirty
+            if (n >= priv->mask_pieces->len ||
+                    g_ptr_array_index(priv->mask_pieces, n) != piece) {
+                dirty = TRUE;
+                if (n < priv->mask_pieces->len) {
+                    g_ptr_array_index(priv->mask_pieces, n) = piece;
+                } else {
+                    g_ptr_array_add(priv->mask_pieces, piece);
                 }
-                gdk_region_union_with_rect(region, &rect);
             }
+            n++;
+        }
+    }
+
+    if (n != priv->mask_pieces->len) {
+        dirty = TRUE;
+        g_ptr_array_set_size(priv->mask_pieces, n);
+    }
+
+    if (dirty || priv->mask_region == NULL) {
+        if (priv->mask_region) {
+            gdk_region_destroy(priv->mask_region);
         }
+        priv->mask_region = gdk_region_new();
+        for (guint i = 0; i < priv->mask_pieces->len; i++) {
+            AwnMaskPiece* piece =
+                (AwnMaskPiece*)g_ptr_array_index(priv->mask_pieces, i);
+            gdk_region_union(priv->mask_region, piece->region);
+        }
+        priv->mask_generation++;
     }
 
     g_list_free(children);
 
-    return region;
+    if (generation) {
+        *generation = priv->mask_generation;
+    }
+
+    return gdk_region_copy(priv->mask_region);
 }
 
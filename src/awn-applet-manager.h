@@ -99,7 +99,8 @@ void        awn_applet_manager_redraw_throbbers(AwnAppletManager* manager);
 
 GdkRegion*  awn_applet_manager_get_mask(AwnAppletManager* manager,
                                         AwnPathType path_type,
-                                        gfloat offset_modifier);
+                                        gfloat offset_modifier,
+                                        guint* generation);
 
 /* UA stuff */
 
@@ -86,6 +86,10 @@ static void awn_background_3d_input_shape_mask(AwnBackground*  bg,
 
 static void awn_background_3d_update_padding(AwnBackground* bg);
 
+static gboolean awn_background_3d_get_slice_cap(AwnBackground* bg,
+        GtkPositionType position,
+        gint* cap);
+
 static void
 awn_background_3d_constructed(GObject* object)
 {
@@ -149,6 +153,7 @@ awn_background_3d_class_init(AwnBackground3dClass* klass)
 
     bg_class->padding_request = awn_background_3d_padding_request;
     bg_class->get_input_shape_mask = awn_background_3d_input_shape_mask;
+    bg_class->get_slice_cap = awn_background_3d_get_slice_cap;
 }
 
 
@@ -391,6 +396,39 @@ draw_rect_path(cairo_t* cr, Point3* vertices, float padding)
     cairo_close_path(cr);
 }
 
+/*
+ * The vertices and the paths of both planes are the same for draw and
+ * input shape mask, so they are computed only once per layout change.
+ */
+static Point3*
+get_vertices_cached(AwnBackground*         bg,
+                    AwnBackgroundGeometry* geom,
+                    float                  width,
+                    float                  height)
+{
+    if (geom->data == NULL) {
+        awn_background_geometry_set_data(geom,
+                                         calc_points(bg, 0., 0., width, height),
+                                         free);
+    }
+    return (Point3*)geom->data;
+}
+
+static void
+draw_rect_path_cached(AwnBackgroundGeometry* geom,
+                      AwnBackgroundPathId    id,
+                      cairo_t*               cr,
+                      Point3*                vertices,
+                      float                  padding)
+{
+    if (awn_background_geometry_append_path(geom, id, cr)) {
+        return;
+    }
+
+    draw_rect_path(cr, vertices, padding);
+    awn_background_geometry_store_path(geom, id, cr);
+}
+
 /**
  * draw_top_bottom_background:
  * @param bg: AwnBackground
@@ -402,10 +440,11 @@ draw_rect_path(cairo_t* cr, Point3* vertices, float padding)
  * on position x:0, y:0 with the specified &width and &height.
  */
 static void
-draw_top_bottom_background(AwnBackground*  bg,
-                           cairo_t*        cr,
-                           gfloat          width,
-                           gfloat          height)
+draw_top_bottom_background(AwnBackground*         bg,
+                           AwnBackgroundGeometry* geom,
+                           cairo_t*               cr,
+                           gfloat                 width,
+                           gfloat                 height)
 {
     cairo_pattern_t* pat;
     float s = OBTAIN_THICKNESS(bg->panel_angle, bg->thickness);
@@ -419,7 +458,7 @@ draw_top_bottom_background(AwnBackground*  bg,
     width -= DRAW_XPADDING * 2.;
 
     /* calc vertices for draw the main path */
-    Point3* vertices = calc_points(bg, 0., 0., width, height);
+    Point3* vertices = get_vertices_cached(bg, geom, width, height);
     /* calc the y coord of the top panel, used for pattern painting */
     float top_y = vertices[8].y;
 
@@ -440,7 +479,8 @@ draw_top_bottom_background(AwnBackground*  bg,
         /* if side is transparent (1. / 255.), don't draw bottom border */
         if (alpha > 0.003) {
             cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-            draw_rect_path(cr, vertices, s);
+            draw_rect_path_cached(geom, AWN_BACKGROUND_PATH_INNER, cr,
+                                  vertices, s);
 #if FILL_BOTTOM_PLANE
             cairo_save(cr);
             awn_cairo_set_source_color(cr, bg->hilight_color);
@@ -456,7 +496,12 @@ draw_top_bottom_background(AwnBackground*  bg,
             cairo_set_line_width(cr, 1.5);
             cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
             for (i = s - 1.; i >= 0. ; i -= 1.) {
-                draw_rect_path(cr, vertices, i);
+                /* the top plane moved down by i */
+                cairo_save(cr);
+                cairo_translate(cr, 0., i);
+                draw_rect_path_cached(geom, AWN_BACKGROUND_PATH_OUTER, cr,
+                                      vertices, 0.);
+                cairo_restore(cr);
                 awn_cairo_set_source_color(cr, bg->hilight_color);
                 cairo_stroke(cr);
             }
@@ -503,7 +548,7 @@ draw_top_bottom_background(AwnBackground*  bg,
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     cairo_set_line_width(cr, 2.);
     /* Draw the path of top plane */
-    draw_rect_path(cr, vertices, 0.);
+    draw_rect_path_cached(geom, AWN_BACKGROUND_PATH_OUTER, cr, vertices, 0.);
     /* obtain 0.0 - 1.0 relative height for pattern drawing */
     top_y = top_y / height;
 
@@ -575,8 +620,6 @@ draw_top_bottom_background(AwnBackground*  bg,
 #endif
     /* restore genereal context */
     cairo_restore(cr);
-    /* free memory :) */
-    free(vertices);
 }
 
 /**
@@ -708,6 +751,9 @@ awn_background_3d_draw(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -736,7 +782,7 @@ awn_background_3d_draw(AwnBackground*  bg,
         break;
     }
 
-    draw_top_bottom_background(bg, cr, width, height);
+    draw_top_bottom_background(bg, geom, cr, width, height);
 
     cairo_restore(cr);
 }
@@ -764,6 +810,9 @@ awn_background_3d_input_shape_mask(AwnBackground*  bg,
     gfloat temp;
     gfloat x = area->x, y = area->y;
     gfloat width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -803,13 +852,27 @@ awn_background_3d_input_shape_mask(AwnBackground*  bg,
     /* Draw the background (in black color) */
     cairo_set_source_rgba(cr, 1., 1., 1., 1.);
     /* for shape mask draw only top and bottom plane */
-    Point3* vertices = calc_points(bg, 0., 0., width, height);
-    draw_rect_path(cr, vertices, 0.);
+    Point3* vertices = get_vertices_cached(bg, geom, width, height);
+    draw_rect_path_cached(geom, AWN_BACKGROUND_PATH_OUTER, cr, vertices, 0.);
     cairo_fill(cr);
-    draw_rect_path(cr, vertices, s);
+    draw_rect_path_cached(geom, AWN_BACKGROUND_PATH_INNER, cr, vertices, s);
     cairo_fill(cr);
-    free(vertices);
 
     cairo_restore(cr);
 }
 
+static gboolean
+awn_background_3d_get_slice_cap(AwnBackground* bg,
+                                GtkPositionType position,
+                                gint* cap)
+{
+    /* With a non-zero angle the perspective moves the corners depending
+     * on the width, and the pattern isn't anchored to the ends of the panel.
+     */
+    if (bg->panel_angle != 0 || (bg->enable_pattern && bg->pattern)) {
+        return FALSE;
+    }
+
+    *cap = ceil(bg->corner_radius) + DRAW_XPADDING + 4;
+    return TRUE;
+}
@@ -130,6 +130,26 @@ draw_rect_path(AwnBackground*  bg,
     cairo_restore(cr);
 }
 
+/* replaces the current path with the cached one, builds it on a miss */
+static void
+draw_rect_path_cached(AwnBackground*         bg,
+                      AwnBackgroundGeometry* geom,
+                      AwnBackgroundPathId    id,
+                      cairo_t*               cr,
+                      gdouble                x,
+                      gdouble                y,
+                      gint                   width,
+                      gint                   height)
+{
+    if (awn_background_geometry_append_path(geom, id, cr)) {
+        return;
+    }
+
+    cairo_new_path(cr);
+    draw_rect_path(bg, cr, x, y, width, height);
+    awn_background_geometry_store_path(geom, id, cr);
+}
+
 /**
  * draw_top_bottom_background:
  * @param bg: AwnBackground
@@ -143,12 +163,13 @@ draw_rect_path(AwnBackground*  bg,
  * the &x position, &y position, &width and &height.
  */
 static void
-draw_top_bottom_background(AwnBackground*  bg,
-                           cairo_t*        cr,
-                           gdouble         x,
-                           gdouble         y,
-                           gint            width,
-                           gint            height)
+draw_top_bottom_background(AwnBackground*         bg,
+                           AwnBackgroundGeometry* geom,
+                           cairo_t*               cr,
+                           gdouble                x,
+                           gdouble                y,
+                           gint                   width,
+                           gint                   height)
 {
     cairo_pattern_t* pat;
     cairo_matrix_t matrix;
@@ -187,7 +208,8 @@ draw_top_bottom_background(AwnBackground*  bg,
 
     cairo_save(cr);
 
-    draw_rect_path(bg, cr, 0, height - curves_height, width, curves_height);
+    draw_rect_path_cached(bg, geom, AWN_BACKGROUND_PATH_OUTER, cr,
+                          0, height - curves_height, width, curves_height);
     cairo_clip(cr);
     cairo_set_source(cr, pat);
     cairo_paint(cr);
@@ -198,13 +220,15 @@ draw_top_bottom_background(AwnBackground*  bg,
 
     /* Internal border */
     awn_cairo_set_source_color(cr, bg->hilight_color);
-    draw_rect_path(bg, cr, 1.0, height - curves_height + 2.0,
-                   width - 2.0, curves_height - 2.0);
+    draw_rect_path_cached(bg, geom, AWN_BACKGROUND_PATH_INNER, cr,
+                          1.0, height - curves_height + 2.0,
+                          width - 2.0, curves_height - 2.0);
     cairo_stroke(cr);
 
     /* External border */
     awn_cairo_set_source_color(cr, bg->border_color);
-    draw_rect_path(bg, cr, 0.0, height - curves_height, width, curves_height);
+    draw_rect_path_cached(bg, geom, AWN_BACKGROUND_PATH_OUTER, cr,
+                          0.0, height - curves_height, width, curves_height);
     cairo_stroke(cr);
 
     /* Drawing inner ellips */
@@ -227,7 +251,9 @@ draw_top_bottom_background(AwnBackground*  bg,
     cairo_matrix_init_scale(&matrix, inner_pat_xscale, 1.0);
     cairo_pattern_set_matrix(pat, &matrix);
 
-    draw_rect_path(bg, cr, x_pos, height - curves_height / 2.0,  width_inner, curves_height / 2.0);
+    draw_rect_path_cached(bg, geom, AWN_BACKGROUND_PATH_FILL, cr,
+                          x_pos, height - curves_height / 2.0,
+                          width_inner, curves_height / 2.0);
 
     cairo_set_source(cr, pat);
     cairo_fill(cr);
@@ -322,6 +348,9 @@ awn_background_curves_draw(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -348,7 +377,7 @@ awn_background_curves_draw(AwnBackground*  bg,
         break;
     }
 
-    draw_top_bottom_background(bg, cr, 0, 0, width, height);
+    draw_top_bottom_background(bg, geom, cr, 0, 0, width, height);
 
     cairo_restore(cr);
 }
@@ -361,6 +390,9 @@ static void awn_background_curves_mask(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -398,7 +430,9 @@ static void awn_background_curves_mask(AwnBackground*  bg,
     if (bg->curviness < 1.0) {
         curves_height = height * bg->curviness;
     }
-    draw_rect_path(bg, cr, 0, height - curves_height, width, curves_height);
+    /* same path as the external border */
+    draw_rect_path_cached(bg, geom, AWN_BACKGROUND_PATH_OUTER, cr,
+                          0, height - curves_height, width, curves_height);
     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_rgba(cr, 1., 1., 1., 1.);
     cairo_fill(cr);
@@ -230,6 +230,8 @@ awn_background_edgy_class_init(AwnBackgroundEdgyClass* klass)
     bg_class->get_shape_mask = awn_background_edgy_get_shape_mask;
     bg_class->get_input_shape_mask = awn_background_edgy_get_shape_mask;
     bg_class->get_strut_offsets = awn_background_edgy_get_strut_offsets;
+    /* the edge is drawn only at one end of the panel */
+    bg_class->get_slice_cap = NULL;
 
     g_type_class_add_private(obj_class, sizeof(AwnBackgroundEdgyPrivate));
 }
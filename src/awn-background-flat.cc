@@ -47,6 +47,10 @@ static void awn_background_flat_padding_request(AwnBackground* bg,
         guint* padding_left,
         guint* padding_right);
 
+static gboolean awn_background_flat_get_slice_cap(AwnBackground* bg,
+        GtkPositionType position,
+        gint* cap);
+
 static void
 awn_background_flat_expand_changed(AwnBackground* bg)  // has more params...
 {
@@ -122,6 +126,7 @@ awn_background_flat_class_init(AwnBackgroundFlatClass* klass)
     bg_class->padding_request = awn_background_flat_padding_request;
     bg_class->get_shape_mask = awn_background_flat_get_shape_mask;
     bg_class->get_input_shape_mask = awn_background_flat_get_shape_mask;
+    bg_class->get_slice_cap = awn_background_flat_get_slice_cap;
 }
 
 
@@ -178,12 +183,36 @@ draw_rect(AwnBackground*  bg,
     awn_cairo_rounded_rect(cr, x, y, width, height, bg->corner_radius, state);
 }
 
+/* replaces the current path with the cached one, builds it on a miss */
+static void
+draw_rect_cached(AwnBackground*         bg,
+                 AwnBackgroundGeometry* geom,
+                 AwnBackgroundPathId    id,
+                 cairo_t*               cr,
+                 GtkPositionType        position,
+                 gdouble                x,
+                 gdouble                y,
+                 gint                   width,
+                 gint                   height,
+                 gfloat                 align,
+                 gboolean               expand)
+{
+    if (awn_background_geometry_append_path(geom, id, cr)) {
+        return;
+    }
+
+    cairo_new_path(cr);
+    draw_rect(bg, cr, position, x, y, width, height, align, expand);
+    awn_background_geometry_store_path(geom, id, cr);
+}
+
 static void
-draw_top_bottom_background(AwnBackground*  bg,
-                           GtkPositionType position,
-                           cairo_t*        cr,
-                           gint            width,
-                           gint            height)
+draw_top_bottom_background(AwnBackground*         bg,
+                           AwnBackgroundGeometry* geom,
+                           GtkPositionType        position,
+                           cairo_t*               cr,
+                           gint                   width,
+                           gint                   height)
 {
     cairo_pattern_t* pat;
     gfloat   align = 0.5;
@@ -217,7 +246,8 @@ draw_top_bottom_background(AwnBackground*  bg,
     // performance as opposed to cairo_fill
     cairo_save(cr);
 
-    draw_rect(bg, cr, position, 1, 1, width - 3, height - 1, align, expand);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_FILL, cr, position,
+                     1, 1, width - 3, height - 1, align, expand);
     cairo_clip_preserve(cr);
     cairo_set_source(cr, pat);
     cairo_paint(cr);
@@ -242,12 +272,14 @@ paint_lines:
 
     /* Internal border */
     awn_cairo_set_source_color(cr, bg->hilight_color);
-    draw_rect(bg, cr, position, 1, 1, width - 3, height + 3, align, expand);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_INNER, cr, position,
+                     1, 1, width - 3, height + 3, align, expand);
     cairo_stroke(cr);
 
     /* External border */
     awn_cairo_set_source_color(cr, bg->border_color);
-    draw_rect(bg, cr, position, 0, 0, width - 1, height + 3, align, expand);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_OUTER, cr, position,
+                     0, 0, width - 1, height + 3, align, expand);
     cairo_stroke(cr);
 }
 
@@ -312,6 +344,9 @@ awn_background_flat_draw(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -340,7 +375,7 @@ awn_background_flat_draw(AwnBackground*  bg,
         break;
     }
 
-    draw_top_bottom_background(bg, position, cr, width, height);
+    draw_top_bottom_background(bg, geom, position, cr, width, height);
 
     cairo_restore(cr);
 }
@@ -356,7 +391,9 @@ awn_background_flat_get_shape_mask(AwnBackground*  bg,
     gint width = area->width, height = area->height;
     gfloat   align = 0.5;
     gboolean expand = FALSE;
+    AwnBackgroundGeometry* geom;
 
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     align = awn_background_get_panel_alignment(bg);
@@ -389,10 +426,26 @@ awn_background_flat_get_shape_mask(AwnBackground*  bg,
     }
     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     cairo_set_source_rgba(cr, 1., 1., 1., 1.);
-    draw_rect(bg, cr, position, 0, 0, width, height + 3, align, expand);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_SHAPE, cr, position,
+                     0, 0, width, height + 3, align, expand);
     cairo_fill(cr);
 
     cairo_restore(cr);
 }
 
+static gboolean
+awn_background_flat_get_slice_cap(AwnBackground* bg,
+                                  GtkPositionType position,
+                                  gint* cap)
+{
+    /* the pattern isn't anchored to the ends of the panel */
+    if (bg->enable_pattern && bg->pattern) {
+        return FALSE;
+    }
+
+    /* the corners and the borders which draw_rect() moves beyond the area */
+    *cap = ceil(bg->corner_radius) + 4;
+    return TRUE;
+}
+
 /* vim: set et ts=2 sts=2 sw=2 : */
@@ -47,6 +47,10 @@ static void awn_background_floaty_padding_request(AwnBackground* bg,
         guint* padding_left,
         guint* padding_right);
 
+static gboolean awn_background_floaty_get_slice_cap(AwnBackground* bg,
+        GtkPositionType position,
+        gint* cap);
+
 static void
 awn_background_floaty_expand_changed(AwnBackground* bg)  // has more params...
 {
@@ -93,6 +97,7 @@ awn_background_floaty_class_init(AwnBackgroundFloatyClass* klass)
     bg_class->padding_request = awn_background_floaty_padding_request;
     bg_class->get_shape_mask = awn_background_floaty_get_shape_mask;
     bg_class->get_input_shape_mask = awn_background_floaty_get_shape_mask;
+    bg_class->get_slice_cap = awn_background_floaty_get_slice_cap;
 }
 
 
@@ -133,12 +138,35 @@ draw_rect(AwnBackground*  bg,
     awn_cairo_rounded_rect(cr, x, y, width, height, bg->corner_radius, state);
 }
 
+/* replaces the current path with the cached one, builds it on a miss */
 static void
-draw_top_bottom_background(AwnBackground*  bg,
-                           GtkPositionType position,
-                           cairo_t*        cr,
-                           gint            width,
-                           gint            height)
+draw_rect_cached(AwnBackground*         bg,
+                 AwnBackgroundGeometry* geom,
+                 AwnBackgroundPathId    id,
+                 cairo_t*               cr,
+                 GtkPositionType        position,
+                 gdouble                x,
+                 gdouble                y,
+                 gint                   width,
+                 gint                   height,
+                 gboolean               round_all)
+{
+    if (awn_background_geometry_append_path(geom, id, cr)) {
+        return;
+    }
+
+    cairo_new_path(cr);
+    draw_rect(bg, cr, position, x, y, width, height, round_all);
+    awn_background_geometry_store_path(geom, id, cr);
+}
+
+static void
+draw_top_bottom_background(AwnBackground*         bg,
+                           AwnBackgroundGeometry* geom,
+                           GtkPositionType        position,
+                           cairo_t*               cr,
+                           gint                   width,
+                           gint                   height)
 {
     cairo_pattern_t* pat;
     gint bg_size;
@@ -177,7 +205,9 @@ draw_top_bottom_background(AwnBackground*  bg,
 
     cairo_save(cr);
 
-    draw_rect(bg, cr, position, 1, 1, width - 3, bg_size - 2, TRUE);
+    /* the fill has the same shape as the internal border */
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_INNER, cr, position,
+                     1, 1, width - 3, bg_size - 2, TRUE);
     cairo_clip_preserve(cr);
     cairo_set_source(cr, pat);
     cairo_paint(cr);
@@ -202,12 +232,14 @@ paint_lines:
 
     /* Internal border */
     awn_cairo_set_source_color(cr, bg->hilight_color);
-    draw_rect(bg, cr, position, 1, 1, width - 3, bg_size - 2, TRUE);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_INNER, cr, position,
+                     1, 1, width - 3, bg_size - 2, TRUE);
     cairo_stroke(cr);
 
     /* External border */
     awn_cairo_set_source_color(cr, bg->border_color);
-    draw_rect(bg, cr, position, 0, 0, width - 1, bg_size, TRUE);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_OUTER, cr, position,
+                     0, 0, width - 1, bg_size, TRUE);
     cairo_stroke(cr);
 }
 
@@ -272,6 +304,9 @@ awn_background_floaty_draw(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
+
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -298,7 +333,7 @@ awn_background_floaty_draw(AwnBackground*  bg,
         break;
     }
 
-    draw_top_bottom_background(bg, position, cr, width, height);
+    draw_top_bottom_background(bg, geom, position, cr, width, height);
 
     cairo_restore(cr);
 }
@@ -312,7 +347,9 @@ awn_background_floaty_get_shape_mask(AwnBackground*  bg,
     gint temp;
     gint x = area->x, y = area->y;
     gint width = area->width, height = area->height;
+    AwnBackgroundGeometry* geom;
 
+    geom = awn_background_lookup_geometry(bg, position, area);
     cairo_save(cr);
 
     switch (position) {
@@ -349,10 +386,26 @@ awn_background_floaty_get_shape_mask(AwnBackground*  bg,
         cairo_translate(cr, extra_space, 0.0);
         width -= 2 * extra_space;
     }
-    draw_rect(bg, cr, position, 0, 0, width, height - bg->floaty_offset + 2, TRUE);
+    draw_rect_cached(bg, geom, AWN_BACKGROUND_PATH_SHAPE, cr, position,
+                     0, 0, width, height - bg->floaty_offset + 2, TRUE);
     cairo_fill(cr);
 
     cairo_restore(cr);
 }
 
+static gboolean
+awn_background_floaty_get_slice_cap(AwnBackground* bg,
+                                    GtkPositionType position,
+                                    gint* cap)
+{
+    /* the pattern isn't anchored to the ends of the panel */
+    if (bg->enable_pattern && bg->pattern) {
+        return FALSE;
+    }
+
+    /* the corners, moved inwards by the extra space in expand mode */
+    *cap = ceil(bg->corner_radius) + bg->floaty_offset + 4;
+    return TRUE;
+}
+
 /* vim: set et ts=2 sts=2 sw=2 : */
@@ -47,6 +47,7 @@ struct _AwnBackgroundLucidoPrivate {
     gint      pos_size;
     guint     tid;
     gboolean  needs_animation;
+    gint      mask_sep_check;
 };
 
 #define TOP_PADDING 2
@@ -234,6 +235,7 @@ awn_background_lucido_init(AwnBackgroundLucido* bg)
     priv->tid = 0;
     priv->pos = g_array_new(FALSE, TRUE, sizeof(gfloat));
     priv->pos_size = 0;
+    priv->mask_sep_check = 0;
 }
 
 AwnBackground*
@@ -440,6 +442,7 @@ _create_path_lucido(AwnBackground*  bg,
     gfloat applet_manager_x = 0.;
     _get_applet_manager_size(bg, position, &applet_manager_x);
     gboolean needs_animation = FALSE;
+    gboolean moved = FALSE;
     gfloat x_start_limit = lroundf(x);
 
     /****************************************************************************/
@@ -451,7 +454,9 @@ _create_path_lucido(AwnBackground*  bg,
         priv->lastx = x;
     } else if (update_positions) {
         /* the start position is animated by the panel */
-        x = priv->lastx = MAX(x_start_limit, 0.);
+        x = MAX(x_start_limit, 0.);
+        moved = priv->lastx != x;
+        priv->lastx = x;
     } else {
         x = priv->lastx;
     }
@@ -539,6 +544,7 @@ _create_path_lucido(AwnBackground*  bg,
     /* w stores the "right corner", lastxend equals to last w */
     if (!composited || update_positions) {
         /* the width is animated by the panel */
+        moved |= priv->lastxend != w;
         priv->lastxend = w;
     } else {
         w = priv->lastxend;
@@ -589,6 +595,7 @@ _create_path_lucido(AwnBackground*  bg,
                 if (curx > (w - rdc - d)) {
                     curx = w - rdc - d;
                 }
+                moved |= curx != g_array_index(priv->pos, gfloat, j);
                 g_array_index(priv->pos, gfloat, j) = curx;
             }
             /* when drawing shape mask, use the final coord */
@@ -644,6 +651,10 @@ _create_path_lucido(AwnBackground*  bg,
     /********************     RESTART ANIMATION IF NEEDED  **********************/
     /****************************************************************************/
     if (update_positions) {
+        /* the cached shape mask paths use the positions */
+        if (moved) {
+            awn_background_invalidate_geometry(bg);
+        }
         if (needs_animation && composited) {
             _restart_timeout(bg, priv);
         } else {
@@ -913,6 +924,39 @@ _set_special_widget_width_and_transparent(AwnBackground* bg,
     g_list_free(widgets);
 }
 
+/*
+ * Weighted sum of the separators' positions, changes when any of them moves
+ */
+static gint
+_get_separators_checksum(AwnBackground* bg, GtkPositionType position)
+{
+    GList* widgets = _get_applet_widgets(bg);
+    GList* i = widgets;
+    GtkWidget* widget = NULL;
+    gint  wcheck = 0, j = 0;
+
+    for (; i; i = i->next) {
+        ++j;
+        widget = GTK_WIDGET(i->data);
+        if (!IS_SPECIAL(widget)) {
+            /* if not special continue */
+            continue;
+        }
+        switch (position) {
+        case GTK_POS_LEFT:
+        case GTK_POS_RIGHT:
+            wcheck += widget->allocation.y * j;
+            break;
+        default:
+            wcheck += widget->allocation.x * j;
+            break;
+        }
+    }
+    g_list_free(widgets);
+
+    return wcheck;
+}
+
 static void
 awn_background_lucido_get_shape_mask(AwnBackground*   bg,
                                      cairo_t*         cr,
@@ -926,6 +970,17 @@ awn_background_lucido_get_shape_mask(AwnBackground*   bg,
     g_object_get(bg->panel, "expand", &expand, NULL);
 
     gfloat align = awn_background_get_panel_alignment(AWN_BACKGROUND(bg));
+    AwnBackgroundLucidoPrivate* priv =
+        AWN_BACKGROUND_LUCIDO_GET_PRIVATE(AWN_BACKGROUND_LUCIDO(bg));
+    AwnBackgroundGeometry* geom;
+
+    /* the mask follows the final positions of the separators */
+    gint sep_check = _get_separators_checksum(bg, position);
+    if (priv->mask_sep_check != sep_check) {
+        priv->mask_sep_check = sep_check;
+        awn_background_invalidate_geometry(bg);
+    }
+    geom = awn_background_lookup_geometry(bg, position, area);
 
     cairo_save(cr);
 
@@ -963,17 +1018,22 @@ awn_background_lucido_get_shape_mask(AwnBackground*   bg,
 
     gboolean composited = awn_panel_get_composited(bg->panel);
     if (!composited) {
-        gfloat rad = TRANSFORM_RADIUS(bg->corner_radius);
-        if (expand) {
-            rad = 0.;
+        if (!awn_background_geometry_append_path(
+                    geom, AWN_BACKGROUND_PATH_SHAPE, cr)) {
+            gfloat rad = TRANSFORM_RADIUS(bg->corner_radius);
+            if (expand) {
+                rad = 0.;
+            }
+            cairo_new_path(cr);
+            gfloat lx = 0., ly = height;
+            cairo_move_to(cr, lx, ly);
+            _line_from_to(cr, &lx, &ly, lx + (align == 0. ? 0. : rad), 0);
+            _line_from_to(cr, &lx, &ly, width - (align == 1. ? 0. : rad), 0);
+            _line_from_to(cr, &lx, &ly, width, height);
+            cairo_close_path(cr);
+            awn_background_geometry_store_path(geom,
+                                               AWN_BACKGROUND_PATH_SHAPE, cr);
         }
-        cairo_new_path(cr);
-        gfloat lx = 0., ly = height;
-        cairo_move_to(cr, lx, ly);
-        _line_from_to(cr, &lx, &ly, lx + (align == 0. ? 0. : rad), 0);
-        _line_from_to(cr, &lx, &ly, width - (align == 1. ? 0. : rad), 0);
-        _line_from_to(cr, &lx, &ly, width, height);
-        cairo_close_path(cr);
     } else {
         cairo_set_line_width(cr, 1.0);
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
@@ -981,17 +1041,27 @@ awn_background_lucido_get_shape_mask(AwnBackground*   bg,
         cairo_translate(cr, -0.5, 0.5);
         width += 1.;
         /* create internal path */
-        _create_path_lucido(bg, position, cr, 0., 0., width, height,
-                            TRANSFORM_RADIUS(bg->corner_radius),
-                            TRANSFORM_RADIUS(bg->corner_radius),
-                            TRUE, expand, align, composited, FALSE, TRUE);
+        if (!awn_background_geometry_append_path(
+                    geom, AWN_BACKGROUND_PATH_STRIPE, cr)) {
+            _create_path_lucido(bg, position, cr, 0., 0., width, height,
+                                TRANSFORM_RADIUS(bg->corner_radius),
+                                TRANSFORM_RADIUS(bg->corner_radius),
+                                TRUE, expand, align, composited, FALSE, TRUE);
+            awn_background_geometry_store_path(geom,
+                                               AWN_BACKGROUND_PATH_STRIPE, cr);
+        }
         /* Draw the internal background */
         cairo_fill(cr);
         /* create external path */
-        _create_path_lucido(bg, position, cr, 0., 0., width, height,
-                            TRANSFORM_RADIUS(bg->corner_radius),
-                            TRANSFORM_RADIUS(bg->corner_radius),
-                            FALSE, expand, align, composited, FALSE, TRUE);
+        if (!awn_background_geometry_append_path(
+                    geom, AWN_BACKGROUND_PATH_OUTER, cr)) {
+            _create_path_lucido(bg, position, cr, 0., 0., width, height,
+                                TRANSFORM_RADIUS(bg->corner_radius),
+                                TRANSFORM_RADIUS(bg->corner_radius),
+                                FALSE, expand, align, composited, FALSE, TRUE);
+            awn_background_geometry_store_path(geom,
+                                               AWN_BACKGROUND_PATH_OUTER, cr);
+        }
 
         /* Draw the external background */
         cairo_fill(cr);
@@ -1020,29 +1090,7 @@ awn_background_lucido_get_needs_redraw(AwnBackground* bg,
     /* Check separators positions,
      * because bar's width doesn't change in expanded mode
      */
-    GList* widgets = _get_applet_widgets(bg);
-    GList* i = widgets;
-    GtkWidget* widget = NULL;
-    gint  wcheck = 0, j = 0;
-
-    for (; i; i = i->next) {
-        ++j;
-        widget = GTK_WIDGET(i->data);
-        if (!IS_SPECIAL(widget)) {
-            /* if not special continue */
-            continue;
-        }
-        switch (position) {
-        case GTK_POS_LEFT:
-        case GTK_POS_RIGHT:
-            wcheck += widget->allocation.y * j;
-            break;
-        default:
-            wcheck += widget->allocation.x * j;
-            break;
-        }
-    }
-    g_list_free(widgets);
+    gint wcheck = _get_separators_checksum(bg, position);
     AwnBackgroundLucidoPrivate* priv =
         AWN_BACKGROUND_LUCIDO_GET_PRIVATE(AWN_BACKGROUND_LUCIDO(bg));
     if (priv->expw != wcheck) {
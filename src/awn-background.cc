@@ -29,6 +29,7 @@
 #include "awn-defines.h"
 #include "libawn/gseal-transition.h"
 #include "libawn/awn-effects-ops-helpers.h"
+#include "libawn/awn-stats.h"
 
 extern "C" {
     G_DEFINE_ABSTRACT_TYPE(AwnBackground, awn_background, G_TYPE_OBJECT)
@@ -106,6 +107,8 @@ static gboolean awn_background_get_needs_redraw(AwnBackground* bg,
 static AwnPathType awn_background_path_default(AwnBackground* bg,
         gfloat* offset_mod);
 
+static void awn_background_geometry_clear(AwnBackgroundGeometry* geom);
+
 static void
 awn_background_constructed(GObject* object)
 {
@@ -372,6 +375,7 @@ awn_background_set_property(GObject*      object,
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         return;
     }
+    bg->style_serial++;
     awn_background_invalidate(bg);
     g_signal_emit(object, _bg_signals[CHANGED], 0);
 }
@@ -426,6 +430,18 @@ awn_background_finalize(GObject* object)
         cairo_surface_destroy(bg->helper_surface);
     }
 
+    if (bg->geometry) {
+        awn_background_geometry_clear(bg->geometry);
+        g_slice_free(AwnBackgroundGeometry, bg->geometry);
+    }
+
+    if (bg->slices) {
+        if (bg->slices->tile) {
+            cairo_surface_destroy(bg->slices->tile);
+        }
+        g_slice_free(AwnBackgroundSlices, bg->slices);
+    }
+
     G_OBJECT_CLASS(awn_background_parent_class)->finalize(object);
 }
 
@@ -446,6 +462,7 @@ awn_background_class_init(AwnBackgroundClass* klass)
     klass->get_strut_offsets    = NULL;
     klass->draw                 = awn_background_draw_none;
     klass->get_needs_redraw     = awn_background_get_needs_redraw;
+    klass->get_slice_cap        = NULL;
 
     /* Object properties */
     g_object_class_install_property(obj_class,
@@ -714,6 +731,10 @@ awn_background_init(AwnBackground* bg)
     bg->helper_surface = NULL;
     bg->cache_enabled = TRUE;
     bg->draw_glow = FALSE;
+    bg->geometry = NULL;
+    bg->geometry_serial = 0;
+    bg->slices = NULL;
+    bg->style_serial = 0;
 }
 
 static void
@@ -775,6 +796,205 @@ awn_background_draw_glow(AwnBackground* bg, cairo_t* cr,
     cairo_restore(cr);
 }
 
+/*
+ * Sliced drawing
+ *
+ * Panel length changes all the time (task manager, resize animation), but
+ * for most backgrounds only the ends of the panel depend on it. Those are
+ * rendered once into a tile containing both caps and a short middle strip,
+ * any length is then assembled from the caps and the stretched strip.
+ */
+
+/* how far beyond the area the draw vfuncs may paint */
+#define SLICE_MARGIN 4
+/* length of the middle strip in the tile */
+#define SLICE_STRIP 2
+
+struct _AwnBackgroundSlices {
+    cairo_surface_t* tile;
+
+    /* everything the tile depends on except the length */
+    GtkPositionType  position;
+    gint             offset;
+    gint             thickness;
+    gint             full_thickness;
+    gint             cap;
+    gboolean         composited;
+    guint            style_serial;
+};
+
+static void
+awn_background_blit_slice(cairo_t* cr, cairo_surface_t* tile,
+                          gboolean vertical, gint src, gint dest,
+                          gint length, gint thickness)
+{
+    if (vertical) {
+        cairo_set_source_surface(cr, tile, 0, dest - src);
+        cairo_rectangle(cr, 0, dest, thickness, length);
+    } else {
+        cairo_set_source_surface(cr, tile, dest - src, 0);
+        cairo_rectangle(cr, dest, 0, length, thickness);
+    }
+    cairo_fill(cr);
+}
+
+/**
+ * awn_background_get_slice_cap:
+ * @bg: The #AwnBackground.
+ * @position: The position of the panel.
+ * @cap: Return location for the length of the ends.
+ *
+ * Returns: %TRUE if the background looks the same along the panel except
+ * for @cap pixels at either end, so a length change only changes what's
+ * drawn near the ends.
+ */
+gboolean
+awn_background_get_slice_cap(AwnBackground* bg,
+                             GtkPositionType position,
+                             gint* cap)
+{
+    AwnBackgroundClass* klass;
+
+    g_return_val_if_fail(AWN_IS_BACKGROUND(bg), FALSE);
+
+    klass = AWN_BACKGROUND_GET_CLASS(bg);
+
+    return klass->get_slice_cap != NULL &&
+           klass->get_slice_cap(bg, position, cap);
+}
+
+static gboolean
+awn_background_draw_sliced(AwnBackground*  bg,
+                           cairo_t*        cr,
+                           GtkPositionType position,
+                           GdkRectangle*   area,
+                           gint            full_width,
+                           gint            full_height)
+{
+    AwnBackgroundSlices* slices;
+    gboolean vertical = position == GTK_POS_LEFT || position == GTK_POS_RIGHT;
+    gboolean composited;
+    gint cap = 0;
+    gint start, length, tile_length, offset, thickness, full_thickness;
+
+    if (!awn_background_get_slice_cap(bg, position, &cap)) {
+        return FALSE;
+    }
+
+    start = vertical ? area->y : area->x;
+    length = vertical ? area->height : area->width;
+    offset = vertical ? area->x : area->y;
+    thickness = vertical ? area->width : area->height;
+    full_thickness = vertical ? full_width : full_height;
+    tile_length = 2 * cap + SLICE_STRIP;
+
+    if (length < tile_length) {
+        return FALSE;
+    }
+
+    composited = awn_panel_get_composited(bg->panel);
+
+    slices = bg->slices;
+    if (slices == NULL) {
+        slices = bg->slices = g_slice_new0(AwnBackgroundSlices);
+    }
+
+    if (slices->tile == NULL || slices->position != position ||
+            slices->offset != offset || slices->thickness != thickness ||
+            slices->full_thickness != full_thickness ||
+            slices->cap != cap || slices->composited != composited ||
+            slices->style_serial != bg->style_serial) {
+        GdkRectangle tile_area;
+        cairo_t* tile_cr;
+
+        if (slices->tile) {
+            cairo_surface_destroy(slices->tile);
+        }
+
+        if (vertical) {
+            slices->tile = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                           full_thickness, tile_length + 2 * SLICE_MARGIN);
+            tile_area.x = area->x;
+            tile_area.y = SLICE_MARGIN;
+            tile_area.width = area->width;
+            tile_area.height = tile_length;
+        } else {
+            slices->tile = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                           tile_length + 2 * SLICE_MARGIN, full_thickness);
+            tile_area.x = SLICE_MARGIN;
+            tile_area.y = area->y;
+            tile_area.width = tile_length;
+            tile_area.height = area->height;
+        }
+
+        tile_cr = cairo_create(slices->tile);
+        AWN_BACKGROUND_GET_CLASS(bg)->draw(bg, tile_cr, position, &tile_area);
+        cairo_destroy(tile_cr);
+
+        slices->position = position;
+        slices->offset = offset;
+        slices->thickness = thickness;
+        slices->full_thickness = full_thickness;
+        slices->cap = cap;
+        slices->composited = composited;
+        slices->style_serial = bg->style_serial;
+
+        AWN_STATS_COUNT(AWN_STATS_BACKGROUND_TILE_RENDER);
+    }
+
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+
+    /* start cap, together with whatever is painted before the area */
+    awn_background_blit_slice(cr, slices->tile, vertical,
+                              0, start - SLICE_MARGIN,
+                              SLICE_MARGIN + cap, full_thickness);
+    /* end cap */
+    awn_background_blit_slice(cr, slices->tile, vertical,
+                              SLICE_MARGIN + tile_length - cap,
+                              start + length - cap,
+                              cap + SLICE_MARGIN, full_thickness);
+
+    /* the first column (row) of the middle strip stretched over the rest */
+    if (vertical) {
+        cairo_translate(cr, 0, start + cap);
+        cairo_scale(cr, 1, length - 2 * cap);
+        cairo_set_source_surface(cr, slices->tile, 0, -(SLICE_MARGIN + cap));
+        cairo_rectangle(cr, 0, 0, full_thickness, 1);
+    } else {
+        cairo_translate(cr, start + cap, 0);
+        cairo_scale(cr, length - 2 * cap, 1);
+        cairo_set_source_surface(cr, slices->tile, -(SLICE_MARGIN + cap), 0);
+        cairo_rectangle(cr, 0, 0, 1, full_thickness);
+    }
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+    cairo_fill(cr);
+
+    cairo_restore(cr);
+
+    AWN_STATS_COUNT(AWN_STATS_BACKGROUND_TILE_BLIT);
+
+    return TRUE;
+}
+
+static void
+awn_background_render(AwnBackground*  bg,
+                      cairo_t*        cr,
+                      GtkPositionType  position,
+                      GdkRectangle*   area,
+                      gint            full_width,
+                      gint            full_height,
+                      gint            rad)
+{
+    if (!awn_background_draw_sliced(bg, cr, position, area,
+                                    full_width, full_height)) {
+        AWN_BACKGROUND_GET_CLASS(bg)->draw(bg, cr, position, area);
+    }
+    if (bg->draw_glow && awn_panel_get_composited(bg->panel)) {
+        awn_background_draw_glow(bg, cr, area, rad, position);
+    }
+}
+
 void
 awn_background_draw(AwnBackground*  bg,
                     cairo_t*        cr,
@@ -820,10 +1040,9 @@ awn_background_draw(AwnBackground*  bg,
                 cairo_set_operator(temp_cr, CAIRO_OPERATOR_OVER);
             }
             /* Draw background on temp cairo_t */
-            klass->draw(bg, temp_cr, position, area);
-            if (bg->draw_glow && awn_panel_get_composited(bg->panel)) {
-                awn_background_draw_glow(bg, temp_cr, area, rad, position);
-            }
+            AWN_STATS_TIME(AWN_STATS_BACKGROUND_DRAW,
+                           awn_background_render(bg, temp_cr, position, area,
+                                                 full_width, full_height, rad));
             cairo_destroy(temp_cr);
         }
         /* Paint saved surface */
@@ -831,7 +1050,8 @@ awn_background_draw(AwnBackground*  bg,
         cairo_paint(cr);
         cairo_restore(cr);
     } else {
-        klass->draw(bg, cr, position, area);
+        AWN_STATS_TIME(AWN_STATS_BACKGROUND_DRAW,
+                       klass->draw(bg, cr, position, area));
     }
 }
 
@@ -930,6 +1150,7 @@ void
 awn_background_emit_padding_changed(AwnBackground* bg)
 {
     g_return_if_fail(AWN_IS_BACKGROUND(bg));
+    bg->style_serial++;
     awn_background_invalidate(bg);
     g_signal_emit(bg, _bg_signals[PADDING_CHANGED], 0);
 }
@@ -938,6 +1159,7 @@ void
 awn_background_emit_changed(AwnBackground* bg)
 {
     g_return_if_fail(AWN_IS_BACKGROUND(bg));
+    bg->style_serial++;
     awn_background_invalidate(bg);
     g_signal_emit(bg, _bg_signals[CHANGED], 0);
 }
@@ -1107,6 +1329,7 @@ static void
 on_style_set(GtkWidget* widget, GtkStyle* old, AwnBackground* bg)
 {
     update_widget_colors(widget, bg);
+    bg->style_serial++;
     awn_background_invalidate(bg);
 }
 
@@ -1212,6 +1435,168 @@ static gboolean awn_background_get_needs_redraw(AwnBackground* bg,
 void awn_background_invalidate(AwnBackground*  bg)
 {
     bg->needs_redraw = 1;
+    awn_background_invalidate_geometry(bg);
+}
+
+/*
+ * Geometry cache
+ */
+static void
+awn_background_geometry_clear(AwnBackgroundGeometry* geom)
+{
+    gint i;
+
+    for (i = 0; i < AWN_BACKGROUND_PATH_LAST; i++) {
+        if (geom->paths[i]) {
+            cairo_path_destroy(geom->paths[i]);
+            geom->paths[i] = NULL;
+        }
+    }
+
+    if (geom->data && geom->data_destroy) {
+        geom->data_destroy(geom->data);
+    }
+    geom->data = NULL;
+    geom->data_destroy = NULL;
+}
+
+/**
+ * awn_background_invalidate_geometry:
+ * @bg: The background.
+ *
+ * Marks the cached geometry as stale, it will be rebuilt the next time
+ * a draw or shape mask vfunc asks for it. Called by
+ * awn_background_invalidate(), backends need to call it directly only if
+ * their layout changes without a redraw being requested.
+ */
+void
+awn_background_invalidate_geometry(AwnBackground* bg)
+{
+    bg->geometry_serial++;
+}
+
+/**
+ * awn_background_lookup_geometry:
+ * @bg: The background.
+ * @position: Position passed to the vfunc.
+ * @area: Area passed to the vfunc.
+ *
+ * Returns the geometry cache for @position and @area. If either of them
+ * differs from the previous lookup or the background was invalidated since,
+ * all cached paths are dropped first.
+ *
+ * Returns: The geometry, owned by @bg.
+ */
+AwnBackgroundGeometry*
+awn_background_lookup_geometry(AwnBackground* bg,
+                               GtkPositionType position,
+                               GdkRectangle* area)
+{
+    AwnBackgroundGeometry* geom;
+
+    g_return_val_if_fail(AWN_IS_BACKGROUND(bg) && area, NULL);
+
+    geom = bg->geometry;
+    if (geom == NULL) {
+        geom = bg->geometry = g_slice_new0(AwnBackgroundGeometry);
+        geom->serial = bg->geometry_serial - 1;
+    }
+
+    if (geom->serial != bg->geometry_serial || geom->position != position ||
+            geom->area.x != area->x || geom->area.y != area->y ||
+            geom->area.width != area->width ||
+            geom->area.height != area->height) {
+        awn_background_geometry_clear(geom);
+        geom->serial = bg->geometry_serial;
+        geom->position = position;
+        geom->area = *area;
+        AWN_STATS_COUNT(AWN_STATS_BACKGROUND_GEOMETRY);
+    }
+
+    return geom;
+}
+
+/**
+ * awn_background_geometry_append_path:
+ * @geom: The geometry.
+ * @id: Slot of the path.
+ * @cr: Context the path is replayed on.
+ *
+ * Replaces the current path of @cr with the cached one. The path is
+ * interpreted in the current user space of @cr, which has to be the same
+ * as when it was stored.
+ *
+ * Returns: FALSE if there is no such path cached, the path of @cr isn't
+ * touched in that case.
+ */
+gboolean
+awn_background_geometry_append_path(AwnBackgroundGeometry* geom,
+                                    AwnBackgroundPathId id,
+                                    cairo_t* cr)
+{
+    g_return_val_if_fail(geom && id < AWN_BACKGROUND_PATH_LAST, FALSE);
+
+    if (geom->paths[id] == NULL) {
+        return FALSE;
+    }
+
+    cairo_new_path(cr);
+    cairo_append_path(cr, geom->paths[id]);
+
+    return TRUE;
+}
+
+/**
+ * awn_background_geometry_store_path:
+ * @geom: The geometry.
+ * @id: Slot of the path.
+ * @cr: Context with the path built.
+ *
+ * Caches the current path of @cr (in its current user space). The path of
+ * @cr is left intact.
+ */
+void
+awn_background_geometry_store_path(AwnBackgroundGeometry* geom,
+                                   AwnBackgroundPathId id,
+                                   cairo_t* cr)
+{
+    cairo_path_t* path;
+
+    g_return_if_fail(geom && id < AWN_BACKGROUND_PATH_LAST);
+
+    path = cairo_copy_path(cr);
+    if (path->status != CAIRO_STATUS_SUCCESS) {
+        cairo_path_destroy(path);
+        return;
+    }
+
+    if (geom->paths[id]) {
+        cairo_path_destroy(geom->paths[id]);
+    }
+    geom->paths[id] = path;
+}
+
+/**
+ * awn_background_geometry_set_data:
+ * @geom: The geometry.
+ * @data: Backend specific data.
+ * @data_destroy: Function to free @data with.
+ *
+ * Attaches data computed together with the paths (for example projected
+ * vertices), it is freed when the geometry gets invalidated.
+ */
+void
+awn_background_geometry_set_data(AwnBackgroundGeometry* geom,
+                                 gpointer data,
+                                 GDestroyNotify data_destroy)
+{
+    g_return_if_fail(geom);
+
+    if (geom->data && geom->data_destroy) {
+        geom->data_destroy(geom->data);
+    }
+    geom->data = data;
+    geom->data_destroy = data_destroy;
 }
 
 /* vim: set et ts=2 sts=2 sw=2 : */
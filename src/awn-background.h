@@ -53,6 +53,37 @@ extern "C" {
 
 typedef struct _AwnBackground AwnBackground;
 typedef struct _AwnBackgroundClass AwnBackgroundClass;
+typedef struct _AwnBackgroundGeometry AwnBackgroundGeometry;
+typedef struct _AwnBackgroundSlices AwnBackgroundSlices;
+
+/* Slots of the geometry cache, backends use them as they see fit */
+typedef enum {
+    AWN_BACKGROUND_PATH_OUTER,
+    AWN_BACKGROUND_PATH_INNER,
+    AWN_BACKGROUND_PATH_FILL,
+    AWN_BACKGROUND_PATH_STRIPE,
+    AWN_BACKGROUND_PATH_SHAPE,
+
+    AWN_BACKGROUND_PATH_LAST
+} AwnBackgroundPathId;
+
+/*
+ * Geometry shared by the draw and shape mask vfuncs. It's valid for one
+ * position and area and gets cleared whenever the background is invalidated,
+ * so each path is built only once per layout change. The paths are stored
+ * in the user space of the context they were built on.
+ */
+struct _AwnBackgroundGeometry {
+    GtkPositionType position;
+    GdkRectangle    area;
+    guint           serial;
+
+    cairo_path_t*   paths[AWN_BACKGROUND_PATH_LAST];
+
+    /* backend specific data, freed with data_destroy on invalidation */
+    gpointer        data;
+    GDestroyNotify  data_destroy;
+};
 
 struct _AwnBackground {
     GObject  parent;
@@ -104,6 +135,12 @@ struct _AwnBackground {
 
     /* private */
     guint    changed;
+
+    AwnBackgroundGeometry* geometry;
+    guint                  geometry_serial;
+
+    AwnBackgroundSlices*   slices;
+    guint                  style_serial;
 };
 
 struct _AwnBackgroundClass {
@@ -145,6 +182,14 @@ struct _AwnBackgroundClass {
                                 GtkPositionType position,
                                 GdkRectangle* area);
 
+    /* Returns TRUE if the background looks the same along the panel except
+     * for @cap pixels at either end, it's then drawn from a pre-rendered
+     * tile whenever only the panel length changes.
+     */
+    gboolean(*get_slice_cap)(AwnBackground* bg,
+                             GtkPositionType position,
+                             gint* cap);
+
     /*< signals >*/
     void (*changed)(AwnBackground* bg);
     void (*padding_changed)(AwnBackground* bg);
@@ -195,6 +240,28 @@ void awn_background_emit_changed(AwnBackground* bg);
 gfloat awn_background_get_panel_alignment(AwnBackground* bg);
 gboolean awn_background_do_rtl_swap(AwnBackground* bg);
 
+gboolean awn_background_get_slice_cap(AwnBackground* bg,
+                                      GtkPositionType position,
+                                      gint* cap);
+
+void awn_background_invalidate_geometry(AwnBackground* bg);
+
+AwnBackgroundGeometry* awn_background_lookup_geometry(AwnBackground* bg,
+        GtkPositionType position,
+        GdkRectangle* area);
+
+gboolean awn_background_geometry_append_path(AwnBackgroundGeometry* geom,
+        AwnBackgroundPathId id,
+        cairo_t* cr);
+
+void awn_background_geometry_store_path(AwnBackgroundGeometry* geom,
+                                        AwnBackgroundPathId id,
+                                        cairo_t* cr);
+
+void awn_background_geometry_set_data(AwnBackgroundGeometry* geom,
+                                      gpointer data,
+                                      GDestroyNotify data_destroy);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
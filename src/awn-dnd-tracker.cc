@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#include <gdk/gdkx.h>
+#include <X11/Xlib.h>
+
+#include "awn-dnd-tracker.h"
+#include "xutils.h"
+
+struct _AwnDndTracker {
+    GtkWidget* toplevel;
+    GdkWindow* window;
+    gulong realize_id;
+    gulong unrealize_id;
+
+    AwnDndTrackerFunc func;
+    gpointer user_data;
+
+    // only used for gdk_drag_find_window_for_screen (and its window cache)
+    GdkDragContext* context;
+
+    // root coordinates where the current target is still valid
+    GdkRegion* region;
+    GdkWindow* target;
+    GdkDragProtocol protocol;
+
+    guint reset_id;
+    guint lookups;
+
+    Atom xdnd_enter;
+    Atom xdnd_position;
+    Atom xdnd_leave;
+    Atom xdnd_drop;
+};
+
+static void
+awn_dnd_tracker_set_target(AwnDndTracker* tracker,
+                           GdkWindow* target, GdkDragProtocol protocol)
+{
+    if (target == tracker->target && protocol == tracker->protocol) {
+        if (target) {
+            g_object_unref(target);
+        }
+        return;
+    }
+
+    if (tracker->target) {
+        g_object_unref(tracker->target);
+    }
+    tracker->target = target;
+    tracker->protocol = protocol;
+
+    tracker->func(tracker, target, protocol, tracker->user_data);
+}
+
+static void
+awn_dnd_tracker_forget_region(AwnDndTracker* tracker)
+{
+    if (tracker->region) {
+        gdk_region_destroy(tracker->region);
+        tracker->region = NULL;
+    }
+}
+
+static void
+awn_dnd_tracker_update(AwnDndTracker* tracker, gint x, gint y)
+{
+    GdkDisplay* display = gdk_drawable_get_display(tracker->window);
+    GdkWindow* target = NULL;
+    GdkDragProtocol protocol = GDK_DRAG_PROTO_NONE;
+
+    if (tracker->region && gdk_region_point_in(tracker->region, x, y)) {
+        // still above the same window
+        return;
+    }
+
+    tracker->lookups++;
+
+    awn_dnd_tracker_forget_region(tracker);
+    tracker->region =
+        xutils_get_window_region_at(display, x, y,
+                                    GDK_WINDOW_XID(tracker->window));
+
+    gdk_drag_find_window_for_screen(tracker->context, tracker->window,
+                                    gtk_widget_get_screen(tracker->toplevel),
+                                    x, y, &target, &protocol);
+
+    // don't proxy to ourselves (or to other windows of this process)
+    if (target && (protocol == GDK_DRAG_PROTO_NONE ||
+                   gdk_window_get_window_type(target) != GDK_WINDOW_FOREIGN)) {
+        g_object_unref(target);
+        target = NULL;
+    }
+
+    awn_dnd_tracker_set_target(tracker, target,
+                               target ? protocol : GDK_DRAG_PROTO_NONE);
+}
+
+static gboolean
+awn_dnd_tracker_reset(AwnDndTracker* tracker)
+{
+    tracker->reset_id = 0;
+
+    awn_dnd_tracker_forget_region(tracker);
+    awn_dnd_tracker_set_target(tracker, NULL, GDK_DRAG_PROTO_NONE);
+
+    return FALSE;
+}
+
+static GdkFilterReturn
+awn_dnd_tracker_filter(GdkXEvent* gdk_xevent, GdkEvent* event, gpointer data)
+{
+    AwnDndTracker* tracker = (AwnDndTracker*)data;
+    XEvent* xevent = (XEvent*)gdk_xevent;
+    Atom type;
+
+    if (xevent->type != ClientMessage) {
+        return GDK_FILTER_CONTINUE;
+    }
+
+    type = xevent->xclient.message_type;
+
+    if (type == tracker->xdnd_enter) {
+        // the windows might have moved since the last drag
+        awn_dnd_tracker_forget_region(tracker);
+    } else if (type == tracker->xdnd_position) {
+        if (tracker->reset_id) {
+            g_source_remove(tracker->reset_id);
+            tracker->reset_id = 0;
+        }
+        awn_dnd_tracker_update(tracker,
+                               (xevent->xclient.data.l[2] >> 16) & 0xffff,
+                               xevent->xclient.data.l[2] & 0xffff);
+    } else if (type == tracker->xdnd_leave || type == tracker->xdnd_drop) {
+        // GTK still needs to forward this message to the current target,
+        // so drop the target only after it's done
+        if (tracker->reset_id == 0) {
+            tracker->reset_id =
+                g_idle_add((GSourceFunc)awn_dnd_tracker_reset, tracker);
+        }
+    }
+
+    return GDK_FILTER_CONTINUE;
+}
+
+static void
+on_realize(GtkWidget* widget, AwnDndTracker* tracker)
+{
+    GdkDisplay* display = gtk_widget_get_display(widget);
+
+    tracker->window = gtk_widget_get_window(widget);
+    gdk_window_add_filter(tracker->window, awn_dnd_tracker_filter, tracker);
+
+    tracker->xdnd_enter =
+        gdk_x11_get_xatom_by_name_for_display(display, "XdndEnter");
+    tracker->xdnd_position =
+        gdk_x11_get_xatom_by_name_for_display(display, "XdndPosition");
+    tracker->xdnd_leave =
+        gdk_x11_get_xatom_by_name_for_display(display, "XdndLeave");
+    tracker->xdnd_drop =
+        gdk_x11_get_xatom_by_name_for_display(display, "XdndDrop");
+}
+
+static void
+on_unrealize(GtkWidget* widget, AwnDndTracker* tracker)
+{
+    if (tracker->window) {
+        gdk_window_remove_filter(tracker->window,
+                                 awn_dnd_tracker_filter, tracker);
+        tracker->window = NULL;
+    }
+    awn_dnd_tracker_forget_region(tracker);
+}
+
+AwnDndTracker*
+awn_dnd_tracker_new(GtkWidget* toplevel,
+                    AwnDndTrackerFunc func, gpointer user_data)
+{
+    AwnDndTracker* tracker;
+
+    g_return_val_if_fail(GTK_IS_WIDGET(toplevel), NULL);
+    g_return_val_if_fail(func != NULL, NULL);
+
+    tracker = g_new0(AwnDndTracker, 1);
+    tracker->toplevel = toplevel;
+    tracker->func = func;
+    tracker->user_data = user_data;
+    tracker->context = (GdkDragContext*)g_object_new(GDK_TYPE_DRAG_CONTEXT,
+                                                      NULL);
+
+    tracker->realize_id =
+        g_signal_connect(toplevel, "realize", G_CALLBACK(on_realize), tracker);
+    tracker->unrealize_id =
+        g_signal_connect(toplevel, "unrealize",
+                         G_CALLBACK(on_unrealize), tracker);
+
+    if (gtk_widget_get_realized(toplevel)) {
+        on_realize(toplevel, tracker);
+    }
+
+    return tracker;
+}
+
+void
+awn_dnd_tracker_free(AwnDndTracker* tracker)
+{
+    g_return_if_fail(tracker != NULL);
+
+    on_unrealize(tracker->toplevel, tracker);
+    g_signal_handler_disconnect(tracker->toplevel, tracker->realize_id);
+    g_signal_handler_disconnect(tracker->toplevel, tracker->unrealize_id);
+
+    if (tracker->reset_id) {
+        g_source_remove(tracker->reset_id);
+    }
+    if (tracker->target) {
+        g_object_unref(tracker->target);
+    }
+    g_object_unref(tracker->context);
+
+    g_free(tracker);
+}
+
+guint
+awn_dnd_tracker_get_lookups(AwnDndTracker* tracker)
+{
+    g_return_val_if_fail(tracker != NULL, 0);
+
+    return tracker->lookups;
+}
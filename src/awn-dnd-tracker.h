@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/* awn-dnd-tracker.h
+ *
+ * Follows XDND drags over a toplevel by watching the XdndPosition messages
+ * the drag source sends to it, and reports which window below the toplevel
+ * would accept the drop. The window stack is only looked at when the
+ * pointer leaves the area covered by the window found last time.
+ */
+
+#ifndef _AWN_DND_TRACKER_H
+#define _AWN_DND_TRACKER_H
+
+#include <gtk/gtk.h>
+
+typedef struct _AwnDndTracker AwnDndTracker;
+
+/* @target is NULL when there's no XDND aware window under the pointer (or
+ * the drag left the toplevel), the tracker keeps its own reference. */
+typedef void (*AwnDndTrackerFunc)(AwnDndTracker*   tracker,
+                                  GdkWindow*       target,
+                                  GdkDragProtocol  protocol,
+                                  gpointer         user_data);
+
+AwnDndTracker*
+awn_dnd_tracker_new(GtkWidget* toplevel,
+                    AwnDndTrackerFunc func, gpointer user_data);
+
+void
+awn_dnd_tracker_free(AwnDndTracker* tracker);
+
+/* number of times the window stack was searched, for the tests */
+guint
+awn_dnd_tracker_get_lookups(AwnDndTracker* tracker);
+
+#endif
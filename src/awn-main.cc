@@ -33,6 +33,8 @@
 
 #include <libdesktop-agnostic/vfs.h>
 
+#include "libawn/awn-stats.h"
+
 #include "awn-app.h"
 #include "awn-defines.h"
 
@@ -143,6 +145,8 @@ main(gint argc, gchar* argv[])
         return EXIT_SUCCESS;
     }
 
+    awn_stats_export(connection, "avant-window-navigator");
+
     /* Set localization stuff */
     bindtextdomain(GETTEXT_PACKAGE, LOCALEDIR);
     textdomain(GETTEXT_PACKAGE);
@@ -53,6 +53,10 @@ struct _AwnPanelDBusInterfaceDBusProxy {
 
 struct AwnPanelDispatcherPrivate {
     AwnPanel* _panel;
+    /* property changes waiting for the next PropertiesChanged batch */
+    GHashTable* pending_props;
+    guint flush_id;
+    guint properties_generation;
 };
 
 
@@ -61,6 +65,7 @@ static AwnPanelDBusInterfaceIface* awn_panel_dispatcher_awn_panel_dbus_interface
 
 static gchar* _vala_array_dup1(gchar* self, int length);
 static void g_cclosure_user_marshal_VOID__STRING_BOXED(GClosure* closure, GValue* return_value, guint n_param_values, const GValue* param_values, gpointer invocation_hint, gpointer marshal_data);
+static void g_cclosure_user_marshal_VOID__UINT_BOXED(GClosure* closure, GValue* return_value, guint n_param_values, const GValue* param_values, gpointer invocation_hint, gpointer marshal_data);
 static void _vala_dbus_register_object(DBusConnection* connection, const char* path, void* object);
 static void _vala_dbus_unregister_object(gpointer connection, GObject* object);
 void awn_panel_dbus_interface_dbus_register_object(DBusConnection* connection, const char* path, void* object);
@@ -82,6 +87,7 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_set_glow(AwnPanelDBusInt
 static void _dbus_awn_panel_dbus_interface_destroy_applet(GObject* _sender, const gchar* uid, DBusConnection* _connection);
 static void _dbus_awn_panel_dbus_interface_destroy_notify(GObject* _sender, DBusConnection* _connection);
 static void _dbus_awn_panel_dbus_interface_property_changed(GObject* _sender, const gchar* prop_name, GValue* value, DBusConnection* _connection);
+static void _dbus_awn_panel_dbus_interface_properties_changed(GObject* _sender, guint generation, GHashTable* props, DBusConnection* _connection);
 extern "C" GType awn_panel_dbus_interface_dbus_proxy_get_type(void) G_GNUC_CONST;
 static void _dbus_handle_awn_panel_dbus_interface_destroy_applet(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static void _dbus_handle_awn_panel_dbus_interface_destroy_notify(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
@@ -109,6 +115,7 @@ static void awn_panel_dbus_interface_dbus_proxy_set_position(AwnPanelDBusInterfa
 static gint awn_panel_dbus_interface_dbus_proxy_get_size(AwnPanelDBusInterface* self);
 static void awn_panel_dbus_interface_dbus_proxy_set_size(AwnPanelDBusInterface* self, gint value);
 static gint64 awn_panel_dbus_interface_dbus_proxy_get_panel_xid(AwnPanelDBusInterface* self);
+static guint awn_panel_dbus_interface_dbus_proxy_get_properties_generation(AwnPanelDBusInterface* self);
 static void awn_panel_dbus_interface_dbus_proxy_awn_panel_dbus_interface__interface_init(AwnPanelDBusInterfaceIface* iface);
 static void _vala_awn_panel_dbus_interface_dbus_proxy_get_property(GObject* object, guint property_id, GValue* value, GParamSpec* pspec);
 static void _vala_awn_panel_dbus_interface_dbus_proxy_set_property(GObject* object, guint property_id, const GValue* value, GParamSpec* pspec);
@@ -125,6 +132,9 @@ static void _lambda2_(AwnPanel* p, gint o, AwnPanelDispatcher* self);
 static void __lambda2__awn_panel_offset_changed(AwnPanel* _sender, gint offset, gpointer self);
 static void _lambda3_(AwnPanel* p, const gchar* pn, GValue* v, AwnPanelDispatcher* self);
 static void __lambda3__awn_panel_property_changed(AwnPanel* _sender, const gchar* prop_name, GValue* val, gpointer self);
+static void awn_panel_dispatcher_queue_property(AwnPanelDispatcher* self, const gchar* prop_name, GValue* value, gpointer data);
+static gboolean awn_panel_dispatcher_flush_properties(gpointer data);
+static void awn_panel_dispatcher_free_value(gpointer data);
 static void awn_panel_dispatcher_real_add_applet(AwnPanelDBusInterface* base, const gchar* desktop_file, GError** error);
 AwnPanel* awn_panel_dispatcher_get_panel(AwnPanelDispatcher* self);
 static void awn_panel_dispatcher_real_delete_applet(AwnPanelDBusInterface* base, const gchar* uid, GError** error);
@@ -270,6 +280,12 @@ gint64 awn_panel_dbus_interface_get_panel_xid(AwnPanelDBusInterface* self)
 }
 
 
+guint awn_panel_dbus_interface_get_properties_generation(AwnPanelDBusInterface* self)
+{
+    return AWN_PANEL_DBUS_INTERFACE_GET_INTERFACE(self)->get_properties_generation(self);
+}
+
+
 static void g_cclosure_user_marshal_VOID__STRING_BOXED(
         GClosure* closure, GValue* return_value, guint n_param_values,
         const GValue* param_values, gpointer invocation_hint,
@@ -293,6 +309,29 @@ static void g_cclosure_user_marshal_VOID__STRING_BOXED(
 }
 
 
+static void g_cclosure_user_marshal_VOID__UINT_BOXED(
+        GClosure* closure, GValue* return_value, guint n_param_values,
+        const GValue* param_values, gpointer invocation_hint,
+        gpointer marshal_data)
+{
+    typedef void (*GMarshalFunc_VOID__UINT_BOXED)(gpointer data1, guint arg_1, gpointer arg_2, gpointer data2);
+    GMarshalFunc_VOID__UINT_BOXED callback;
+    void* data1;
+    void* data2;
+    GCClosure* cc = (GCClosure*) closure;
+    g_return_if_fail(n_param_values == 3);
+    if (G_CCLOSURE_SWAP_DATA(closure)) {
+        data1 = closure->data;
+        data2 = param_values->data[0].v_pointer;
+    } else {
+        data1 = param_values->data[0].v_pointer;
+        data2 = closure->data;
+    }
+    callback = (GMarshalFunc_VOID__UINT_BOXED)(marshal_data ? marshal_data : cc->callback);
+    callback(data1, g_value_get_uint(param_values + 1), g_value_get_boxed(param_values + 2), data2);
+}
+
+
 static void awn_panel_dbus_interface_base_init(AwnPanelDBusInterfaceIface* iface)
 {
     static bool initialized = false;
@@ -301,6 +340,7 @@ static void awn_panel_dbus_interface_base_init(AwnPanelDBusInterfaceIface* iface
         g_signal_new("destroy_applet", AWN_TYPE_PANEL_DBUS_INTERFACE, G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_VOID__STRING, G_TYPE_NONE, 1, G_TYPE_STRING);
         g_signal_new("destroy_notify", AWN_TYPE_PANEL_DBUS_INTERFACE, G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
         g_signal_new("property_changed", AWN_TYPE_PANEL_DBUS_INTERFACE, G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_user_marshal_VOID__STRING_BOXED, G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_VALUE);
+        g_signal_new("properties_changed", AWN_TYPE_PANEL_DBUS_INTERFACE, G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_user_marshal_VOID__UINT_BOXED, G_TYPE_NONE, 2, G_TYPE_UINT, G_TYPE_HASH_TABLE);
     }
 }
 
@@ -338,7 +378,7 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_introspect(AwnPanelDBusI
     dbus_message_iter_init_append(reply, &iter);
 
     std::string xml_data{"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"};
-    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
+    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <property name=\"PropertiesGeneration\" type=\"u\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n  <signal name=\"PropertiesChanged\">\n    <arg name=\"generation\" type=\"u\"/>\n    <arg name=\"props\" type=\"a{sv}\"/>\n  </signal>\n</interface>\n";
     dbus_connection_list_registered(connection, g_object_get_data((GObject*) self, "dbus_object_path"), &children);
     for (int i = 0; children[i]; i++) {
         xml_data = xml_data + "<node name=\"" + children[i] + "\"/>\n";
@@ -415,6 +455,12 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_property_get(AwnPanelDBu
         awn::vala_dbus_iter_append_int64(&subiter,
                                          awn_panel_dbus_interface_get_panel_xid(self));
         dbus_message_iter_close_container(&reply_iter, &subiter);
+
+    } else if ((strcmp(interface_name, "org.awnproject.Awn.Panel") == 0) && (strcmp(property_name, "PropertiesGeneration") == 0)) {
+        dbus_message_iter_open_container(&reply_iter, DBUS_TYPE_VARIANT, "u", &subiter);
+        awn::vala_dbus_iter_append_uint32(&subiter,
+                                          awn_panel_dbus_interface_get_properties_generation(self));
+        dbus_message_iter_close_container(&reply_iter, &subiter);
     } else {
         dbus_message_unref(reply);
         reply = NULL;
@@ -566,6 +612,15 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_property_get_all(AwnPane
             dbus_message_iter_close_container(&entry_iter, &value_iter);
             dbus_message_iter_close_container(&subiter, &entry_iter);
         }
+        {
+            dbus_message_iter_open_container(&subiter, DBUS_TYPE_DICT_ENTRY, NULL, &entry_iter);
+            awn::vala_dbus_iter_append_string(&entry_iter, "PropertiesGeneration");
+            dbus_message_iter_open_container(&entry_iter, DBUS_TYPE_VARIANT, "u", &value_iter);
+            awn::vala_dbus_iter_append_uint32(&value_iter,
+                                              awn_panel_dbus_interface_get_properties_generation(self));
+            dbus_message_iter_close_container(&entry_iter, &value_iter);
+            dbus_message_iter_close_container(&subiter, &entry_iter);
+        }
         dbus_message_iter_close_container(&reply_iter, &subiter);
     } else {
         dbus_message_unref(reply);
@@ -971,6 +1026,29 @@ static void _dbus_awn_panel_dbus_interface_property_changed(GObject* _sender, co
 }
 
 
+static void _dbus_awn_panel_dbus_interface_properties_changed(GObject* _sender, guint generation, GHashTable* props, DBusConnection* _connection)
+{
+    const char* _path = g_object_get_data(_sender, "dbus_object_path");
+    DBusMessage* msg = dbus_message_new_signal(_path, "org.awnproject.Awn.Panel", "PropertiesChanged");
+
+    DBusMessageIter iter, array_iter, entry_iter;
+    GHashTableIter props_iter;
+    gpointer key, value;
+    dbus_message_iter_init_append(msg, &iter);
+    awn::vala_dbus_iter_append_uint32(&iter, generation);
+    dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &array_iter);
+    g_hash_table_iter_init(&props_iter, props);
+    while (g_hash_table_iter_next(&props_iter, &key, &value)) {
+        dbus_message_iter_open_container(&array_iter, DBUS_TYPE_DICT_ENTRY, NULL, &entry_iter);
+        awn::vala_dbus_append_gvalue(&entry_iter, (const char*) key, (GValue*) value);
+        dbus_message_iter_close_container(&array_iter, &entry_iter);
+    }
+    dbus_message_iter_close_container(&iter, &array_iter);
+    dbus_connection_send(_connection, msg, NULL);
+    dbus_message_unref(msg);
+}
+
+
 void awn_panel_dbus_interface_dbus_register_object(DBusConnection* connection, const char* path, void* object)
 {
     if (!g_object_get_data(object, "dbus_object_path")) {
@@ -981,6 +1059,7 @@ void awn_panel_dbus_interface_dbus_register_object(DBusConnection* connection, c
     g_signal_connect(object, "destroy-applet", (GCallback) _dbus_awn_panel_dbus_interface_destroy_applet, connection);
     g_signal_connect(object, "destroy-notify", (GCallback) _dbus_awn_panel_dbus_interface_destroy_notify, connection);
     g_signal_connect(object, "property-changed", (GCallback) _dbus_awn_panel_dbus_interface_property_changed, connection);
+    g_signal_connect(object, "properties-changed", (GCallback) _dbus_awn_panel_dbus_interface_properties_changed, connection);
 }
 
 
@@ -1935,6 +2014,61 @@ static gint64 awn_panel_dbus_interface_dbus_proxy_get_panel_xid(AwnPanelDBusInte
 }
 
 
+static guint awn_panel_dbus_interface_dbus_proxy_get_properties_generation(AwnPanelDBusInterface* self)
+{
+    DBusError _dbus_error;
+    DBusGConnection* _connection;
+
+    if (((AwnPanelDBusInterfaceDBusProxy*) self)->disposed) {
+        return 0;
+    }
+    DBusMessage* msg = dbus_message_new_method_call(dbus_g_proxy_get_bus_name((DBusGProxy*) self), dbus_g_proxy_get_path((DBusGProxy*) self), "org.freedesktop.DBus.Properties", "Get");
+    DBusMessageIter iter;
+    dbus_message_iter_init_append(msg, &iter);
+
+    awn::vala_dbus_iter_append_string(&iter, "org.awnproject.Awn.Panel");
+    awn::vala_dbus_iter_append_string(&iter, "PropertiesGeneration");
+
+    g_object_get(self, "connection", &_connection, NULL);
+    dbus_error_init(&_dbus_error);
+
+    DBusMessage* reply = dbus_connection_send_with_reply_and_block(dbus_g_connection_get_connection(_connection), msg, -1, &_dbus_error);
+    dbus_g_connection_unref(_connection);
+    dbus_message_unref(msg);
+
+    if (dbus_error_is_set(&_dbus_error)) {
+        g_critical("file %s: line %d: uncaught error: %s (%s)",
+                   __FILE__, __LINE__, _dbus_error.message, _dbus_error.name);
+        dbus_error_free(&_dbus_error);
+        return 0;
+    }
+
+    if (strcmp(dbus_message_get_signature(reply), "v")) {
+        g_critical("file %s: line %d: Invalid signature, expected \"%s\", got \"%s\"",
+                   __FILE__, __LINE__, "v", dbus_message_get_signature(reply));
+        dbus_message_unref(reply);
+        return 0;
+    }
+
+    dbus_message_iter_init(reply, &iter);
+
+    DBusMessageIter subiter;
+    dbus_message_iter_recurse(&iter, &subiter);
+    if (strcmp(dbus_message_iter_get_signature(&subiter), "u")) {
+        g_critical("file %s: line %d: Invalid signature, expected \"%s\", got \"%s\"",
+                   __FILE__, __LINE__, "u", dbus_message_iter_get_signature(&subiter));
+        dbus_message_unref(reply);
+        return 0;
+    }
+
+    dbus_uint32_t res;
+    dbus_message_iter_get_basic(&subiter, &res);
+    dbus_message_iter_next(&subiter);
+    dbus_message_unref(reply);
+    return res;
+}
+
+
 static void awn_panel_dbus_interface_dbus_proxy_awn_panel_dbus_interface__interface_init(AwnPanelDBusInterfaceIface* iface)
 {
     iface->add_applet = awn_panel_dbus_interface_dbus_proxy_add_applet;
@@ -1956,6 +2090,7 @@ static void awn_panel_dbus_interface_dbus_proxy_awn_panel_dbus_interface__interf
     iface->get_size = awn_panel_dbus_interface_dbus_proxy_get_size;
     iface->set_size = awn_panel_dbus_interface_dbus_proxy_set_size;
     iface->get_panel_xid = awn_panel_dbus_interface_dbus_proxy_get_panel_xid;
+    iface->get_properties_generation = awn_panel_dbus_interface_dbus_proxy_get_properties_generation;
 }
 
 
@@ -2034,6 +2169,51 @@ static void __lambda3__awn_panel_property_changed(AwnPanel* _sender, const gchar
 }
 
 
+static void awn_panel_dispatcher_free_value(gpointer data)
+{
+    GValue* value = (GValue*) data;
+    g_value_unset(value);
+    g_free(value);
+}
+
+
+/*
+ * Every per-property change is also collected here, so that everything that
+ * changes during one main loop iteration (size also changes offset, max-size
+ * etc.) reaches the applets as a single PropertiesChanged batch.
+ */
+static void awn_panel_dispatcher_queue_property(AwnPanelDispatcher* self, const gchar* prop_name, GValue* value, gpointer data)
+{
+    AwnPanelDispatcherPrivate* priv = self->priv;
+    GValue* copy = g_new0(GValue, 1);
+
+    g_value_init(copy, G_VALUE_TYPE(value));
+    g_value_copy(value, copy);
+    g_hash_table_replace(priv->pending_props, g_strdup(prop_name), copy);
+
+    if (priv->flush_id == 0) {
+        priv->flush_id = g_idle_add_full(G_PRIORITY_HIGH_IDLE, awn_panel_dispatcher_flush_properties, self, NULL);
+    }
+}
+
+
+static gboolean awn_panel_dispatcher_flush_properties(gpointer data)
+{
+    AwnPanelDispatcher* self = (AwnPanelDispatcher*) data;
+    AwnPanelDispatcherPrivate* priv = self->priv;
+    GHashTable* batch = priv->pending_props;
+
+    priv->flush_id = 0;
+    priv->pending_props = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, awn_panel_dispatcher_free_value);
+
+    priv->properties_generation++;
+    g_signal_emit_by_name((AwnPanelDBusInterface*) self, "properties-changed", priv->properties_generation, batch);
+    g_hash_table_destroy(batch);
+
+    return FALSE;
+}
+
+
 AwnPanelDispatcher* awn_panel_dispatcher_construct(GType object_type, AwnPanel* panel)
 {
     GError* _inner_error_ = NULL;
@@ -2043,6 +2223,7 @@ AwnPanelDispatcher* awn_panel_dispatcher_construct(GType object_type, AwnPanel*
     g_signal_connect_object(panel, "position-changed", (GCallback) __lambda1__awn_panel_position_changed, self, 0);
     g_signal_connect_object(panel, "offset-changed", (GCallback) __lambda2__awn_panel_offset_changed, self, 0);
     g_signal_connect_object(panel, "property-changed", (GCallback) __lambda3__awn_panel_property_changed, self, 0);
+    g_signal_connect(self, "property-changed", (GCallback) awn_panel_dispatcher_queue_property, NULL);
     DBusGConnection* conn = dbus_g_bus_get(DBUS_BUS_SESSION, &_inner_error_);
     if (_inner_error_ != NULL) {
         g_critical("file %s: line %d: uncaught error: %s (%s, %d)", __FILE__, __LINE__, _inner_error_->message, g_quark_to_string(_inner_error_->domain), _inner_error_->code);
@@ -2305,6 +2486,13 @@ static gint64 awn_panel_dispatcher_real_get_panel_xid(AwnPanelDBusInterface* bas
 }
 
 
+static guint awn_panel_dispatcher_real_get_properties_generation(AwnPanelDBusInterface* base)
+{
+    AwnPanelDispatcher* self = (AwnPanelDispatcher*) base;
+    return self->priv->properties_generation;
+}
+
+
 static void awn_panel_dispatcher_class_init(AwnPanelDispatcherClass* klass)
 {
     awn_panel_dispatcher_parent_class = g_type_class_peek_parent(klass);
@@ -2338,17 +2526,24 @@ static void awn_panel_dispatcher_awn_panel_dbus_interface_interface_init(AwnPane
     iface->get_size = awn_panel_dispatcher_real_get_size;
     iface->set_size = awn_panel_dispatcher_real_set_size;
     iface->get_panel_xid = awn_panel_dispatcher_real_get_panel_xid;
+    iface->get_properties_generation = awn_panel_dispatcher_real_get_properties_generation;
 }
 
 
 static void awn_panel_dispatcher_instance_init(AwnPanelDispatcher* self)
 {
     self->priv = AWN_PANEL_DISPATCHER_GET_PRIVATE(self);
+    self->priv->pending_props = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, awn_panel_dispatcher_free_value);
 }
 
 
 static void awn_panel_dispatcher_finalize(GObject* obj)
 {
+    AwnPanelDispatcher* self = AWN_PANEL_DISPATCHER(obj);
+    if (self->priv->flush_id) {
+        g_source_remove(self->priv->flush_id);
+    }
+    g_hash_table_destroy(self->priv->pending_props);
     G_OBJECT_CLASS(awn_panel_dispatcher_parent_class)->finalize(obj);
 }
 
@@ -2367,7 +2562,7 @@ static DBusHandlerResult _dbus_awn_panel_dispatcher_introspect(AwnPanelDispatche
     dbus_message_iter_init_append(reply, &iter);
 
     std::string xml_data{"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"};
-    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
+    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <property name=\"PropertiesGeneration\" type=\"u\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n  <signal name=\"PropertiesChanged\">\n    <arg name=\"generation\" type=\"u\"/>\n    <arg name=\"props\" type=\"a{sv}\"/>\n  </signal>\n</interface>\n";
     dbus_connection_list_registered(connection, g_object_get_data((GObject*) self, "dbus_object_path"), &children);
     for (int i = 0; children[i]; i++) {
         xml_data = xml_data + "<node name=\"" + children[i] + "\"/>\n";
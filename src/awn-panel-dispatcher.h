@@ -65,6 +65,7 @@ struct _AwnPanelDBusInterfaceIface {
     gint(*get_size)(AwnPanelDBusInterface* self);
     void (*set_size)(AwnPanelDBusInterface* self, gint value);
     gint64(*get_panel_xid)(AwnPanelDBusInterface* self);
+    guint(*get_properties_generation)(AwnPanelDBusInterface* self);
 };
 
 struct AwnPanelDispatcherPrivate;
@@ -99,6 +100,7 @@ void awn_panel_dbus_interface_set_position(AwnPanelDBusInterface* self, gint val
 gint awn_panel_dbus_interface_get_size(AwnPanelDBusInterface* self);
 void awn_panel_dbus_interface_set_size(AwnPanelDBusInterface* self, gint value);
 gint64 awn_panel_dbus_interface_get_panel_xid(AwnPanelDBusInterface* self);
+guint awn_panel_dbus_interface_get_properties_generation(AwnPanelDBusInterface* self);
 GType awn_panel_dispatcher_get_type(void) G_GNUC_CONST;
 AwnPanelDispatcher* awn_panel_dispatcher_new(AwnPanel* panel);
 AwnPanelDispatcher* awn_panel_dispatcher_construct(GType object_type, AwnPanel* panel);
@@ -23,6 +23,9 @@
 
 #include "config.h"
 
+#include <math.h>
+#include <string.h>
+
 #include <gdk/gdkx.h>
 #include <glib/gi18n.h>
 
@@ -47,6 +50,7 @@
 #include "awn-background-lucido.h"
 #include "awn-background-floaty.h"
 #include "awn-defines.h"
+#include "awn-dnd-tracker.h"
 #include "awn-marshal.h"
 #include "awn-monitor.h"
 #include "awn-panel-dispatcher.h"
@@ -54,6 +58,7 @@
 #include "awn-x.h"
 
 #include "libawn/gseal-transition.h"
+#include "libawn/awn-stats.h"
 #include "xutils.h"
 
 extern "C" {
@@ -63,6 +68,27 @@ extern "C" {
 #define AWN_PANEL_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE (obj, \
   AWN_TYPE_PANEL, AwnPanelPrivate))
 
+/* Everything the window shape depends on; when nothing changed since the
+ * last update the XShape upload is skipped. Compared with memcmp, so always
+ * memset it before filling. */
+typedef struct {
+    GdkWindow* window;
+    guint applets_generation;
+    GdkRectangle viewport;
+    gdouble viewport_x, viewport_y;
+    gboolean arrows;
+    GtkAllocation arrow1, arrow2;
+    AwnBackground* bg;
+    guint bg_serial;
+    gint width, height;
+    GdkRectangle area;
+    GtkPositionType position;
+    gint size, offset;
+    gfloat offset_mod;
+    gint path_type;
+    gboolean composited;
+} AwnPanelMaskKey;
+
 struct _AwnPanelPrivate {
     gint panel_id;
     DesktopAgnosticConfigClient* client;
@@ -113,22 +139,32 @@ struct _AwnPanelPrivate {
     gint old_y;
     guint strut_update_id;
     guint masks_update_id;
+    AwnPanelMaskKey masks_key;
+    guint bg_serial;
 
     /* animated resizing */
     gint draw_width;
     gint draw_height;
     guint resize_timer_id;
+    gint resize_from;
+    gint resize_target;
+    gdouble resize_start;
 
     guint extra_padding;
 
-    GdkWindow* dnd_proxy_win;
-    GdkDragProtocol dnd_proxy_proto;
+    AwnDndTracker* dnd_tracker;
 
-    guint dnd_mouse_poll_timer_id;
     guint mouse_poll_timer_id;
 
     /* scrolling */
     guint scroll_timer_id;
+    gint scroll_direction;      /* -1, 0 or 1 while an arrow is hovered */
+    gdouble scroll_velocity;    /* px/s */
+    gdouble scroll_position;    /* unrounded adjustment value */
+    gdouble scroll_last_time;
+
+    /* time base of the scrolling and autohide animations */
+    GTimer* clock;
 
     /* autohide stuff */
     gint autohide_hide_delay;
@@ -137,8 +173,12 @@ struct _AwnPanelPrivate {
     gulong autohide_start_handler_id;
     gulong autohide_end_handler_id;
 
-    gint hide_counter;
     guint hiding_timer_id;
+    cairo_surface_t* autohide_snapshot;
+    gboolean autohide_hiding;
+    gdouble autohide_alpha;
+    gdouble autohide_alpha_from;
+    gdouble autohide_anim_start;
     guint withdraw_timer_id;
     gint withdraw_redraw_timer;
 
@@ -169,6 +209,9 @@ typedef struct _AwnInhibitItem {
 
 #define CLICKTHROUGH_OPACITY 0.3
 
+#define RESIZE_INTERVAL 16
+#define RESIZE_DURATION 0.25 /* seconds, regardless of the distance */
+
 #define ROUND(x) (x < 0 ? x - 0.5 : x + 0.5)
 
 //#define DEBUG_INPUT_SHAPE
@@ -293,6 +336,7 @@ static void     awn_panel_size_request(GtkWidget* widget,
 static gboolean awn_panel_button_press(GtkWidget*      widget,
                                        GdkEventButton* event);
 static gboolean awn_panel_resize_timeout(gpointer data);
+static gdouble  awn_panel_get_time(AwnPanel* panel);
 
 static void     awn_panel_add(GtkContainer*   window,
                               GtkWidget*      widget);
@@ -358,10 +402,10 @@ static void     awn_panel_set_strut(AwnPanel* panel);
 static void     awn_panel_remove_strut(AwnPanel* panel);
 
 #if !GTK_CHECK_VERSION(2, 19, 5)
-static gboolean awn_panel_dnd_check(gpointer data);
-
-static gboolean awn_panel_set_drag_proxy(AwnPanel* panel,
-        gboolean check_mouse_pos);
+static void     awn_panel_dnd_target_changed(AwnDndTracker* tracker,
+        GdkWindow* target,
+        GdkDragProtocol protocol,
+        AwnPanel* panel);
 #endif
 
 static void     dbus_inhibitor_lost(AwnDBusWatcher* watcher,
@@ -373,137 +417,29 @@ static void     dbus_inhibitor_lost(AwnDBusWatcher* watcher,
  * GOBJECT CODE
  */
 #if !GTK_CHECK_VERSION(2, 19, 5)
-static gboolean
-awn_panel_set_drag_proxy(AwnPanel* panel, gboolean check_mouse_pos)
+/*
+ * The tracker follows the XdndPosition messages of the drag and tells us
+ * when the window below the panel changes, so the drop goes to whatever is
+ * under the panel.
+ */
+static void
+awn_panel_dnd_target_changed(AwnDndTracker* tracker, GdkWindow* target,
+                             GdkDragProtocol protocol, AwnPanel* panel)
 {
-    AwnPanelPrivate* priv = panel->priv;
     GtkWidget* widget = GTK_WIDGET(panel);
 
-    if (check_mouse_pos) {
-        gboolean in = awn_panel_check_mouse_pos(panel, MOUSE_CHECK_ENTIRE_WINDOW);
-        if (!in) {
-            if (priv->dnd_proxy_win) {
-                g_object_unref(priv->dnd_proxy_win);
-                // FIXME: unset first?
-                gtk_drag_dest_set(widget, 0, drop_types, n_drop_types,
-                                  GDK_ACTION_COPY);
-
-                priv->dnd_proxy_win = NULL;
-            }
-            return FALSE;
-        }
-    }
-
-    GdkDisplay* display = gtk_widget_get_display(widget);
-    GdkWindow* window = NULL;
-
-#if 1
-    GdkScreen* screen;
-    gint mouse_x, mouse_y;
-    gdk_display_get_pointer(display, &screen, &mouse_x, &mouse_y, NULL);
-    GList* windows = gdk_screen_get_window_stack(screen);
-
-    GdkNativeWindow panel_xid = GDK_WINDOW_XID(widget->window);
-
-    // go through window stack list and find window the mouse is on
-    for (GList* it = g_list_last(windows); it; it = g_list_previous(it)) {
-        gint win_x, win_y, win_w, win_h;
-        GdkWindow* it_window = it->data;
-
-        if (GDK_WINDOW_XID(it_window) == panel_xid || window != NULL) {
-            g_object_unref(it_window);
-            continue;
-        }
-
-        // this does screw up d&d when using multiple panels, but at least it
-        //   won't crash
-        if (gdk_window_get_window_type(it_window) == GDK_WINDOW_TOPLEVEL) {
-            g_object_unref(it_window);
-            continue;
-        }
-
-        gdk_window_get_origin(it_window, &win_x, &win_y);
-        gdk_window_get_geometry(it_window, NULL, NULL, &win_w, &win_h, NULL);
-
-        // if mouse in, and window is not minimized
-        if (mouse_x >= win_x && mouse_x < win_x + win_w &&
-                mouse_y >= win_y && mouse_y < win_y + win_h &&
-                gdk_window_is_visible(it_window) &&
-                xutils_is_window_minimized(it_window) == FALSE) {
-            window = g_object_ref(it_window);
-            // no break so we unref all other windows
-        }
-
-        g_object_unref(it_window);
-    }
-
-    g_list_free(windows);
-#else
-    // FIXME: this method is much faster, but when dragging for example a file
-    //  from the desktop to different position on the desktop,
-    //  it returns a temporary window created by nautilus, therefore doesn't work
-    //  on 100% :-(
-    window = xutils_get_window_at_pointer(display);
-#endif
-    if (window != priv->dnd_proxy_win) {
-        if (window != widget->window && window != NULL && window != widget->window) {
-            GdkNativeWindow target;
-
-            target = gdk_drag_get_protocol(GDK_WINDOW_XID(window),
-                                           &priv->dnd_proxy_proto);
-
-            if (target == 0) {
-                if (priv->dnd_proxy_win) {
-                    g_object_unref(priv->dnd_proxy_win);
-                    gtk_drag_dest_set(widget, 0, drop_types, n_drop_types, GDK_ACTION_COPY);
-                }
-                priv->dnd_proxy_win = NULL;
-                return FALSE;
-            }
-
-            // get the target GdkWindow
-            if (GDK_WINDOW_XID(window) != target) {
-                g_object_unref(window);
-
-                // FIXME: this might need ref
-                window = gdk_window_lookup_for_display(display, target);
-                if (priv->dnd_proxy_win != NULL && window == priv->dnd_proxy_win) {
-                    return TRUE;
-                }
-                if (window == NULL) {
-                    window = gdk_window_foreign_new(target);
-                }
-            }
-
-            priv->dnd_proxy_win = g_object_ref(window);
-            gtk_drag_dest_set_proxy(widget, window, priv->dnd_proxy_proto, FALSE);
-
-            g_object_unref(window);
-        } else if (priv->dnd_proxy_win) {
-            // FIXME: unset first?
-            gtk_drag_dest_set(widget, 0, drop_types, n_drop_types, GDK_ACTION_COPY);
-
-            g_object_unref(priv->dnd_proxy_win);
-            priv->dnd_proxy_win = NULL;
-        }
+    if (target) {
+        gtk_drag_dest_set_proxy(widget, target, protocol, FALSE);
+    } else {
+        // FIXME: unset first?
+        gtk_drag_dest_set(widget, 0, drop_types, n_drop_types, GDK_ACTION_COPY);
     }
-
-    return priv->dnd_proxy_win != NULL;
 }
 
 static gboolean
 awn_panel_drag_motion(GtkWidget* widget, GdkDragContext* context,
                       gint x, gint y, guint time_)
 {
-    AwnPanelPrivate* priv = AWN_PANEL_GET_PRIVATE(widget);
-
-    awn_panel_set_drag_proxy(AWN_PANEL(widget), FALSE);
-
-    if (priv->dnd_mouse_poll_timer_id == 0) {
-        priv->dnd_mouse_poll_timer_id = g_timeout_add(40, awn_panel_dnd_check,
-                                        widget);
-    }
-
     gdk_drag_status(context, 0, time_);
 
     return TRUE;
@@ -680,6 +616,12 @@ awn_panel_constructed(GObject* object)
     position_window(AWN_PANEL(panel));
 
     gtk_drag_dest_set(panel, 0, drop_types, n_drop_types, GDK_ACTION_COPY);
+#if !GTK_CHECK_VERSION(2, 19, 5)
+    priv->dnd_tracker =
+        awn_dnd_tracker_new(panel,
+                            (AwnDndTrackerFunc)awn_panel_dnd_target_changed,
+                            panel);
+#endif
 
     /* Prefs/Quit/About menu */
     GtkWidget* item;
@@ -934,8 +876,10 @@ awn_panel_size_request(GtkWidget* widget, GtkRequisition* requisition)
     if (priv->animated_resize && !priv->expand) {
         if (*target_size != *current_draw_size && !priv->resize_timer_id) {
             /* background invalidation is in awn_panel_resize_timeout */
-            priv->resize_timer_id = g_timeout_add(40, awn_panel_resize_timeout,
-                                                  widget); // 25 FPS
+            priv->resize_target = -1; // picked up by the first frame
+            priv->resize_timer_id = g_timeout_add(RESIZE_INTERVAL,
+                                                  awn_panel_resize_timeout,
+                                                  widget);
         }
     } else if (priv->expand) {
         // this ensures there's a shrinking animation when expand is turned off
@@ -951,11 +895,16 @@ static gboolean
 awn_panel_resize_timeout(gpointer data)
 {
     gboolean resize_done;
-    gint inc, step;
+    gint target, current;
+    gdouble progress;
     AwnPanel* panel = AWN_PANEL(data);
     AwnPanelPrivate* priv = panel->priv;
     GtkAllocation alloc;
     GdkRectangle rect1, rect2;
+    GdkRectangle strip;
+    GdkRegion* damage;
+    gint margin, cap;
+    gboolean vertical;
 
     // this is the size we are resizing to
     const gint target_width = MIN(priv->alignment->requisition.width,
@@ -970,29 +919,44 @@ awn_panel_resize_timeout(gpointer data)
     switch (priv->position) {
     case GTK_POS_LEFT:
     case GTK_POS_RIGHT:
-        inc = abs(target_height - priv->draw_height);
-        step = inc / 7 + 2; // makes the resize shiny
-        inc = MIN(inc, step);
-
-        priv->draw_width = alloc.width;
-
-        priv->draw_height += priv->draw_height < target_height ? inc : -inc;
-
-        resize_done = priv->draw_height == target_height;
+        vertical = TRUE;
+        target = target_height;
+        current = priv->draw_height;
         break;
     case GTK_POS_TOP:
     case GTK_POS_BOTTOM:
     default:
-        inc = abs(target_width - priv->draw_width);
-        step = inc / 7 + 2; // makes the resize shiny
-        inc = MIN(inc, step);
+        vertical = FALSE;
+        target = target_width;
+        current = priv->draw_width;
+        break;
+    }
 
-        priv->draw_width += priv->draw_width < target_width ? inc : -inc;
+    // (re)start the animation from wherever we are now, the duration is
+    // fixed, so it doesn't matter how many frames we actually get
+    if (target != priv->resize_target) {
+        priv->resize_from = current;
+        priv->resize_target = target;
+        priv->resize_start = awn_panel_get_time(panel);
+    }
 
-        priv->draw_height = alloc.height;
+    progress = (awn_panel_get_time(panel) - priv->resize_start) /
+               RESIZE_DURATION;
+    progress = CLAMP(progress, 0.0, 1.0);
+    resize_done = progress >= 1.0;
 
-        resize_done = priv->draw_width == target_width;
-        break;
+    // ease out cubic - makes the resize shiny
+    progress = 1.0 - pow(1.0 - progress, 3.0);
+    current = resize_done ? target :
+              priv->resize_from +
+              (gint)ROUND((target - priv->resize_from) * progress);
+
+    if (vertical) {
+        priv->draw_width = alloc.width;
+        priv->draw_height = current;
+    } else {
+        priv->draw_width = current;
+        priv->draw_height = alloc.height;
     }
 
 #if 0
@@ -1003,29 +967,68 @@ awn_panel_resize_timeout(gpointer data)
     // draw_width / height got updated, get the draw rect again
     awn_panel_get_draw_rect(panel, &rect2, 0, 0);
 
-    // invalidate only the background draw region
-    gint end_x = MAX(rect1.x + rect1.width, rect2.x + rect2.width);
-    gint end_y = MAX(rect1.y + rect1.height, rect2.y + rect2.height);
-    GdkRectangle invalid_rect = {
-        .x = MIN(rect1.x, rect2.x) - priv->glow_size,
-        .y = MIN(rect1.y, rect2.y) - priv->glow_size,
-        .width = end_x - MIN(rect1.x, rect2.x) + priv->glow_size * 2,
-        .height = end_y - MIN(rect1.y, rect2.y) + priv->glow_size * 2
-    };
-    gdk_window_invalidate_rect(gtk_widget_get_window(GTK_WIDGET(panel)),
-                               &invalid_rect, FALSE);
+    damage = gdk_region_new();
+    if (!awn_background_get_slice_cap(priv->bg, priv->position, &cap)) {
+        // the whole background depends on its length (curves, perspective,
+        // gradients spanning the panel), so all of it changes
+        gdk_rectangle_union(&rect1, &rect2, &strip);
+        strip.x -= priv->glow_size;
+        strip.y -= priv->glow_size;
+        strip.width += priv->glow_size * 2;
+        strip.height += priv->glow_size * 2;
+        gdk_region_union_with_rect(damage, &strip);
+    } else if (vertical) {
+        // invalidate only the strips between the old and the new ends of
+        // the background, the margin covers the glow and the ends
+        margin = priv->glow_size + cap;
+
+        strip.x = MIN(rect1.x, rect2.x) - priv->glow_size;
+        strip.width = MAX(rect1.x + rect1.width, rect2.x + rect2.width) -
+                      strip.x + priv->glow_size;
+
+        strip.y = MIN(rect1.y, rect2.y) - margin;
+        strip.height = ABS(rect1.y - rect2.y) + margin * 2;
+        gdk_region_union_with_rect(damage, &strip);
+
+        strip.y = MIN(rect1.y + rect1.height, rect2.y + rect2.height) - margin;
+        strip.height = ABS(rect1.y + rect1.height - rect2.y - rect2.height) +
+                       margin * 2;
+        gdk_region_union_with_rect(damage, &strip);
+    } else {
+        margin = priv->glow_size + cap;
+
+        strip.y = MIN(rect1.y, rect2.y) - priv->glow_size;
+        strip.height = MAX(rect1.y + rect1.height, rect2.y + rect2.height) -
+                       strip.y + priv->glow_size;
+
+        strip.x = MIN(rect1.x, rect2.x) - margin;
+        strip.width = ABS(rect1.x - rect2.x) + margin * 2;
+        gdk_region_union_with_rect(damage, &strip);
+
+        strip.x = MIN(rect1.x + rect1.width, rect2.x + rect2.width) - margin;
+        strip.width = ABS(rect1.x + rect1.width - rect2.x - rect2.width) +
+                      margin * 2;
+        gdk_region_union_with_rect(damage, &strip);
+    }
+    gdk_window_invalidate_region(gtk_widget_get_window(GTK_WIDGET(panel)),
+                                 damage, FALSE);
+    gdk_region_destroy(damage);
+
     awn_background_invalidate(priv->bg);
     // without this there are some artifacts on sad face & throbbers
     awn_applet_manager_redraw_throbbers(AWN_APPLET_MANAGER(priv->manager));
 
-    // Don't update the input masks here, it gets called too often and some
-    // drivers really don't like it. (LP bug #478790)
+    // Don't update the input masks nor the strut here, it gets called too
+    // often and some drivers really don't like it. (LP bug #478790)
 
     if (resize_done) {
         gtk_widget_queue_resize(GTK_WIDGET(panel));
         priv->resize_timer_id = 0;
 
         awn_panel_queue_masks_update(panel);
+        if (priv->panel_mode) {
+            awn_panel_queue_strut_update(panel);
+        }
     }
 
     return !resize_done;
@@ -1298,7 +1301,7 @@ static void free_inhibit_item(gpointer data)
 }
 
 static GdkRegion*
-awn_panel_get_mask(AwnPanel* panel)
+awn_panel_get_mask(AwnPanel* panel, AwnPanelMaskKey* key)
 {
     AwnPanelPrivate* priv;
     GtkAllocation viewport_alloc;
@@ -1308,7 +1311,8 @@ awn_panel_get_mask(AwnPanel* panel)
     priv = panel->priv;
 
     region = awn_applet_manager_get_mask(AWN_APPLET_MANAGER(priv->manager),
-                                         priv->path_type, priv->offset_mod);
+                                         priv->path_type, priv->offset_mod,
+                                         key ? &key->applets_generation : NULL);
     /* the applets are in viewport */
     viewport_offset_x =
         gtk_adjustment_get_value(
@@ -1325,6 +1329,12 @@ awn_panel_get_mask(AwnPanel* panel)
     gdk_region_intersect(region, viewport_region);
     gdk_region_destroy(viewport_region);
 
+    if (key) {
+        key->viewport = viewport_alloc;
+        key->viewport_x = viewport_offset_x;
+        key->viewport_y = viewport_offset_y;
+    }
+
     if (gtk_widget_get_visible(GTK_WIDGET(priv->arrow1))) {
         GdkRegion* icon_mask1, *icon_mask2;
 
@@ -1334,6 +1344,12 @@ awn_panel_get_mask(AwnPanel* panel)
         icon_mask2 = awn_icon_get_input_mask(AWN_ICON(priv->arrow2));
         gdk_region_union(region, icon_mask2);
 
+        if (key) {
+            key->arrows = TRUE;
+            gtk_widget_get_allocation(priv->arrow1, &key->arrow1);
+            gtk_widget_get_allocation(priv->arrow2, &key->arrow2);
+        }
+
         gdk_region_destroy(icon_mask1);
         gdk_region_destroy(icon_mask2);
     }
@@ -1401,7 +1417,7 @@ static gboolean awn_panel_check_mouse_pos(AwnPanel* panel,
         //   but we can't do it because the checks are happening also while
         //   in clickthrough mode
         //   solution could be to save the mask which is created in update_masks
-        GdkRegion* region = awn_panel_get_mask(panel);
+        GdkRegion* region = awn_panel_get_mask(panel, NULL);
         gdk_region_offset(region, window_x, window_y);
         gboolean inside_mask = gdk_region_point_in(region, x, y);
         gdk_region_destroy(region);
@@ -1465,39 +1481,181 @@ static gboolean awn_panel_check_mouse_pos(AwnPanel* panel,
 }
 
 /* Auto-hide fade out method */
+#define AUTOHIDE_FADE_INTERVAL 16
+#define AUTOHIDE_FADE_DURATION 0.32 /* seconds for the full 1.0 -> 0.0 fade */
+
+static gdouble
+awn_panel_get_time(AwnPanel* panel)
+{
+    AwnPanelPrivate* priv = panel->priv;
+
+    if (priv->clock == NULL) {
+        priv->clock = g_timer_new();
+    }
+
+    return g_timer_elapsed(priv->clock, NULL);
+}
+
+static void
+awn_panel_free_autohide_snapshot(AwnPanel* panel)
+{
+    AwnPanelPrivate* priv = panel->priv;
+
+    if (priv->autohide_snapshot) {
+        cairo_surface_destroy(priv->autohide_snapshot);
+        priv->autohide_snapshot = NULL;
+    }
+}
+
+/*
+ * Renders the panel as the compositor sees it (background + the composited
+ * eventbox) into a server side surface. While the snapshot exists
+ * awn_panel_expose paints just the snapshot, so the fade doesn't need
+ * anything from the applets.
+ */
+static gboolean
+awn_panel_take_autohide_snapshot(AwnPanel* panel)
+{
+    AwnPanelPrivate* priv = panel->priv;
+    GtkWidget* widget = GTK_WIDGET(panel);
+    GtkWidget* child;
+    GtkAllocation alloc;
+    GdkRectangle area;
+    GdkWindow* win;
+    cairo_t* cr;
+
+    if (priv->autohide_snapshot) {
+        return TRUE;
+    }
+
+    win = gtk_widget_get_window(widget);
+    if (!priv->composited || win == NULL || !gtk_widget_get_mapped(widget)) {
+        return FALSE;
+    }
+
+    gtk_widget_get_allocation(widget, &alloc);
+
+    cr = gdk_cairo_create(win);
+    priv->autohide_snapshot =
+        cairo_surface_create_similar(cairo_get_target(cr),
+                                     CAIRO_CONTENT_COLOR_ALPHA,
+                                     alloc.width, alloc.height);
+    cairo_destroy(cr);
+
+    cr = cairo_create(priv->autohide_snapshot);
+
+    awn_panel_get_draw_rect(panel, &area, 0, 0);
+    awn_background_draw(priv->bg, cr, priv->position, &area);
+
+    child = gtk_bin_get_child(GTK_BIN(widget));
+    if (GTK_IS_WIDGET(child) && gtk_widget_get_window(child)) {
+        GtkAllocation box_alloc;
+
+        gtk_widget_get_allocation(priv->box, &box_alloc);
+        gdk_cairo_rectangle(cr, &box_alloc);
+        cairo_clip(cr);
+        gdk_cairo_set_source_pixmap(cr, gtk_widget_get_window(child),
+                                    child->allocation.x, child->allocation.y);
+        cairo_paint(cr);
+    }
+
+    cairo_destroy(cr);
+
+    if (cairo_surface_status(priv->autohide_snapshot) != CAIRO_STATUS_SUCCESS) {
+        awn_panel_free_autohide_snapshot(panel);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 static gboolean
-alpha_blend_hide(gpointer data)
+alpha_blend_step(gpointer data)
 {
-    const int HIDE_COUNTER_MAX = 8;
     g_return_val_if_fail(AWN_IS_PANEL(data), FALSE);
 
     AwnPanel* panel = AWN_PANEL(data);
     AwnPanelPrivate* priv = panel->priv;
-    GdkWindow* win;
+    GtkWidget* widget = GTK_WIDGET(panel);
+    gdouble target = priv->autohide_hiding ? 0.0 : 1.0;
+    gdouble duration, progress;
 
-    priv->hide_counter++;
+    // a fade interrupted halfway back takes only the remaining time
+    duration = AUTOHIDE_FADE_DURATION * fabs(target - priv->autohide_alpha_from);
+    progress = duration > 0.0 ?
+               (awn_panel_get_time(panel) - priv->autohide_anim_start) / duration :
+               1.0;
+    progress = CLAMP(progress, 0.0, 1.0);
+    progress = progress * progress * (3.0 - 2.0 * progress);
 
-    win = gtk_widget_get_window(GTK_WIDGET(panel));
+    priv->autohide_alpha = priv->autohide_alpha_from +
+                           (target - priv->autohide_alpha_from) * progress;
 
-    gdk_window_set_opacity(win, 1 - 1.0 / HIDE_COUNTER_MAX * priv->hide_counter);
+    if (gtk_widget_get_window(widget)) {
+        gdk_window_invalidate_rect(gtk_widget_get_window(widget), NULL, FALSE);
+    }
 
-    if (priv->hide_counter >= HIDE_COUNTER_MAX) {
-        priv->hiding_timer_id = 0;
+    if (progress < 1.0) {
+        return TRUE;
+    }
+
+    priv->hiding_timer_id = 0;
+
+    if (priv->autohide_hiding) {
+        /* the applets will have changed by the time we're shown again, the
+         * fade in uses what they paint then */
+        awn_panel_free_autohide_snapshot(panel);
         priv->autohide_always_visible = FALSE; /* see the note in start function */
-        gdk_window_set_opacity(win, 1.0);
-        gtk_widget_hide(GTK_WIDGET(panel));
-        return FALSE;
+        gtk_widget_hide(widget);
+    } else {
+        awn_panel_free_autohide_snapshot(panel);
+        /* second and last input shape update */
+        memset(&priv->masks_key, 0, sizeof(AwnPanelMaskKey));
+        awn_panel_update_masks(widget, 0, 0);
+        gtk_widget_queue_draw(widget);
     }
 
-    return TRUE;
+    return FALSE;
+}
+
+static void
+alpha_blend_animate(AwnPanel* panel, gboolean hiding)
+{
+    AwnPanelPrivate* priv = panel->priv;
+
+    priv->autohide_hiding = hiding;
+    priv->autohide_alpha_from = priv->autohide_alpha;
+    priv->autohide_anim_start = awn_panel_get_time(panel);
+
+    if (priv->hiding_timer_id == 0) {
+        priv->hiding_timer_id = g_timeout_add(AUTOHIDE_FADE_INTERVAL,
+                                              alpha_blend_step, panel);
+    }
 }
 
 static gboolean
 alpha_blend_start(AwnPanel* panel, gpointer data)
 {
     AwnPanelPrivate* priv = panel->priv;
-    priv->hide_counter = 0;
-    priv->hiding_timer_id = g_timeout_add(40, alpha_blend_hide, panel);
+    GdkWindow* win = gtk_widget_get_window(GTK_WIDGET(panel));
+
+    if (!awn_panel_take_autohide_snapshot(panel)) {
+        /* nothing to fade without a compositor */
+        gtk_widget_hide(GTK_WIDGET(panel));
+        return FALSE;
+    }
+
+    if (priv->hiding_timer_id == 0) {
+        priv->autohide_alpha = 1.0;
+
+        /* first input shape update - nothing is clickable while fading */
+        GdkRegion* region = gdk_region_new();
+        gdk_window_input_shape_combine_region(win, region, 0, 0);
+        gdk_region_destroy(region);
+        memset(&priv->masks_key, 0, sizeof(AwnPanelMaskKey));
+    }
+
+    alpha_blend_animate(panel, TRUE);
 
     /* A hack: we will set autohide_always_visible ourselves
      * when the animation's internal timer expires, so that while the window is
@@ -1512,17 +1670,22 @@ alpha_blend_end(AwnPanel* panel, gpointer data)
 {
     AwnPanelPrivate* priv = panel->priv;
 
-    if (priv->hiding_timer_id) {
-        GdkWindow* win;
-        win = gtk_widget_get_window(GTK_WIDGET(panel));
-        g_source_remove(priv->hiding_timer_id);
-        priv->hiding_timer_id = 0;
-        gdk_window_set_opacity(win, 1.0);
-    } else {
+    if (priv->autohide_snapshot == NULL && !priv->composited) {
+        priv->autohide_alpha = 1.0;
         position_window(panel);
         gtk_widget_show(GTK_WIDGET(panel));
+        return;
+    }
 
+    if (!gtk_widget_get_visible(GTK_WIDGET(panel))) {
+        /* fades in the live content, see awn_panel_paint */
+        priv->autohide_alpha = 0.0;
+        position_window(panel);
+        gtk_widget_show(GTK_WIDGET(panel));
     }
+
+    /* reverses a running fade out from wherever it got */
+    alpha_blend_animate(panel, FALSE);
 }
 
 /* Auto-hide keep below method */
@@ -1700,24 +1863,6 @@ poll_mouse_position(gpointer data)
     return FALSE;
 }
 
-#if !GTK_CHECK_VERSION(2, 19, 5)
-static gboolean
-awn_panel_dnd_check(gpointer data)
-{
-    AwnPanel* panel = AWN_PANEL(data);
-    AwnPanelPrivate* priv = panel->priv;
-    gboolean proxy_set = FALSE;
-
-    proxy_set = awn_panel_set_drag_proxy(panel, TRUE);
-
-    if (!proxy_set) {
-        // kill the timer
-        priv->dnd_mouse_poll_timer_id = 0;
-    }
-    return proxy_set;
-}
-#endif
-
 static void
 awn_panel_dispose(GObject* object)
 {
@@ -1744,6 +1889,16 @@ awn_panel_dispose(GObject* object)
         priv->resize_timer_id = 0;
     }
 
+    if (priv->scroll_timer_id) {
+        g_source_remove(priv->scroll_timer_id);
+        priv->scroll_timer_id = 0;
+    }
+
+    if (priv->dnd_tracker) {
+        awn_dnd_tracker_free(priv->dnd_tracker);
+        priv->dnd_tracker = NULL;
+    }
+
     if (priv->dbus_proxy) {
         g_object_unref(priv->dbus_proxy);
         priv->dbus_proxy = NULL;
@@ -1770,6 +1925,13 @@ awn_panel_finalize(GObject* object)
         priv->monitor = NULL;
     }
 
+    if (priv->clock) {
+        g_timer_destroy(priv->clock);
+        priv->clock = NULL;
+    }
+
+    awn_panel_free_autohide_snapshot(AWN_PANEL(object));
+
     G_OBJECT_CLASS(awn_panel_parent_class)->finalize(object);
 }
 
@@ -2099,45 +2261,145 @@ viewport_size_req(GtkWidget* widget, GtkRequisition* req, gpointer data)
     }
 }
 
-static gboolean
-awn_panel_scroll_timer(AwnPanel* panel)
+/*
+ * Scrolling of an overflowing panel.
+ *
+ * Hovering an arrow accelerates towards SCROLL_MAX_VELOCITY, leaving it (or
+ * a wheel/touchpad scroll, which only adds an impulse) lets the velocity
+ * decay, so the motion is time-based and eased instead of fixed steps.
+ * GtkViewport moves its bin window when the adjustment changes, so GDK
+ * copies the already rendered applets and only the newly exposed strip is
+ * repainted by them.
+ */
+#define SCROLL_INTERVAL 16
+#define SCROLL_MAX_VELOCITY 900.0
+#define SCROLL_ACCEL_TIME 0.12
+#define SCROLL_DECEL_TIME 0.25
+#define SCROLL_WHEEL_IMPULSE 400.0
+#define SCROLL_MIN_VELOCITY 5.0
+
+static GtkAdjustment*
+awn_panel_get_scroll_adjustment(AwnPanel* panel, gdouble* max)
 {
-    gdouble max, value;
+    AwnPanelPrivate* priv = panel->priv;
     GtkAllocation alloc;
     GtkAdjustment* adj;
-    g_return_val_if_fail(AWN_IS_PANEL(panel), FALSE);
-    AwnPanelPrivate* priv = AWN_PANEL_GET_PRIVATE(panel);
 
-    gpointer data = g_object_get_data(G_OBJECT(panel), "scrolled-icon");
+    gtk_widget_get_allocation(priv->viewport, &alloc);
 
-    if (data == NULL) {
-        priv->scroll_timer_id = 0;
-        return FALSE;
+    switch (priv->position) {
+    case GTK_POS_TOP:
+    case GTK_POS_BOTTOM:
+        adj = gtk_viewport_get_hadjustment(GTK_VIEWPORT(priv->viewport));
+        *max = gtk_adjustment_get_upper(adj) - alloc.width;
+        break;
+    default:
+        adj = gtk_viewport_get_vadjustment(GTK_VIEWPORT(priv->viewport));
+        *max = gtk_adjustment_get_upper(adj) - alloc.height;
+        break;
     }
 
-    gboolean inc = data != priv->arrow1;
-    gint mult = inc ? 1 : -1;
+    *max = MAX(*max, 0.0);
 
-    gtk_widget_get_allocation(priv->viewport, &alloc);
+    return adj;
+}
 
+/*
+ * The eventbox is composited into the panel window, moving the viewport's
+ * bin window copies its contents inside the eventbox, but the panel isn't
+ * told that the composited area changed. If the background looks the same
+ * all along the viewport, the panel's pixels there are moved by @delta as
+ * well and only the uncovered strip is repainted, otherwise the whole
+ * viewport area is damaged (a single blit of the eventbox, applets don't
+ * repaint).
+ */
+static void
+awn_panel_damage_viewport(AwnPanel* panel, gint delta)
+{
+    AwnPanelPrivate* priv = panel->priv;
+    GdkWindow* win = gtk_widget_get_window(GTK_WIDGET(panel));
+    GtkAllocation eb_alloc;
+    GdkRectangle rect, area;
+    GdkRegion* region;
+    gint cap;
+
+    if (!win || !priv->composited) {
+        return;
+    }
+
+    gtk_widget_get_allocation(priv->eventbox, &eb_alloc);
+    gtk_widget_get_allocation(priv->viewport, &rect);
+    rect.x += eb_alloc.x;
+    rect.y += eb_alloc.y;
+
+    if (!awn_background_get_slice_cap(priv->bg, priv->position, &cap)) {
+        gdk_window_invalidate_rect(win, &rect, FALSE);
+        return;
+    }
+
+    // the ends of the background don't move with the applets
+    awn_panel_get_draw_rect(panel, &area, 0, 0);
     switch (priv->position) {
     case GTK_POS_TOP:
     case GTK_POS_BOTTOM:
-        adj = gtk_viewport_get_hadjustment(GTK_VIEWPORT(priv->viewport));
-        max = gtk_adjustment_get_upper(adj) - alloc.width;
+        if (rect.x < area.x + cap ||
+                rect.x + rect.width > area.x + area.width - cap ||
+                ABS(delta) >= rect.width) {
+            gdk_window_invalidate_rect(win, &rect, FALSE);
+            return;
+        }
+        region = gdk_region_rectangle(&rect);
+        gdk_window_move_region(win, region, -delta, 0);
         break;
     default:
-        adj = gtk_viewport_get_vadjustment(GTK_VIEWPORT(priv->viewport));
-        max = gtk_adjustment_get_upper(adj) - alloc.height;
+        if (rect.y < area.y + cap ||
+                rect.y + rect.height > area.y + area.height - cap ||
+                ABS(delta) >= rect.height) {
+            gdk_window_invalidate_rect(win, &rect, FALSE);
+            return;
+        }
+        region = gdk_region_rectangle(&rect);
+        gdk_window_move_region(win, region, 0, -delta);
         break;
     }
-    value = CLAMP(gtk_adjustment_get_value(adj) + 8 * mult, 0.0, max);
-    gtk_adjustment_set_value(adj, value);
+    // invalidates the part of the viewport which got uncovered
+    gdk_region_destroy(region);
+}
 
-    // without this there'll be artifacts
-    awn_applet_manager_redraw_throbbers(AWN_APPLET_MANAGER(priv->manager));
+static gboolean
+awn_panel_scroll_timer(AwnPanel* panel)
+{
+    gdouble max, now, dt, target, time_const, value, old_value;
+    GtkAdjustment* adj;
+    g_return_val_if_fail(AWN_IS_PANEL(panel), FALSE);
+    AwnPanelPrivate* priv = AWN_PANEL_GET_PRIVATE(panel);
+
+    now = awn_panel_get_time(panel);
+    dt = CLAMP(now - priv->scroll_last_time, 0.0, 0.1);
+    priv->scroll_last_time = now;
+
+    // ease the velocity towards its target
+    target = priv->scroll_direction * SCROLL_MAX_VELOCITY;
+    time_const = priv->scroll_direction ? SCROLL_ACCEL_TIME : SCROLL_DECEL_TIME;
+    priv->scroll_velocity += (target - priv->scroll_velocity) *
+                             (1.0 - exp(-dt / time_const));
+
+    adj = awn_panel_get_scroll_adjustment(panel, &max);
+    priv->scroll_position = CLAMP(priv->scroll_position +
+                                  priv->scroll_velocity * dt, 0.0, max);
+    value = round(priv->scroll_position);
 
-    if ((inc && value >= max) || (!inc && value <= 0.0)) {
+    old_value = gtk_adjustment_get_value(adj);
+    if (value != old_value) {
+        gtk_adjustment_set_value(adj, value);
+        awn_panel_damage_viewport(panel, (gint)(value - old_value));
+    }
+
+    if ((priv->scroll_velocity > 0.0 && priv->scroll_position >= max) ||
+            (priv->scroll_velocity < 0.0 && priv->scroll_position <= 0.0) ||
+            (priv->scroll_direction == 0 &&
+             fabs(priv->scroll_velocity) < SCROLL_MIN_VELOCITY)) {
+        priv->scroll_velocity = 0.0;
         priv->scroll_timer_id = 0;
         return FALSE;
     }
@@ -2145,17 +2407,31 @@ awn_panel_scroll_timer(AwnPanel* panel)
     return TRUE;
 }
 
-static gboolean
-awn_panel_arrow_over(AwnPanel* panel, GdkEventCrossing* event,
-                     GtkWidget* icon)
+static void
+awn_panel_start_scrolling(AwnPanel* panel)
 {
     AwnPanelPrivate* priv = panel->priv;
+    gdouble max;
 
-    g_object_set_data(G_OBJECT(panel), "scrolled-icon", icon);
     if (priv->scroll_timer_id == 0) {
+        GtkAdjustment* adj = awn_panel_get_scroll_adjustment(panel, &max);
+
+        priv->scroll_last_time = awn_panel_get_time(panel);
+        priv->scroll_position = gtk_adjustment_get_value(adj);
         priv->scroll_timer_id =
-            g_timeout_add(40, (GSourceFunc)awn_panel_scroll_timer, panel);
+            g_timeout_add(SCROLL_INTERVAL, (GSourceFunc)awn_panel_scroll_timer,
+                          panel);
     }
+}
+
+static gboolean
+awn_panel_arrow_over(AwnPanel* panel, GdkEventCrossing* event,
+                     GtkWidget* icon)
+{
+    AwnPanelPrivate* priv = panel->priv;
+
+    priv->scroll_direction = icon == priv->arrow1 ? -1 : 1;
+    awn_panel_start_scrolling(panel);
 
     return FALSE;
 }
@@ -2166,14 +2442,92 @@ awn_panel_arrow_out(AwnPanel* panel, GdkEventCrossing* event,
 {
     AwnPanelPrivate* priv = panel->priv;
 
-    if (priv->scroll_timer_id != 0) {
-        g_source_remove(priv->scroll_timer_id);
-        priv->scroll_timer_id = 0;
-    }
+    // keep the timer, it slows the scrolling down
+    priv->scroll_direction = 0;
 
     return FALSE;
 }
 
+static gboolean
+awn_panel_wheel_scroll(AwnPanel* panel, guint button)
+{
+    AwnPanelPrivate* priv = panel->priv;
+
+    if (!gtk_widget_get_visible(priv->arrow1)) {
+        return FALSE;
+    }
+
+    switch (button) {
+    case 4: // up
+    case 6: // left
+        priv->scroll_velocity -= SCROLL_WHEEL_IMPULSE;
+        break;
+    case 5: // down
+    case 7: // right
+        priv->scroll_velocity += SCROLL_WHEEL_IMPULSE;
+        break;
+    default:
+        return FALSE;
+    }
+
+    // touchpads send many events quickly, don't let them run away
+    priv->scroll_velocity = CLAMP(priv->scroll_velocity,
+                                  -2 * SCROLL_MAX_VELOCITY,
+                                  2 * SCROLL_MAX_VELOCITY);
+    awn_panel_start_scrolling(panel);
+
+    return TRUE;
+}
+
+/*
+ * The applets are GtkPlugs of other processes, so wheel events over them
+ * are never seen by the viewport. The panel window holds a synchronous
+ * passive grab of the wheel buttons instead, which freezes the pointer
+ * until we decide: an overflowing panel scrolls, otherwise the event is
+ * replayed to the window under the pointer as if the grab wasn't there.
+ */
+static GdkFilterReturn
+awn_panel_wheel_filter(GdkXEvent* xevent, GdkEvent* event, AwnPanel* panel)
+{
+    XButtonEvent* xbutton = (XButtonEvent*)xevent;
+
+    if (xbutton->type != ButtonPress ||
+            xbutton->button < 4 || xbutton->button > 7) {
+        return GDK_FILTER_CONTINUE;
+    }
+
+    if (awn_panel_wheel_scroll(panel, xbutton->button)) {
+        // the release goes to the panel window too, GDK ignores it
+        XAllowEvents(xbutton->display, AsyncPointer, xbutton->time);
+    } else {
+        XAllowEvents(xbutton->display, ReplayPointer, xbutton->time);
+    }
+
+    return GDK_FILTER_REMOVE;
+}
+
+static void
+awn_panel_grab_wheel(AwnPanel* panel, gpointer data)
+{
+    GdkWindow* win = gtk_widget_get_window(GTK_WIDGET(panel));
+    Display* dpy = GDK_WINDOW_XDISPLAY(win);
+    guint button;
+
+    gdk_window_add_filter(win, (GdkFilterFunc)awn_panel_wheel_filter, panel);
+
+    gdk_error_trap_push();
+    for (button = 4; button <= 7; button++) {
+        XGrabButton(dpy, button, AnyModifier, GDK_WINDOW_XID(win), False,
+                    ButtonPressMask | ButtonReleaseMask,
+                    GrabModeSync, GrabModeAsync, None, None);
+    }
+    gdk_flush();
+    if (gdk_error_trap_pop()) {
+        g_warning("Unable to grab the mouse wheel, scrolling the panel "
+                  "won't work over applets");
+    }
+}
+
 gint
 awn_panel_get_glow_size(AwnPanel* panel)
 {
@@ -2200,6 +2554,9 @@ awn_panel_init(AwnPanel* panel)
     priv->inhibits = g_hash_table_new_full(g_direct_hash, g_direct_equal,
                                            NULL, free_inhibit_item);
 
+    // every watcher handler of ours is connected with awn_dbus_watcher_connect
+    awn_dbus_watcher_set_filtered(awn_dbus_watcher_get_default(), TRUE);
+
     gtk_widget_set_app_paintable(GTK_WIDGET(panel), TRUE);
 
     /*
@@ -2268,6 +2625,8 @@ awn_panel_init(AwnPanel* panel)
                      G_CALLBACK(on_mouse_over), NULL);
     g_signal_connect(panel, "leave-notify-event",
                      G_CALLBACK(on_mouse_out), NULL);
+    g_signal_connect(panel, "realize",
+                     G_CALLBACK(awn_panel_grab_wheel), NULL);
     awn_utils_ensure_transparent_bg(GTK_WIDGET(panel));
     gtk_window_set_resizable(GTK_WINDOW(panel), FALSE);
 }
@@ -2453,9 +2812,9 @@ on_composited_changed(GtkWidget* widget, gpointer data)
  * receive events in the blank space above the main window
  */
 static void
-awn_panel_update_masks(GtkWidget* panel,
-                       gint       real_width,
-                       gint       real_height)
+awn_panel_rebuild_masks(GtkWidget* panel,
+                        gint       real_width,
+                        gint       real_height)
 {
     AwnPanelPrivate* priv;
     GtkAllocation   alloc;
@@ -2474,12 +2833,47 @@ awn_panel_update_masks(GtkWidget* panel,
         real_height = alloc.height;
     }
 
+    if (priv->autohide_snapshot && priv->composited) {
+        // the input shape is restored when the autohide fade in finishes
+        return;
+    }
+
     if (priv->clickthrough && priv->composited) {
         GdkRegion* region = gdk_region_new();
         GdkWindow* win = gtk_widget_get_window(GTK_WIDGET(panel));
         gdk_window_input_shape_combine_region(win, region, 0, 0);
         gdk_region_destroy(region);
+        memset(&priv->masks_key, 0, sizeof(AwnPanelMaskKey));
     } else {
+        AwnPanelMaskKey key;
+        GdkRectangle area;
+
+        memset(&key, 0, sizeof(AwnPanelMaskKey));
+        GdkRegion* region = awn_panel_get_mask(AWN_PANEL(panel), &key);
+        awn_panel_get_draw_rect(AWN_PANEL(panel), &area,
+                                real_width, real_height);
+
+        key.window = gtk_widget_get_window(GTK_WIDGET(panel));
+        key.bg = priv->bg;
+        key.bg_serial = priv->bg_serial;
+        key.width = real_width;
+        key.height = real_height;
+        key.area = area;
+        key.position = priv->position;
+        key.size = priv->size;
+        key.offset = priv->offset;
+        key.offset_mod = priv->offset_mod;
+        key.path_type = priv->path_type;
+        key.composited = priv->composited;
+
+        if (key.window &&
+                memcmp(&key, &priv->masks_key, sizeof(AwnPanelMaskKey)) == 0) {
+            // same shape as the one the X server already has
+            gdk_region_destroy(region);
+            return;
+        }
+        priv->masks_key = key;
+
         shaped_bitmap = (GdkBitmap*)gdk_pixmap_new(NULL,
                         real_width, real_height, 1);
 
@@ -2492,9 +2886,6 @@ awn_panel_update_masks(GtkWidget* panel,
 
         cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
 
-        GdkRectangle area;
-        awn_panel_get_draw_rect(AWN_PANEL(panel), &area,
-                                real_width, real_height);
         /* Set the input shape of the window if the window is composited */
         if (priv->composited) {
             awn_background_get_input_shape_mask(priv->bg, cr, priv->position, &area);
@@ -2508,7 +2899,6 @@ awn_panel_update_masks(GtkWidget* panel,
         cairo_set_operator(cr, CAIRO_OPERATOR_ADD);
         cairo_set_source_rgb(cr, 1.0f, 1.0f, 1.0f);
 
-        GdkRegion* region = awn_panel_get_mask(AWN_PANEL(panel));
         gdk_cairo_region(cr, region);
         cairo_fill(cr);
         gdk_region_destroy(region);
@@ -2533,6 +2923,15 @@ awn_panel_update_masks(GtkWidget* panel,
     }
 }
 
+static void
+awn_panel_update_masks(GtkWidget* panel,
+                       gint       real_width,
+                       gint       real_height)
+{
+    AWN_STATS_TIME(AWN_STATS_PANEL_MASKS,
+                   awn_panel_rebuild_masks(panel, real_width, real_height));
+}
+
 static gboolean
 masks_update_scheduler(AwnPanel* panel)
 {
@@ -2552,6 +2951,11 @@ awn_panel_queue_masks_update(AwnPanel* panel)
 {
     AwnPanelPrivate* priv = panel->priv;
 
+    // the resize animation queues the update once it settles
+    if (priv->resize_timer_id) {
+        return;
+    }
+
     if (priv->masks_update_id == 0) {
         priv->masks_update_id = g_idle_add((GSourceFunc)masks_update_scheduler,
                                            panel);
@@ -2700,12 +3104,13 @@ on_eb_expose(GtkWidget* eb, GdkEventExpose* event, AwnPanel* panel)
  * Draw the panel
  */
 static gboolean
-awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
+awn_panel_paint(GtkWidget* widget, GdkEventExpose* event)
 {
     AwnPanelPrivate* priv;
     cairo_t*         cr;
     GtkWidget*       child;
     GdkWindow*       win;
+    gboolean         fading_in;
 
     g_return_val_if_fail(AWN_IS_PANEL(widget), FALSE);
     priv = AWN_PANEL(widget)->priv;
@@ -2730,6 +3135,25 @@ awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
     gdk_cairo_region(cr, event->region);
     cairo_clip(cr);
 
+    if (priv->autohide_snapshot) {
+        /* autohide fade in progress, the children are left alone */
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_set_source_surface(cr, priv->autohide_snapshot, 0, 0);
+        cairo_paint_with_alpha(cr, priv->autohide_alpha);
+        cairo_destroy(cr);
+
+        return TRUE;
+    }
+
+    /* autohide fade in after the panel was hidden, paint everything as
+     * usual and blend it in */
+    fading_in = priv->hiding_timer_id != 0 && !priv->autohide_hiding;
+    if (fading_in) {
+        cairo_push_group(cr);
+    }
+
     /* The actual drawing of the background
     cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
     cairo_paint (cr); */
@@ -2771,7 +3195,8 @@ awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
         // enable to see the mask AppletManager uses
         GdkRegion* region;
         region = awn_applet_manager_get_mask(AWN_APPLET_MANAGER(priv->manager),
-                                             priv->path_type, priv->offset_mod);
+                                             priv->path_type, priv->offset_mod,
+                                             NULL);
         cairo_save(cr);
         cairo_set_source_rgba(cr, 0.0, 1.0, 0.3, 0.4);
         gdk_cairo_region(cr, region);
@@ -2784,6 +3209,11 @@ awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
     /* Pass on the expose event to the child */
     child = gtk_bin_get_child(GTK_BIN(widget));
     if (!GTK_IS_WIDGET(child)) {
+        if (fading_in) {
+            cairo_pop_group_to_source(cr);
+            cairo_paint_with_alpha(cr, priv->autohide_alpha);
+        }
+        cairo_destroy(cr);
         return TRUE;
     }
 
@@ -2865,6 +3295,11 @@ awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
     }
 #endif
 
+    if (fading_in) {
+        cairo_pop_group_to_source(cr);
+        cairo_paint_with_alpha(cr, priv->autohide_alpha);
+    }
+
     cairo_destroy(cr);
 
 #ifdef DEBUG_DRAW_AREA
@@ -2914,6 +3349,17 @@ propagate:
     return TRUE;
 }
 
+static gboolean
+awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
+{
+    gboolean handled;
+
+    AWN_STATS_TIME(AWN_STATS_PANEL_EXPOSE,
+                   handled = awn_panel_paint(widget, event));
+
+    return handled;
+}
+
 
 static void
 awn_panel_add(GtkContainer* window, GtkWidget* widget)
@@ -2961,6 +3407,8 @@ on_theme_changed(AwnBackground* bg, AwnPanel* panel)
 {
     g_return_if_fail(AWN_IS_BACKGROUND(bg));
 
+    // the shape may have changed too
+    panel->priv->bg_serial++;
     gtk_widget_queue_draw(GTK_WIDGET(panel));
 }
 
@@ -3334,6 +3782,11 @@ on_manager_size_alloc(GtkWidget* manager, GtkAllocation* alloc,
 {
     AwnPanelPrivate* priv = panel->priv;
 
+    // both are deferred until a running resize animation settles
+    if (priv->resize_timer_id) {
+        return;
+    }
+
     if (priv->panel_mode && priv->animated_resize && !priv->expand) {
         awn_panel_queue_strut_update(panel);
     }
@@ -3601,9 +4054,10 @@ awn_panel_set_glow(AwnPanel* panel, const gchar* sender, gboolean activate)
     if (activate) {
         // watch the sender on dbus and remove the glow when it disappears
         gchar* detailed_signal = g_strdup_printf("name-disappeared::%s", sender);
-        g_signal_connect(awn_dbus_watcher_get_default(), detailed_signal,
-                         G_CALLBACK(dbus_glow_activator_lost),
-                         panel);
+        awn_dbus_watcher_connect(awn_dbus_watcher_get_default(),
+                                 detailed_signal,
+                                 G_CALLBACK(dbus_glow_activator_lost),
+                                 panel);
         g_free(detailed_signal);
     }
 
@@ -3718,10 +4172,10 @@ awn_panel_inhibit_autohide(AwnPanel* panel,
     // watch the sender on dbus and remove all its inhibits when it
     //   disappears (to be sure that we don't misbehave due to crashing app)
     gchar* detailed_signal = g_strdup_printf("name-disappeared::%s", sender);
-    g_signal_connect(awn_dbus_watcher_get_default(), detailed_signal,
-                     G_CALLBACK(dbus_inhibitor_lost),
-                     g_hash_table_lookup(priv->inhibits,
-                                         GINT_TO_POINTER(cookie)));
+    awn_dbus_watcher_connect(awn_dbus_watcher_get_default(), detailed_signal,
+                             G_CALLBACK(dbus_inhibitor_lost),
+                             g_hash_table_lookup(priv->inhibits,
+                                                 GINT_TO_POINTER(cookie)));
 
     g_free(detailed_signal);
 
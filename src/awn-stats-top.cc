@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * awn-stats: top-like view of the rendering statistics exported by the panel
+ * and every running applet (see libawn/awn-stats.cc), followed by their sum
+ * over all processes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <dbus/dbus.h>
+
+#include "libawn/awn-stats.h"
+
+static gint interval = 1;
+static gboolean enable = FALSE;
+static gboolean disable = FALSE;
+static gboolean reset = FALSE;
+static gboolean once = FALSE;
+
+static GOptionEntry entries[] = {
+    {
+        "interval", 'i', 0, G_OPTION_ARG_INT, &interval,
+        "Refresh interval in seconds (default 1)", "SECS"
+    },
+    {
+        "enable", 'e', 0, G_OPTION_ARG_NONE, &enable,
+        "Turn on collection in all processes first", NULL
+    },
+    {
+        "disable", 'd', 0, G_OPTION_ARG_NONE, &disable,
+        "Turn off collection in all processes and exit", NULL
+    },
+    {
+        "reset", 'r', 0, G_OPTION_ARG_NONE, &reset,
+        "Reset all counters first", NULL
+    },
+    {
+        "once", '1', 0, G_OPTION_ARG_NONE, &once,
+        "Print the accumulated totals once and exit", NULL
+    },
+    { NULL }
+};
+
+typedef struct {
+    guint64 count;
+    guint64 total_us;
+} Sample;
+
+/* "bus-name/counter" -> Sample from the previous refresh */
+static GHashTable* previous = NULL;
+
+typedef struct {
+    gchar* counter;
+    guint64 count;
+    guint64 total_us;
+    guint64 max_us;
+    guint64 dcount;
+    guint64 dtotal_us;
+} Total;
+
+/* Total of every counter over all processes, in the order first seen */
+static GSList* totals = NULL;
+
+static Total*
+get_total(const gchar* counter)
+{
+    GSList* iter;
+    Total* total;
+
+    for (iter = totals; iter != NULL; iter = iter->next) {
+        total = (Total*)iter->data;
+        if (strcmp(total->counter, counter) == 0) {
+            return total;
+        }
+    }
+
+    total = g_new0(Total, 1);
+    total->counter = g_strdup(counter);
+    totals = g_slist_append(totals, total);
+
+    return total;
+}
+
+static void
+free_total(Total* total)
+{
+    g_free(total->counter);
+    g_free(total);
+}
+
+/* the panel first, then the applets which registered with it */
+static GSList*
+list_stats_names(DBusConnection* connection)
+{
+    DBusMessage* msg;
+    DBusMessage* reply;
+    DBusMessageIter iter, array_iter;
+    GSList* names = NULL;
+
+    msg = dbus_message_new_method_call(AWN_STATS_DBUS_PANEL_NAME,
+                                       AWN_STATS_DBUS_PATH,
+                                       AWN_STATS_DBUS_INTERFACE,
+                                       "ListProcesses");
+    reply = dbus_connection_send_with_reply_and_block(connection, msg,
+            -1, NULL);
+    dbus_message_unref(msg);
+
+    if (reply == NULL) {
+        return NULL;
+    }
+
+    if (dbus_message_has_signature(reply, "as")) {
+        dbus_message_iter_init(reply, &iter);
+        dbus_message_iter_recurse(&iter, &array_iter);
+        while (dbus_message_iter_get_arg_type(&array_iter) ==
+                DBUS_TYPE_STRING) {
+            const gchar* name;
+
+            dbus_message_iter_get_basic(&array_iter, &name);
+            names = g_slist_prepend(names, g_strdup(name));
+            dbus_message_iter_next(&array_iter);
+        }
+    }
+    dbus_message_unref(reply);
+
+    names = g_slist_sort(names, (GCompareFunc)strcmp);
+
+    return g_slist_prepend(names, g_strdup(AWN_STATS_DBUS_PANEL_NAME));
+}
+
+static void
+call_simple(DBusConnection* connection, const gchar* name,
+            const gchar* method, gboolean* arg)
+{
+    DBusMessage* msg;
+    DBusMessage* reply;
+
+    msg = dbus_message_new_method_call(name, AWN_STATS_DBUS_PATH,
+                                       AWN_STATS_DBUS_INTERFACE, method);
+    if (arg) {
+        dbus_bool_t value = *arg;
+        dbus_message_append_args(msg, DBUS_TYPE_BOOLEAN, &value,
+                                 DBUS_TYPE_INVALID);
+    }
+
+    reply = dbus_connection_send_with_reply_and_block(connection, msg,
+            -1, NULL);
+    dbus_message_unref(msg);
+    if (reply) {
+        dbus_message_unref(reply);
+    }
+}
+
+static void
+print_process(DBusConnection* connection, const gchar* name, gdouble elapsed)
+{
+    DBusMessage* msg;
+    DBusMessage* reply;
+    DBusMessageIter iter, array_iter, struct_iter;
+    const gchar* process;
+    dbus_bool_t enabled;
+    Total* sum;
+
+    msg = dbus_message_new_method_call(name, AWN_STATS_DBUS_PATH,
+                                       AWN_STATS_DBUS_INTERFACE,
+                                       "GetStatistics");
+    reply = dbus_connection_send_with_reply_and_block(connection, msg,
+            -1, NULL);
+    dbus_message_unref(msg);
+
+    if (reply == NULL) {
+        return;
+    }
+
+    if (!dbus_message_has_signature(reply, "sba(sttt)")) {
+        dbus_message_unref(reply);
+        return;
+    }
+
+    dbus_message_iter_init(reply, &iter);
+    dbus_message_iter_get_basic(&iter, &process);
+    dbus_message_iter_next(&iter);
+    dbus_message_iter_get_basic(&iter, &enabled);
+    dbus_message_iter_next(&iter);
+
+    g_print("%s (%s)%s\n", process, name, enabled ? "" : " [disabled]");
+
+    dbus_message_iter_recurse(&iter, &array_iter);
+    while (dbus_message_iter_get_arg_type(&array_iter) == DBUS_TYPE_STRUCT) {
+        const gchar* counter;
+        dbus_uint64_t count, total, max;
+        Sample* last;
+        gchar* key;
+
+        dbus_message_iter_recurse(&array_iter, &struct_iter);
+        dbus_message_iter_get_basic(&struct_iter, &counter);
+        dbus_message_iter_next(&struct_iter);
+        dbus_message_iter_get_basic(&struct_iter, &count);
+        dbus_message_iter_next(&struct_iter);
+        dbus_message_iter_get_basic(&struct_iter, &total);
+        dbus_message_iter_next(&struct_iter);
+        dbus_message_iter_get_basic(&struct_iter, &max);
+        dbus_message_iter_next(&array_iter);
+
+        key = g_strdup_printf("%s/%s", name, counter);
+        last = (Sample*)g_hash_table_lookup(previous, key);
+        if (last == NULL) {
+            /* first sighting, rates start with the next refresh */
+            last = g_new0(Sample, 1);
+            last->count = count;
+            last->total_us = total;
+            g_hash_table_insert(previous, key, last);
+        } else {
+            g_free(key);
+        }
+
+        /* the counters were reset under our hands */
+        if (count < last->count) {
+            last->count = 0;
+            last->total_us = 0;
+        }
+
+        sum = get_total(counter);
+        sum->count += count;
+        sum->total_us += total;
+        sum->max_us = MAX(sum->max_us, max);
+        sum->dcount += count - last->count;
+        sum->dtotal_us += total - last->total_us;
+
+        if (once) {
+            g_print("  %-26s %12" G_GUINT64_FORMAT " %10.3f %10.3f\n",
+                    counter, (guint64)count,
+                    count ? total / 1000.0 / count : 0.0, max / 1000.0);
+        } else if (count > 0) {
+            guint64 dcount = count - last->count;
+            guint64 dtotal = total - last->total_us;
+
+            g_print("  %-26s %10.1f %10.3f %10.3f %12" G_GUINT64_FORMAT "\n",
+                    counter, dcount / elapsed,
+                    dcount ? dtotal / 1000.0 / dcount : 0.0,
+                    max / 1000.0, (guint64)count);
+        }
+
+        last->count = count;
+        last->total_us = total;
+    }
+
+    dbus_message_unref(reply);
+}
+
+static void
+print_totals(gdouble elapsed)
+{
+    GSList* iter;
+
+    g_print("all processes\n");
+
+    for (iter = totals; iter != NULL; iter = iter->next) {
+        Total* sum = (Total*)iter->data;
+
+        if (once) {
+            g_print("  %-26s %12" G_GUINT64_FORMAT " %10.3f %10.3f\n",
+                    sum->counter, sum->count,
+                    sum->count ? sum->total_us / 1000.0 / sum->count : 0.0,
+                    sum->max_us / 1000.0);
+        } else if (sum->count > 0) {
+            g_print("  %-26s %10.1f %10.3f %10.3f %12" G_GUINT64_FORMAT "\n",
+                    sum->counter, sum->dcount / elapsed,
+                    sum->dcount ? sum->dtotal_us / 1000.0 / sum->dcount : 0.0,
+                    sum->max_us / 1000.0, sum->count);
+        }
+
+        // summed up again on the next refresh
+        sum->count = sum->total_us = sum->max_us = 0;
+        sum->dcount = sum->dtotal_us = 0;
+    }
+}
+
+gint
+main(gint argc, gchar* argv[])
+{
+    GOptionContext* context;
+    DBusConnection* connection;
+    DBusError dbus_error;
+    GError* error = NULL;
+    GTimer* timer;
+    GSList* names;
+    GSList* iter;
+
+    context = g_option_context_new("- show rendering statistics of Awn");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free(context);
+
+    dbus_error_init(&dbus_error);
+    connection = dbus_bus_get(DBUS_BUS_SESSION, &dbus_error);
+    if (connection == NULL) {
+        g_printerr("Unable to connect to the session bus: %s\n",
+                   dbus_error.message);
+        dbus_error_free(&dbus_error);
+        return EXIT_FAILURE;
+    }
+
+    previous = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    timer = g_timer_new();
+
+    names = list_stats_names(connection);
+    for (iter = names; iter != NULL; iter = iter->next) {
+        gboolean value = !disable;
+
+        if (enable || disable) {
+            call_simple(connection, (gchar*)iter->data, "SetEnabled", &value);
+        }
+        if (reset) {
+            call_simple(connection, (gchar*)iter->data, "Reset", NULL);
+        }
+    }
+    g_slist_foreach(names, (GFunc)g_free, NULL);
+    g_slist_free(names);
+
+    if (disable) {
+        return EXIT_SUCCESS;
+    }
+
+    while (TRUE) {
+        gdouble elapsed = MAX(g_timer_elapsed(timer, NULL), 0.001);
+
+        g_timer_start(timer);
+
+        names = list_stats_names(connection);
+
+        if (!once) {
+            /* clear the terminal and home the cursor */
+            g_print("\033[H\033[2J");
+            g_print("  %-26s %10s %10s %10s %12s\n",
+                    "counter", "per sec", "avg ms", "max ms", "total");
+        } else {
+            g_print("  %-26s %12s %10s %10s\n",
+                    "counter", "total", "avg ms", "max ms");
+        }
+
+        if (names == NULL) {
+            g_print("No process exports statistics.\n");
+        }
+
+        for (iter = names; iter != NULL; iter = iter->next) {
+            print_process(connection, (gchar*)iter->data, elapsed);
+        }
+        if (names != NULL && names->next != NULL) {
+            print_totals(elapsed);
+        }
+        g_slist_foreach(names, (GFunc)g_free, NULL);
+        g_slist_free(names);
+
+        if (once) {
+            break;
+        }
+
+        g_usleep(MAX(interval, 1) * G_USEC_PER_SEC);
+    }
+
+    g_timer_destroy(timer);
+    g_hash_table_destroy(previous);
+    g_slist_foreach(totals, (GFunc)free_total, NULL);
+    g_slist_free(totals);
+    dbus_connection_unref(connection);
+
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include "awn-defines.h"
 #include "awn-throbber.h"
 
+#include "libawn/awn-throbber-sprite.h"
 #include "libawn/gseal-transition.h"
 
 extern "C" {
@@ -42,6 +43,7 @@ struct _AwnThrobberPrivate {
 
     gint        counter;
     guint       timer_id;
+    AwnThrobberSprite sprite;
 
     DesktopAgnosticConfigClient* client;
     DesktopAgnosticColor* fill_color;
@@ -63,9 +65,10 @@ awn_throbber_dispose(GObject* object)
     AwnThrobberPrivate* priv = AWN_THROBBER_GET_PRIVATE(object);
 
     if (priv->timer_id) {
-        g_source_remove(priv->timer_id);
+        awn_throbber_tick_remove(priv->timer_id);
         priv->timer_id = 0;
     }
+    awn_throbber_sprite_clear(&priv->sprite);
 
     G_OBJECT_CLASS(awn_throbber_parent_class)->dispose(object);
 }
@@ -157,6 +160,7 @@ awn_throbber_set_property(GObject*      object,
             g_object_unref(priv->fill_color);
         }
         priv->fill_color = g_value_dup_object(value);
+        awn_throbber_sprite_clear(&priv->sprite);
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
     case PROP_OUTLINE_COLOR:
@@ -164,6 +168,7 @@ awn_throbber_set_property(GObject*      object,
             g_object_unref(priv->outline_color);
         }
         priv->outline_color = g_value_dup_object(value);
+        awn_throbber_sprite_clear(&priv->sprite);
         gtk_widget_queue_draw(GTK_WIDGET(object));
         break;
     default:
@@ -234,44 +239,33 @@ awn_throbber_expose_event(GtkWidget* widget, GdkEventExpose* event)
 
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
-    // we'll paint to [0,0] - [1,1], so scale's needed
     g_object_get(G_OBJECT(widget), "icon-width", &w, "icon-height", &h, NULL);
-    cairo_scale(cr, w, h);
 
-    switch (priv->type) {
-    case AWN_THROBBER_TYPE_NORMAL: {
-        const gdouble RADIUS = 0.0625;
-        const gdouble DIST = 0.3;
-        const gdouble OTHER = DIST * 0.707106781; /* sqrt(2)/2 */
-        const gint COUNT = 8;
-        const gint counter = priv->counter;
+    if (priv->type == AWN_THROBBER_TYPE_NORMAL) {
+        gdouble fill[4], outline[4];
+
+        /* the frames are pre-rendered, the strip is only rebuilt when
+         * the size or the theme colors change */
+        desktop_agnostic_color_get_cairo_color(priv->fill_color,
+                                               &fill[0], &fill[1],
+                                               &fill[2], &fill[3]);
+        desktop_agnostic_color_get_cairo_color(priv->outline_color,
+                                               &outline[0], &outline[1],
+                                               &outline[2], &outline[3]);
+        awn_throbber_sprite_ensure(&priv->sprite, cr, w, h,
+                                   fill, outline, 1. / priv->size);
+        awn_throbber_sprite_paint(&priv->sprite, cr, priv->counter, 0, 0);
+
+        /* let effects know we're finished */
+        awn_effects_cairo_destroy(fx);
+
+        return TRUE;
+    }
 
-        cairo_set_line_width(cr, 1. / priv->size);
-        cairo_translate(cr, 0.5, 0.5);
-        cairo_scale(cr, 1, -1);
-
-#define PAINT_CIRCLE(cr, x, y, cnt) \
-awn_cairo_set_source_color_with_alpha_multiplier (cr, \
-priv->fill_color, ((counter+cnt) % COUNT) / (float)COUNT); \
-cairo_arc (cr, x, y, RADIUS, 0, 2*M_PI); \
-cairo_fill_preserve (cr); \
-awn_cairo_set_source_color_with_alpha_multiplier (cr, \
-priv->outline_color, ((counter+cnt) % COUNT) / (float)COUNT); \
-cairo_stroke (cr);
-
-        PAINT_CIRCLE(cr, 0, DIST, 0);
-        PAINT_CIRCLE(cr, OTHER, OTHER, 1);
-        PAINT_CIRCLE(cr, DIST, 0, 2);
-        PAINT_CIRCLE(cr, OTHER, -OTHER, 3);
-        PAINT_CIRCLE(cr, 0, -DIST, 4);
-        PAINT_CIRCLE(cr, -OTHER, -OTHER, 5);
-        PAINT_CIRCLE(cr, -DIST, 0, 6);
-        PAINT_CIRCLE(cr, -OTHER, OTHER, 7);
-
-#undef PAINT_CIRCLE
+    // we'll paint to [0,0] - [1,1], so scale's needed
+    cairo_scale(cr, w, h);
 
-        break;
-    }
+    switch (priv->type) {
     case AWN_THROBBER_TYPE_SAD_FACE: {
         cairo_set_line_width(cr, 0.03);
 
@@ -380,7 +374,7 @@ cairo_stroke (cr);
 }
 
 static gboolean
-awn_throbber_timeout(gpointer user_data)
+awn_throbber_tick(gpointer user_data)
 {
     AwnThrobberPrivate* priv = AWN_THROBBER_GET_PRIVATE(user_data);
 
@@ -398,10 +392,7 @@ awn_throbber_show(GtkWidget* widget, gpointer user_data)
     AwnThrobberPrivate* priv = AWN_THROBBER_GET_PRIVATE(widget);
 
     if (!priv->timer_id && priv->type == AWN_THROBBER_TYPE_NORMAL) {
-        // we want lower prio than HIGH_IDLE
-        priv->timer_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE,
-                                            100, awn_throbber_timeout,
-                                            widget, NULL);
+        priv->timer_id = awn_throbber_tick_add(100, awn_throbber_tick, widget);
     }
 }
 
@@ -411,7 +402,7 @@ awn_throbber_hide(GtkWidget* widget, gpointer user_data)
     AwnThrobberPrivate* priv = AWN_THROBBER_GET_PRIVATE(widget);
 
     if (priv->timer_id) {
-        g_source_remove(priv->timer_id);
+        awn_throbber_tick_remove(priv->timer_id);
         priv->timer_id = 0;
     }
 }
@@ -469,6 +460,7 @@ awn_throbber_init(AwnThrobber* throbber)
     priv->size = 50;
     priv->counter = 0;
     priv->type = AWN_THROBBER_TYPE_NORMAL;
+    priv->sprite.strip = NULL;
 
     g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(throbber)),
                  "effects", 0,
@@ -521,10 +513,8 @@ awn_throbber_set_type(AwnThrobber* throbber, AwnThrobberType type)
     switch (type) {
     case AWN_THROBBER_TYPE_NORMAL:
         if (!priv->timer_id && gtk_widget_get_mapped(GTK_WIDGET(throbber))) {
-            // we want lower prio than HIGH_IDLE
-            priv->timer_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE,
-                                                100, awn_throbber_timeout,
-                                                throbber, NULL);
+            priv->timer_id = awn_throbber_tick_add(100, awn_throbber_tick,
+                                                   throbber);
         }
         break;
     case AWN_THROBBER_TYPE_CLOSE_BUTTON:
@@ -533,7 +523,7 @@ awn_throbber_set_type(AwnThrobber* throbber, AwnThrobberType type)
         // no break;
     default:
         if (priv->timer_id) {
-            g_source_remove(priv->timer_id);
+            awn_throbber_tick_remove(priv->timer_id);
             priv->timer_id = 0;
         }
         break;
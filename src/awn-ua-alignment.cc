@@ -20,6 +20,7 @@
 
 /* awn-ua-alignment.c */
 #include <stdlib.h>
+#include <libawn/awn-config.h>
 #include <libawn/awn-utils.h>
 #include "libawn/gseal-transition.h"
 #include "awn-ua-alignment.h"
@@ -284,10 +285,10 @@ awn_ua_alignment_plug_removed(GtkWidget* socket, AwnUAAlignment* self)
 
     array = awn_utils_gslist_to_gvaluearray(ua_active_list);
 
-    desktop_agnostic_config_client_set_list(client,
-                                            AWN_GROUP_PANEL,
-                                            AWN_PANEL_UA_ACTIVE_LIST,
-                                            array, NULL);
+    awn_config_set_list_deferred(client,
+                                 AWN_GROUP_PANEL,
+                                 AWN_PANEL_UA_ACTIVE_LIST,
+                                 array);
 
     g_value_array_free(array);
 
@@ -218,3 +218,110 @@ xutils_is_window_minimized(GdkWindow* window)
     return result;
 }
 
+
+/* xutils_get_window_region_at:
+ * @display: the display
+ * @x: root x coordinate
+ * @y: root y coordinate
+ * @ignore: toplevel window to treat as unmapped (or None)
+ *
+ * Finds the deepest viewable window at the given point and returns the part
+ * of the screen where it is visible, in root coordinates - the pointer can
+ * move anywhere inside the region without entering a different window.
+ * Over the bare root window, the region covers the screen minus all mapped
+ * toplevels.
+ */
+GdkRegion*
+xutils_get_window_region_at(GdkDisplay* display, gint x, gint y,
+                            GdkNativeWindow ignore)
+{
+    Display* xdisplay = GDK_DISPLAY_XDISPLAY(display);
+    Window parent = GDK_ROOT_WINDOW();
+    Window root_ret, parent_ret;
+    Window* children;
+    unsigned int n_children;
+    XWindowAttributes attrs;
+    GdkRectangle rect;
+    GdkRegion* region;
+    GArray* rects;
+    gint origin_x = 0, origin_y = 0;
+
+    gdk_error_trap_push();
+
+    XGetWindowAttributes(xdisplay, parent, &attrs);
+    rect.x = 0;
+    rect.y = 0;
+    rect.width = attrs.width;
+    rect.height = attrs.height;
+    region = gdk_region_rectangle(&rect);
+
+    rects = g_array_new(FALSE, FALSE, sizeof(GdkRectangle));
+
+    while (XQueryTree(xdisplay, parent, &root_ret, &parent_ret,
+                      &children, &n_children)) {
+        Window hit = None;
+        gint hit_index = -1;
+        gint hit_x = 0, hit_y = 0;
+
+        g_array_set_size(rects, 0);
+
+        // children are sorted bottom to top, the last one containing
+        // the point is the one the pointer is in
+        for (unsigned int i = 0; i < n_children; i++) {
+            if (children[i] == ignore ||
+                    !XGetWindowAttributes(xdisplay, children[i], &attrs) ||
+                    attrs.map_state != IsViewable) {
+                continue;
+            }
+
+            rect.x = origin_x + attrs.x;
+            rect.y = origin_y + attrs.y;
+            rect.width = attrs.width + attrs.border_width * 2;
+            rect.height = attrs.height + attrs.border_width * 2;
+            g_array_append_val(rects, rect);
+
+            if (x >= rect.x && x < rect.x + rect.width &&
+                    y >= rect.y && y < rect.y + rect.height) {
+                hit = children[i];
+                hit_index = rects->len - 1;
+                hit_x = rect.x + attrs.border_width;
+                hit_y = rect.y + attrs.border_width;
+            }
+        }
+
+        if (children) {
+            XFree(children);
+        }
+
+        if (hit != None) {
+            GdkRegion* hit_region =
+                gdk_region_rectangle(&g_array_index(rects, GdkRectangle,
+                                     hit_index));
+            gdk_region_intersect(region, hit_region);
+            gdk_region_destroy(hit_region);
+        }
+
+        // windows stacked above the hit (or all children, if the pointer is
+        // directly in the parent) cover parts of it
+        for (guint i = hit_index + 1; i < rects->len; i++) {
+            GdkRegion* above =
+                gdk_region_rectangle(&g_array_index(rects, GdkRectangle, i));
+            gdk_region_subtract(region, above);
+            gdk_region_destroy(above);
+        }
+
+        if (hit == None) {
+            break;
+        }
+
+        parent = hit;
+        origin_x = hit_x;
+        origin_y = hit_y;
+    }
+
+    g_array_free(rects, TRUE);
+
+    gdk_error_trap_pop();
+
+    return region;
+}
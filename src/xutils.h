@@ -43,6 +43,11 @@ GdkWindow* xutils_get_window_at_pointer(GdkDisplay* gdk_display);
 
 gboolean   xutils_is_window_minimized(GdkWindow* window);
 
+GdkRegion* xutils_get_window_region_at(GdkDisplay*     display,
+                                       gint            x,
+                                       gint            y,
+                                       GdkNativeWindow ignore);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Sweeps the panel length for every background style and position and
+ * compares the cached drawing - assembled from the pre-rendered end caps
+ * and middle strip where the style allows it - with a direct call of the
+ * style's draw function. Also checks that the tile is rendered only once
+ * for the whole sweep. Needs an X server for the panel, so runs on
+ * a private Xvfb server.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+#include "libawn/awn-stats.h"
+
+#include "src/awn-panel.h"
+#include "src/awn-background.h"
+#include "src/awn-background-3d.h"
+#include "src/awn-background-curves.h"
+#include "src/awn-background-edgy.h"
+#include "src/awn-background-flat.h"
+#include "src/awn-background-floaty.h"
+#include "src/awn-background-lucido.h"
+
+#include "test-utils.h"
+
+#define THICKNESS 60
+#define OFFSET 8
+#define MARGIN 16
+#define MIN_LENGTH 64
+#define MAX_LENGTH 640
+#define LENGTH_STEP 23
+
+static const struct {
+    const gchar* name;
+    GType (*get_type)(void);
+    gboolean sliced;
+} backgrounds[] = {
+    { "flat",   awn_background_flat_get_type,   TRUE },
+    { "3d",     awn_background_3d_get_type,     TRUE },
+    { "curves", awn_background_curves_get_type, FALSE },
+    { "edgy",   awn_background_edgy_get_type,   FALSE },
+    { "floaty", awn_background_floaty_get_type, TRUE },
+    { "lucido", awn_background_lucido_get_type, FALSE }
+};
+
+static const GtkPositionType positions[] = {
+    GTK_POS_BOTTOM, GTK_POS_TOP, GTK_POS_LEFT, GTK_POS_RIGHT
+};
+
+static const gchar* position_names[] = {
+    "left", "right", "top", "bottom"
+};
+
+static cairo_surface_t*
+render(AwnBackground* bg, GtkPositionType position, GdkRectangle* area,
+       gboolean cached)
+{
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         area->x + area->width + MARGIN,
+                                         area->y + area->height + MARGIN);
+    cr = cairo_create(surface);
+
+    bg->cache_enabled = cached;
+    awn_background_invalidate(bg);
+    awn_background_draw(bg, cr, position, area);
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    return surface;
+}
+
+static gint
+max_difference(cairo_surface_t* a, cairo_surface_t* b)
+{
+    guchar* data_a = cairo_image_surface_get_data(a);
+    guchar* data_b = cairo_image_surface_get_data(b);
+    gint stride = cairo_image_surface_get_stride(a);
+    gint width = cairo_image_surface_get_width(a);
+    gint height = cairo_image_surface_get_height(a);
+    gint x, y, diff = 0;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width * 4; x++) {
+            gint d = abs(data_a[y * stride + x] - data_b[y * stride + x]);
+            diff = MAX(diff, d);
+        }
+    }
+
+    return diff;
+}
+
+static void
+sweep(const gchar* name, AwnBackground* bg, GtkPositionType position,
+      gboolean sliced)
+{
+    gboolean vertical = position == GTK_POS_LEFT || position == GTK_POS_RIGHT;
+    GdkRectangle area;
+    gint length;
+
+    awn_stats_reset();
+
+    for (length = MIN_LENGTH; length <= MAX_LENGTH; length += LENGTH_STEP) {
+        cairo_surface_t* cached;
+        cairo_surface_t* direct;
+        gint diff;
+
+        area.x = vertical ? 0 : OFFSET;
+        area.y = vertical ? OFFSET : 0;
+        area.width = vertical ? THICKNESS : length;
+        area.height = vertical ? length : THICKNESS;
+
+        cached = render(bg, position, &area, TRUE);
+        direct = render(bg, position, &area, FALSE);
+
+        diff = max_difference(cached, direct);
+        CHECK(diff == 0, "%s/%s/%d: pixels differ by %d", name,
+              position_names[position], length, diff);
+
+        cairo_surface_destroy(cached);
+        cairo_surface_destroy(direct);
+    }
+
+    if (sliced) {
+        CHECK(awn_stats_get_count(AWN_STATS_BACKGROUND_TILE_RENDER) == 1,
+              "%s/%s: tile rendered %" G_GUINT64_FORMAT " times", name,
+              position_names[position],
+              awn_stats_get_count(AWN_STATS_BACKGROUND_TILE_RENDER));
+        CHECK(awn_stats_get_count(AWN_STATS_BACKGROUND_TILE_BLIT) > 0,
+              "%s/%s: never drawn from the tile", name,
+              position_names[position]);
+    } else {
+        CHECK(awn_stats_get_count(AWN_STATS_BACKGROUND_TILE_BLIT) == 0,
+              "%s/%s: drawn from a tile", name, position_names[position]);
+    }
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    DesktopAgnosticConfigClient* client;
+    GtkWidget* panel;
+    guint b, p;
+
+    test_start_xvfb();
+
+    gtk_init(&argc, &argv);
+
+    panel = awn_panel_new_with_panel_id(AWN_PANEL_ID_DEFAULT);
+    if (panel == NULL) {
+        test_skip("Unable to create the panel");
+    }
+    g_object_get(panel, "client", &client, NULL);
+
+    awn_stats_set_enabled(TRUE);
+
+    for (b = 0; b < G_N_ELEMENTS(backgrounds); b++) {
+        AwnBackground* bg;
+
+        bg = AWN_BACKGROUND(g_object_new(backgrounds[b].get_type(),
+                                         "client", client,
+                                         "panel", panel,
+                                         NULL));
+        /* the pattern and the perspective rule slicing out */
+        g_object_set(bg, "draw-pattern", FALSE, "panel-angle", 0.0, NULL);
+        /* the glow is only painted by the cached path */
+        bg->draw_glow = FALSE;
+
+        for (p = 0; p < G_N_ELEMENTS(positions); p++) {
+            sweep(backgrounds[b].name, bg, positions[p],
+                  backgrounds[b].sliced);
+        }
+
+        g_object_unref(bg);
+    }
+
+    g_object_unref(client);
+    gtk_widget_destroy(panel);
+
+    return test_finish(argv[0]);
+}
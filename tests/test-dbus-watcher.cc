@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2009 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Checks that plain detailed handlers work on an unfiltered AwnDBusWatcher,
+ * and that a filtered one only receives NameOwnerChanged signals for the
+ * names it watches. Runs against a private dbus-daemon, so it doesn't need
+ * (nor disturb) the session bus.
+ */
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <dbus/dbus.h>
+#include <dbus/dbus-glib.h>
+#include <dbus/dbus-glib-lowlevel.h>
+#include <libawn/libawn.h>
+
+#include "test-utils.h"
+
+#define TEST_PREFIX "org.awnproject.Test."
+#define WATCHED_NAME TEST_PREFIX "Watched"
+#define CHURN_NAMES 50
+
+static guint delivered = 0;
+static guint appeared = 0;
+static guint disappeared = 0;
+
+static DBusHandlerResult
+count_filter(DBusConnection* connection, DBusMessage* message, void* data)
+{
+    const gchar* name;
+
+    if (dbus_message_is_signal(message, DBUS_INTERFACE_DBUS,
+                               "NameOwnerChanged") &&
+            dbus_message_get_args(message, NULL,
+                                  DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_INVALID) &&
+            g_str_has_prefix(name, TEST_PREFIX)) {
+        delivered++;
+    }
+
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void
+on_appeared(AwnDBusWatcher* watcher, gchar* name, gpointer data)
+{
+    appeared++;
+}
+
+static void
+on_disappeared(AwnDBusWatcher* watcher, gchar* name, gpointer data)
+{
+    disappeared++;
+}
+
+static gboolean
+quit_loop(gpointer data)
+{
+    g_main_loop_quit((GMainLoop*)data);
+    return FALSE;
+}
+
+/* Make sure everything the bus sent us so far is dispatched. */
+static void
+sync_with_bus(AwnDBusWatcher* watcher)
+{
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+
+    // the reply comes after all the signals queued before it
+    awn_dbus_watcher_has_name(watcher, DBUS_SERVICE_DBUS);
+
+    g_timeout_add(100, quit_loop, loop);
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+}
+
+static void
+own_and_release(DBusConnection* other, const gchar* name)
+{
+    dbus_bus_request_name(other, name, DBUS_NAME_FLAG_DO_NOT_QUEUE, NULL);
+    dbus_bus_release_name(other, name, NULL);
+}
+
+static void
+churn(DBusConnection* other)
+{
+    gint i;
+
+    for (i = 0; i < CHURN_NAMES; i++) {
+        gchar* name = g_strdup_printf(TEST_PREFIX "Other%d", i);
+        own_and_release(other, name);
+        g_free(name);
+    }
+}
+
+static GPid
+start_bus(void)
+{
+    const gchar* argv[] = {
+        "dbus-daemon", "--session", "--nofork", "--print-address=1", NULL
+    };
+    GError* error = NULL;
+    GPid pid;
+    gint out_fd;
+    gchar address[1024];
+    gssize len = 0;
+
+    if (!g_spawn_async_with_pipes(NULL, (gchar**)argv, NULL,
+                                  G_SPAWN_SEARCH_PATH, NULL, NULL,
+                                  &pid, NULL, &out_fd, NULL, &error)) {
+        gchar* reason = g_strdup_printf("Unable to start dbus-daemon: %s",
+                                        error->message);
+        g_error_free(error);
+        test_skip(reason);
+    }
+
+    while (len < (gssize)sizeof(address) - 1) {
+        gssize r = read(out_fd, address + len, 1);
+        if (r <= 0 || address[len] == '\n') {
+            break;
+        }
+        len++;
+    }
+    address[len] = '\0';
+    close(out_fd);
+
+    g_setenv("DBUS_SESSION_BUS_ADDRESS", address, TRUE);
+
+    return pid;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    AwnDBusWatcher* watcher;
+    DBusGConnection* connection;
+    DBusConnection* other;
+    GPid bus_pid;
+    gulong handler;
+
+    g_type_init();
+
+    bus_pid = start_bus();
+
+    connection = dbus_g_bus_get(DBUS_BUS_SESSION, NULL);
+    g_assert(connection);
+    dbus_connection_add_filter(dbus_g_connection_get_connection(connection),
+                               count_filter, NULL, NULL);
+
+    other = dbus_bus_get_private(DBUS_BUS_SESSION, NULL);
+    g_assert(other);
+
+    watcher = awn_dbus_watcher_get_default();
+
+    /* 0) unfiltered, a plain g_signal_connect() is enough */
+    g_signal_connect(watcher, "name-appeared::" WATCHED_NAME,
+                     G_CALLBACK(on_appeared), NULL);
+    sync_with_bus(watcher);
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(appeared == 1, "unwatched name-appeared emitted %u times", appeared);
+    g_signal_handlers_disconnect_by_func(watcher,
+                                         (gpointer)G_CALLBACK(on_appeared),
+                                         NULL);
+    appeared = 0;
+
+    awn_dbus_watcher_set_filtered(watcher, TRUE);
+    sync_with_bus(watcher);
+
+    /* 1) nothing is watched -> nothing is delivered */
+    delivered = 0;
+    churn(other);
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(delivered == 0, "%u signals delivered with no watched names",
+          delivered);
+
+    /* 2) one watched name -> only its changes are delivered */
+    delivered = 0;
+    awn_dbus_watcher_connect(watcher, "name-appeared::" WATCHED_NAME,
+                             G_CALLBACK(on_appeared), NULL);
+    handler = awn_dbus_watcher_connect(watcher,
+                                       "name-disappeared::" WATCHED_NAME,
+                                       G_CALLBACK(on_disappeared), NULL);
+    sync_with_bus(watcher);
+
+    churn(other);
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(delivered == 2, "expected 2 delivered signals, got %u", delivered);
+    CHECK(appeared == 1, "name-appeared emitted %u times", appeared);
+    CHECK(disappeared == 1, "name-disappeared emitted %u times", disappeared);
+
+    /* 3) the rule stays while one handler is connected */
+    delivered = 0;
+    g_signal_handler_disconnect(watcher, handler);
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(delivered == 2, "rule removed too early (%u delivered)", delivered);
+    CHECK(appeared == 2, "name-appeared emitted %u times", appeared);
+    CHECK(disappeared == 1, "disconnected handler still called");
+
+    /* 4) ... and goes away with the last one */
+    delivered = 0;
+    g_signal_handlers_disconnect_by_func(watcher,
+                                         (gpointer)G_CALLBACK(on_appeared),
+                                         NULL);
+    sync_with_bus(watcher);
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(delivered == 0, "%u signals delivered after last disconnect",
+          delivered);
+
+    /* 5) explicit watches are reference counted */
+    awn_dbus_watcher_watch_name(watcher, WATCHED_NAME);
+    awn_dbus_watcher_watch_name(watcher, WATCHED_NAME);
+    awn_dbus_watcher_unwatch_name(watcher, WATCHED_NAME);
+    sync_with_bus(watcher);
+    delivered = 0;
+    own_and_release(other, WATCHED_NAME);
+    sync_with_bus(watcher);
+    CHECK(delivered == 2, "expected 2 delivered signals, got %u", delivered);
+    awn_dbus_watcher_unwatch_name(watcher, WATCHED_NAME);
+
+    dbus_connection_close(other);
+    dbus_connection_unref(other);
+    dbus_g_connection_unref(connection);
+
+    kill(bus_pid, SIGTERM);
+    g_spawn_close_pid(bus_pid);
+
+    return test_finish(argv[0]);
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Redraws parts of an AwnDialog the way live content does and checks that
+ * the chrome is only blitted, then that resizing renders it and rebuilds
+ * the shape mask once, moving the dialog does neither, and a colour change
+ * renders the chrome without touching the mask. Runs on a private Xvfb
+ * server.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+#include "libawn/awn-stats.h"
+
+#include "test-utils.h"
+
+#define REDRAWS 200
+#define WIDTH 240
+#define HEIGHT 160
+
+#define COUNT(counter) awn_stats_get_count(AWN_STATS_##counter)
+
+static void
+flush_events(void)
+{
+    gdk_display_sync(gdk_display_get_default());
+
+    while (gtk_events_pending()) {
+        gtk_main_iteration();
+    }
+}
+
+static void
+wait_for_size(GtkWidget* dialog, gint width, gint height)
+{
+    gint i;
+
+    for (i = 0; i < 100; i++) {
+        GtkAllocation alloc;
+
+        flush_events();
+        gtk_widget_get_allocation(dialog, &alloc);
+        if (alloc.width == width && alloc.height == height) {
+            break;
+        }
+        g_usleep(10000);
+    }
+    gdk_window_process_updates(dialog->window, TRUE);
+    flush_events();
+}
+
+static void
+redraw_content(GtkWidget* dialog, GtkWidget* content)
+{
+    GtkAllocation alloc;
+    gint i;
+
+    gtk_widget_get_allocation(content, &alloc);
+
+    for (i = 0; i < REDRAWS; i++) {
+        gtk_widget_queue_draw_area(dialog, alloc.x, alloc.y,
+                                   alloc.width, alloc.height);
+        gdk_window_process_updates(dialog->window, TRUE);
+        flush_events();
+    }
+}
+
+static void
+test_dialog(void)
+{
+    GtkWidget* dialog;
+    GtkWidget* content;
+    DesktopAgnosticColor* color;
+
+    dialog = awn_dialog_new();
+    gtk_window_set_title(GTK_WINDOW(dialog), "Chrome");
+    gtk_widget_set_size_request(dialog, WIDTH, HEIGHT);
+    content = gtk_drawing_area_new();
+    gtk_container_add(GTK_CONTAINER(dialog), content);
+    gtk_window_move(GTK_WINDOW(dialog), 10, 10);
+    gtk_widget_show_all(dialog);
+    wait_for_size(dialog, WIDTH, HEIGHT);
+
+    awn_stats_reset();
+
+    /* live content */
+    redraw_content(dialog, content);
+    CHECK(COUNT(DIALOG_CHROME_RENDER) == 0,
+          "chrome rendered %" G_GUINT64_FORMAT " times for content redraws",
+          COUNT(DIALOG_CHROME_RENDER));
+    CHECK(COUNT(DIALOG_CHROME_BLIT) >= REDRAWS,
+          "only %" G_GUINT64_FORMAT " blits for %d redraws",
+          COUNT(DIALOG_CHROME_BLIT), REDRAWS);
+    CHECK(COUNT(DIALOG_MASKS) == 0, "mask rebuilt for content redraws");
+
+    /* new size */
+    awn_stats_reset();
+    gtk_widget_set_size_request(dialog, WIDTH + 40, HEIGHT);
+    wait_for_size(dialog, WIDTH + 40, HEIGHT);
+    redraw_content(dialog, content);
+    CHECK(COUNT(DIALOG_CHROME_RENDER) == 1,
+          "chrome rendered %" G_GUINT64_FORMAT " times after a resize",
+          COUNT(DIALOG_CHROME_RENDER));
+    CHECK(COUNT(DIALOG_MASKS) == 1,
+          "mask rebuilt %" G_GUINT64_FORMAT " times after a resize",
+          COUNT(DIALOG_MASKS));
+
+    /* same size elsewhere */
+    awn_stats_reset();
+    gtk_window_move(GTK_WINDOW(dialog), 50, 30);
+    flush_events();
+    redraw_content(dialog, content);
+    CHECK(COUNT(DIALOG_CHROME_RENDER) == 0, "chrome rendered after a move");
+    CHECK(COUNT(DIALOG_MASKS) == 0, "mask rebuilt after a move");
+
+    /* theme change */
+    awn_stats_reset();
+    color = desktop_agnostic_color_new_from_string("#336699cc", NULL);
+    g_object_set(dialog, "dialog-bg", color, NULL);
+    g_object_unref(color);
+    gdk_window_process_updates(dialog->window, TRUE);
+    redraw_content(dialog, content);
+    CHECK(COUNT(DIALOG_CHROME_RENDER) == 1,
+          "chrome rendered %" G_GUINT64_FORMAT " times after a colour change",
+          COUNT(DIALOG_CHROME_RENDER));
+    CHECK(COUNT(DIALOG_MASKS) == 0, "mask rebuilt after a colour change");
+
+    gtk_widget_destroy(dialog);
+    flush_events();
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+
+    test_start_xvfb();
+
+    gtk_init(&argc, &argv);
+
+    awn_stats_set_enabled(TRUE);
+
+    test_dialog();
+
+    awn_stats_set_enabled(FALSE);
+
+    return test_finish(argv[0]);
+}
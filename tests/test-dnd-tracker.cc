@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Replays synthetic XDND sequences against a panel-like window tracked by
+ * AwnDndTracker and checks which window below it gets picked as the drop
+ * target, and that the window stack is only searched when the pointer
+ * moves into a different window. Runs on a private Xvfb server.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+#include "src/awn-dnd-tracker.h"
+
+#include "test-utils.h"
+
+/* the "other applications" live on their own connection */
+static Display* xdisplay = NULL;
+static Window source = None;
+
+static Window last_target = None;
+static GdkDragProtocol last_protocol = GDK_DRAG_PROTO_NONE;
+static guint changes = 0;
+
+static void
+on_target_changed(AwnDndTracker* tracker, GdkWindow* target,
+                  GdkDragProtocol protocol, gpointer data)
+{
+    last_target = target ? GDK_WINDOW_XID(target) : None;
+    last_protocol = protocol;
+    changes++;
+}
+
+static Window
+create_window(gint x, gint y, gint width, gint height, gboolean dnd_aware)
+{
+    XSetWindowAttributes attrs;
+    Window window;
+
+    attrs.override_redirect = True;
+    window = XCreateWindow(xdisplay, DefaultRootWindow(xdisplay),
+                           x, y, width, height, 0,
+                           CopyFromParent, InputOutput, CopyFromParent,
+                           CWOverrideRedirect, &attrs);
+
+    if (dnd_aware) {
+        Atom version = 5;
+        XChangeProperty(xdisplay, window,
+                        XInternAtom(xdisplay, "XdndAware", False),
+                        XA_ATOM, 32, PropModeReplace,
+                        (guchar*)&version, 1);
+    }
+
+    XMapWindow(xdisplay, window);
+
+    return window;
+}
+
+static void
+process_events(void)
+{
+    XSync(xdisplay, False);
+    gdk_display_sync(gdk_display_get_default());
+
+    while (gtk_events_pending()) {
+        gtk_main_iteration();
+    }
+}
+
+static void
+send_xdnd(Window panel, const gchar* type, glong l1, glong l2, glong l3,
+          glong l4)
+{
+    XEvent xev;
+
+    memset(&xev, 0, sizeof(xev));
+    xev.xclient.type = ClientMessage;
+    xev.xclient.window = panel;
+    xev.xclient.message_type = XInternAtom(xdisplay, type, False);
+    xev.xclient.format = 32;
+    xev.xclient.data.l[0] = source;
+    xev.xclient.data.l[1] = l1;
+    xev.xclient.data.l[2] = l2;
+    xev.xclient.data.l[3] = l3;
+    xev.xclient.data.l[4] = l4;
+
+    XSendEvent(xdisplay, panel, False, NoEventMask, &xev);
+    process_events();
+}
+
+static void
+send_enter(Window panel)
+{
+    send_xdnd(panel, "XdndEnter", 5 << 24,
+              XInternAtom(xdisplay, "text/uri-list", False), None, None);
+}
+
+static void
+send_position(Window panel, gint x, gint y)
+{
+    send_xdnd(panel, "XdndPosition", 0, (x << 16) | y, CurrentTime,
+              XInternAtom(xdisplay, "XdndActionCopy", False));
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    AwnDndTracker* tracker;
+    GtkWidget* panel;
+    Window panel_xid;
+    Window a, b, c;
+
+    test_start_xvfb();
+
+    gtk_init(&argc, &argv);
+
+    xdisplay = XOpenDisplay(NULL);
+    g_assert(xdisplay);
+
+    /*
+     *  +-------A-------+     +------B------+
+     *  |   +--C--+     |     | (not XDND   |
+     *  |   |     |     |     |  aware)     |
+     *  |   +-----+     |     |             |
+     *  +===============================panel
+     */
+    a = create_window(0, 0, 400, 768, TRUE);
+    b = create_window(600, 0, 424, 768, FALSE);
+    c = create_window(100, 100, 100, 100, TRUE);
+    source = XCreateSimpleWindow(xdisplay, DefaultRootWindow(xdisplay),
+                                 0, 0, 1, 1, 0, 0, 0);
+
+    panel = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(panel), 0, 700);
+    gtk_widget_set_size_request(panel, 1024, 68);
+    tracker = awn_dnd_tracker_new(panel, on_target_changed, NULL);
+    gtk_widget_show(panel);
+    process_events();
+
+    panel_xid = GDK_WINDOW_XID(gtk_widget_get_window(panel));
+
+    /* 1) the window below the panel is picked */
+    send_enter(panel_xid);
+    send_position(panel_xid, 50, 720);
+    CHECK(last_target == a, "expected A below the panel, got 0x%lx",
+          last_target);
+    CHECK(last_protocol == GDK_DRAG_PROTO_XDND, "A should use XDND");
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 1, "%u lookups",
+          awn_dnd_tracker_get_lookups(tracker));
+
+    /* 2) moving inside the same window doesn't search again */
+    send_position(panel_xid, 60, 730);
+    send_position(panel_xid, 390, 760);
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 1,
+          "searched %u times inside A", awn_dnd_tracker_get_lookups(tracker));
+    CHECK(changes == 1, "%u target changes", changes);
+
+    /* 3) entering a window stacked above A */
+    send_position(panel_xid, 150, 150);
+    CHECK(last_target == c, "expected C, got 0x%lx", last_target);
+    send_position(panel_xid, 120, 120);
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 2,
+          "searched %u times inside C", awn_dnd_tracker_get_lookups(tracker));
+
+    /* 4) back to A, but the part covered by C isn't A's */
+    send_position(panel_xid, 350, 150);
+    CHECK(last_target == a, "expected A again, got 0x%lx", last_target);
+    send_position(panel_xid, 150, 180);
+    CHECK(last_target == c, "C covers A, got 0x%lx", last_target);
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 4, "%u lookups",
+          awn_dnd_tracker_get_lookups(tracker));
+
+    /* 5) windows without XdndAware and the bare root aren't targets */
+    send_position(panel_xid, 700, 720);
+    CHECK(last_target == None, "B isn't XDND aware, got 0x%lx", last_target);
+    send_position(panel_xid, 500, 720);
+    CHECK(last_target == None, "root isn't a target, got 0x%lx", last_target);
+    send_position(panel_xid, 510, 710);
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 6,
+          "searched %u times above the root",
+          awn_dnd_tracker_get_lookups(tracker));
+
+    /* 6) leaving the panel drops the target */
+    send_position(panel_xid, 50, 50);
+    CHECK(last_target == a, "expected A, got 0x%lx", last_target);
+    changes = 0;
+    send_xdnd(panel_xid, "XdndLeave", 0, 0, 0, 0);
+    CHECK(last_target == None && changes == 1, "target kept after leave");
+
+    /* 7) a new drag starts from scratch, a drop ends it */
+    send_enter(panel_xid);
+    send_position(panel_xid, 50, 50);
+    CHECK(last_target == a, "expected A in a new drag, got 0x%lx",
+          last_target);
+    CHECK(awn_dnd_tracker_get_lookups(tracker) == 8, "%u lookups",
+          awn_dnd_tracker_get_lookups(tracker));
+    send_xdnd(panel_xid, "XdndDrop", 0, CurrentTime, 0, 0);
+    CHECK(last_target == None, "target kept after drop");
+
+    awn_dnd_tracker_free(tracker);
+    gtk_widget_destroy(panel);
+    XCloseDisplay(xdisplay);
+
+    return test_finish(argv[0]);
+}
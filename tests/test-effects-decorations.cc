@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Checks the pre-scaled and pre-rotated copies used for the custom arrow,
+ * active and spotlight images: a rotated copy painted at its offset has to
+ * match the original painted with a rotation, and a large downscale has to
+ * average the source instead of picking some of its pixels. Only image
+ * surfaces are used, so no X server is needed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libawn/libawn.h>
+#include "libawn/awn-effects-ops-helpers.h"
+
+#include "test-utils.h"
+
+#define CANVAS 64
+#define ARROW_WIDTH 11
+#define ARROW_HEIGHT 5
+
+/* asymmetric, so every rotation looks different */
+static cairo_surface_t*
+create_arrow(void)
+{
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         ARROW_WIDTH, ARROW_HEIGHT);
+    cr = cairo_create(surface);
+    cairo_set_source_rgba(cr, 0.9, 0.2, 0.1, 1.0);
+    cairo_rectangle(cr, 0, 0, ARROW_WIDTH, 2);
+    cairo_fill(cr);
+    cairo_set_source_rgba(cr, 0.1, 0.3, 0.8, 0.5);
+    cairo_rectangle(cr, 0, 2, 3, ARROW_HEIGHT - 2);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    return surface;
+}
+
+static cairo_surface_t*
+create_canvas(void)
+{
+    return cairo_image_surface_create(CAIRO_FORMAT_ARGB32, CANVAS, CANVAS);
+}
+
+static gint
+max_difference(cairo_surface_t* a, cairo_surface_t* b)
+{
+    guchar* data_a;
+    guchar* data_b;
+    gint stride, x, y, diff = 0;
+
+    cairo_surface_flush(a);
+    cairo_surface_flush(b);
+
+    data_a = cairo_image_surface_get_data(a);
+    data_b = cairo_image_surface_get_data(b);
+    stride = cairo_image_surface_get_stride(a);
+
+    for (y = 0; y < CANVAS; y++) {
+        for (x = 0; x < CANVAS * 4; x++) {
+            gint d = abs(data_a[y * stride + x] - data_b[y * stride + x]);
+            diff = MAX(diff, d);
+        }
+    }
+
+    return diff;
+}
+
+static void
+test_rotation(void)
+{
+    cairo_surface_t* arrow = create_arrow();
+    gint turns;
+
+    for (turns = 0; turns < 4; turns++) {
+        cairo_surface_t* expected = create_canvas();
+        cairo_surface_t* actual = create_canvas();
+        cairo_surface_t* rotated;
+        cairo_t* cr;
+        gint ox, oy, diff;
+
+        /* the way the arrow used to be painted */
+        cr = cairo_create(expected);
+        cairo_translate(cr, CANVAS / 2, CANVAS / 2);
+        cairo_rotate(cr, turns * M_PI / 2);
+        cairo_set_source_surface(cr, arrow, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        rotated = scale_rotate_surface(arrow, ARROW_WIDTH, ARROW_HEIGHT,
+                                       turns, &ox, &oy);
+        CHECK(cairo_image_surface_get_width(rotated) ==
+              (turns & 1 ? ARROW_HEIGHT : ARROW_WIDTH) &&
+              cairo_image_surface_get_height(rotated) ==
+              (turns & 1 ? ARROW_WIDTH : ARROW_HEIGHT),
+              "%d turns: wrong size of the rotated copy", turns);
+
+        cr = cairo_create(actual);
+        cairo_set_source_surface(cr, rotated, CANVAS / 2 + ox,
+                                 CANVAS / 2 + oy);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        diff = max_difference(expected, actual);
+        CHECK(diff == 0, "%d turns: pixels differ by %d", turns, diff);
+
+        cairo_surface_destroy(rotated);
+        cairo_surface_destroy(expected);
+        cairo_surface_destroy(actual);
+    }
+
+    cairo_surface_destroy(arrow);
+}
+
+static void
+test_downscale(void)
+{
+    cairo_surface_t* stripes;
+    cairo_surface_t* scaled;
+    cairo_t* cr;
+    guchar* data;
+    gint x, y, stride, worst = 0;
+
+    /* one pixel wide black and white columns */
+    stripes = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 256, 256);
+    cr = cairo_create(stripes);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_paint(cr);
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    for (x = 0; x < 256; x += 2) {
+        cairo_rectangle(cr, x, 0, 1, 256);
+    }
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    scaled = scale_rotate_surface(stripes, 16, 16, 0, NULL, NULL);
+    cairo_surface_flush(scaled);
+    data = cairo_image_surface_get_data(scaled);
+    stride = cairo_image_surface_get_stride(scaled);
+
+    /* the border is blended with the outside of the image */
+    for (y = 1; y < 15; y++) {
+        guint32* row = (guint32*)(data + y * stride);
+
+        for (x = 1; x < 15; x++) {
+            gint green = (row[x] >> 8) & 0xFF;
+            worst = MAX(worst, abs(green - 0x80));
+        }
+    }
+    CHECK(worst <= 8, "downscaled stripes aren't grey, off by %d", worst);
+
+    cairo_surface_destroy(scaled);
+    cairo_surface_destroy(stripes);
+}
+
+static void
+test_offsets(void)
+{
+    cairo_surface_t* arrow = create_arrow();
+    gint turns;
+
+    /* scaled, then rotated - the copy always starts at the offset */
+    for (turns = 0; turns < 4; turns++) {
+        cairo_surface_t* copy;
+        gint ox, oy, ex = 0, ey = 0;
+
+        copy = scale_rotate_surface(arrow, 40, 9, turns, &ox, &oy);
+        switch (turns) {
+        case 1:
+            ex = -9;
+            break;
+        case 2:
+            ex = -40;
+            ey = -9;
+            break;
+        case 3:
+            ey = -40;
+            break;
+        }
+        CHECK(ox == ex && oy == ey, "%d turns: offset %d,%d instead of %d,%d",
+              turns, ox, oy, ex, ey);
+        CHECK(cairo_image_surface_get_width(copy) == (turns & 1 ? 9 : 40),
+              "%d turns: wrong width", turns);
+
+        cairo_surface_destroy(copy);
+    }
+
+    cairo_surface_destroy(arrow);
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    test_rotation();
+    test_downscale();
+    test_offsets();
+
+    return test_finish(argv[0]);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Compares the single-pass extrusion used by the depth effect with the
+ * original implementation, which painted a copy of the icon once for every
+ * pixel of depth. Only image surfaces are used, so no X server is needed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libawn/libawn.h>
+#include "libawn/awn-effects-ops-helpers.h"
+
+#define ICON_SIZE 48
+#define WINDOW_WIDTH (ICON_SIZE + 16)
+#define WINDOW_HEIGHT (ICON_SIZE + 16)
+
+/* rounding of the intermediate composites differs a bit */
+#define TOLERANCE 4
+
+static gint failures = 0;
+
+static cairo_surface_t*
+create_icon(void)
+{
+    cairo_surface_t* surface;
+    cairo_pattern_t* pat;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         WINDOW_WIDTH, WINDOW_HEIGHT);
+    cr = cairo_create(surface);
+    cairo_translate(cr, (WINDOW_WIDTH - ICON_SIZE) / 2,
+                    WINDOW_HEIGHT - ICON_SIZE);
+
+    /* translucent gradient body with an opaque and a see-through part */
+    pat = cairo_pattern_create_linear(0, 0, ICON_SIZE, ICON_SIZE);
+    cairo_pattern_add_color_stop_rgba(pat, 0.0, 0.95, 0.6, 0.2, 1.0);
+    cairo_pattern_add_color_stop_rgba(pat, 1.0, 0.2, 0.3, 0.9, 0.4);
+    awn_cairo_rounded_rect(cr, ICON_SIZE * 0.1, ICON_SIZE * 0.1,
+                           ICON_SIZE * 0.8, ICON_SIZE * 0.8,
+                           ICON_SIZE * 0.15, ROUND_ALL);
+    cairo_set_source(cr, pat);
+    cairo_fill(cr);
+    cairo_pattern_destroy(pat);
+
+    cairo_arc(cr, ICON_SIZE / 2, ICON_SIZE / 2, ICON_SIZE / 6, 0, 2 * M_PI);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_fill(cr);
+
+    cairo_destroy(cr);
+
+    return surface;
+}
+
+static cairo_surface_t*
+copy_surface(cairo_surface_t* src)
+{
+    cairo_surface_t* copy;
+    cairo_t* cr;
+
+    copy = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                      WINDOW_WIDTH, WINDOW_HEIGHT);
+    cr = cairo_create(copy);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, src, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return copy;
+}
+
+/* the depth effect as it used to be - one paint per pixel of depth */
+static cairo_surface_t*
+extrude_reference(cairo_surface_t* icon, gint depth, gint direction,
+                  gboolean vertical)
+{
+    cairo_surface_t* result = copy_surface(icon);
+    cairo_t* cr = cairo_create(result);
+    double x = depth;
+    gint i, multiplier = direction ? 1 : -1;
+
+    x /= direction ? -2 : 2;
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    for (i = 1; i < depth; i++) {
+        double offset = x + (multiplier * (depth - i));
+
+        cairo_set_source_surface(cr, icon,
+                                 vertical ? 0 : offset,
+                                 vertical ? offset : 0);
+        cairo_paint(cr);
+    }
+    cairo_destroy(cr);
+
+    return result;
+}
+
+static cairo_surface_t*
+extrude_single_pass(cairo_surface_t* icon, gint depth, gint direction,
+                    gboolean vertical)
+{
+    cairo_surface_t* result = copy_surface(icon);
+    cairo_surface_t* face;
+    cairo_t* cr;
+    double x = depth;
+
+    x /= direction ? -2 : 2;
+
+    face = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                      WINDOW_WIDTH, WINDOW_HEIGHT);
+    extrude_surface(icon, face, depth, x, direction ? 1 : -1, vertical);
+
+    cr = cairo_create(result);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_set_source_surface(cr, face, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    cairo_surface_destroy(face);
+
+    return result;
+}
+
+static gint
+max_difference(cairo_surface_t* a, cairo_surface_t* b)
+{
+    guchar* data_a;
+    guchar* data_b;
+    gint stride, x, y, diff = 0;
+
+    cairo_surface_flush(a);
+    cairo_surface_flush(b);
+
+    data_a = cairo_image_surface_get_data(a);
+    data_b = cairo_image_surface_get_data(b);
+    stride = cairo_image_surface_get_stride(a);
+
+    for (y = 0; y < WINDOW_HEIGHT; y++) {
+        for (x = 0; x < WINDOW_WIDTH * 4; x++) {
+            gint d = abs(data_a[y * stride + x] - data_b[y * stride + x]);
+            diff = MAX(diff, d);
+        }
+    }
+
+    return diff;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    cairo_surface_t* icon;
+    gint depth, direction, vertical;
+
+    icon = create_icon();
+
+    for (depth = 1; depth <= 10; depth++) {
+        for (direction = 0; direction <= 1; direction++) {
+            for (vertical = 0; vertical <= 1; vertical++) {
+                cairo_surface_t* expected;
+                cairo_surface_t* actual;
+                gint diff;
+
+                expected = extrude_reference(icon, depth, direction, vertical);
+                actual = extrude_single_pass(icon, depth, direction, vertical);
+
+                diff = max_difference(expected, actual);
+                if (diff > TOLERANCE) {
+                    g_printerr("FAIL: depth %d, direction %d, %s: "
+                               "pixels differ by %d\n",
+                               depth, direction,
+                               vertical ? "vertical" : "horizontal", diff);
+                    failures++;
+                }
+
+                cairo_surface_destroy(expected);
+                cairo_surface_destroy(actual);
+            }
+        }
+    }
+
+    cairo_surface_destroy(icon);
+
+    if (failures == 0) {
+        g_print("PASS: %s\n", argv[0]);
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
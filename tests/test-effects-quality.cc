@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Feeds synthetic paint costs on a synthetic clock to the adaptive effects
+ * quality controller and checks when it steps down and back up.
+ */
+
+
+#include <libawn/libawn.h>
+#include "libawn/awn-effects-quality.h"
+#include "libawn/awn-stats.h"
+
+#include "test-utils.h"
+
+#define BUDGET 10000
+/* the effects animate at 25 frames per second */
+#define FRAME 40000
+
+#define HEAVY (BUDGET * 2)
+#define MEDIUM (BUDGET * 3 / 4)
+#define CHEAP (BUDGET / 4)
+
+static gint64 clock_us = 0;
+
+static void
+restart(void)
+{
+    awn_effects_quality_reset();
+    awn_effects_quality_set_budget(BUDGET);
+    clock_us = 0;
+}
+
+/* A frame is accounted once the first cost of the next one arrives, so
+ * after n calls n - 1 frames were judged.
+ */
+static void
+paint_frames(gint frames, gint icons, gint64 cost_per_icon)
+{
+    gint i, j;
+
+    for (i = 0; i < frames; i++) {
+        for (j = 0; j < icons; j++) {
+            awn_effects_quality_add_cost(clock_us + j * 100, cost_per_icon);
+        }
+        clock_us += FRAME;
+    }
+}
+
+static void
+test_step_down(void)
+{
+    gint level;
+
+    restart();
+
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_FULL,
+          "stepped down after %d heavy frames",
+          AWN_EFFECTS_QUALITY_DOWN_FRAMES - 1);
+
+    for (level = AWN_EFFECTS_QUALITY_REDUCED_BLUR;
+            level < AWN_EFFECTS_QUALITY_LAST; level++) {
+        paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES, 1, HEAVY);
+        CHECK(awn_effects_quality_get_level() == level,
+              "expected level %d, got %d", level,
+              awn_effects_quality_get_level());
+    }
+
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES * 10, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_LAST - 1,
+          "went past the lowest level");
+}
+
+static void
+test_many_icons(void)
+{
+    restart();
+
+    /* each icon is cheap, all of them together aren't */
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES + 1, 40, BUDGET / 20);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_REDUCED_BLUR,
+          "40 icons per frame over the budget didn't step down");
+}
+
+static void
+test_hysteresis(void)
+{
+    restart();
+
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES * 2 + 1, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() ==
+          AWN_EFFECTS_QUALITY_CACHED_SHADOWS, "expected two steps down");
+
+    /* under the budget, but not enough to step up */
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES * 4, 1, MEDIUM);
+    CHECK(awn_effects_quality_get_level() ==
+          AWN_EFFECTS_QUALITY_CACHED_SHADOWS,
+          "level changed between the thresholds");
+
+    /* a single heavy frame among cheap ones doesn't step down */
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES / 2, 1, CHEAP);
+    paint_frames(1, 1, HEAVY);
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES / 2, 1, CHEAP);
+    CHECK(awn_effects_quality_get_level() ==
+          AWN_EFFECTS_QUALITY_CACHED_SHADOWS,
+          "a single heavy frame changed the level");
+
+    /* the heavy frame restarted the count */
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES / 2 + 1, 1, CHEAP);
+    CHECK(awn_effects_quality_get_level() ==
+          AWN_EFFECTS_QUALITY_REDUCED_BLUR, "didn't step up");
+
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES, 1, CHEAP);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_FULL,
+          "didn't get back to full quality");
+}
+
+static void
+test_idle(void)
+{
+    restart();
+
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES + 1, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_REDUCED_BLUR,
+          "expected a step down");
+
+    /* nothing painted for a few seconds counts as cheap frames */
+    clock_us += FRAME * AWN_EFFECTS_QUALITY_UP_FRAMES * 3;
+    paint_frames(1, 1, CHEAP);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_FULL,
+          "an idle period didn't step up");
+}
+
+static void
+test_lowest(void)
+{
+    restart();
+
+    awn_effects_quality_set_lowest(AWN_EFFECTS_QUALITY_CACHED_SHADOWS);
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES * 10, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() ==
+          AWN_EFFECTS_QUALITY_CACHED_SHADOWS,
+          "went below the configured lowest level");
+
+    /* turning the controller off restores the full quality */
+    awn_effects_quality_set_lowest(AWN_EFFECTS_QUALITY_FULL);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_FULL,
+          "level kept after turning the controller off");
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES * 10, 1, HEAVY);
+    CHECK(awn_effects_quality_get_level() == AWN_EFFECTS_QUALITY_FULL,
+          "stepped down while turned off");
+}
+
+static void
+test_stats(void)
+{
+    awn_stats_set_enabled(TRUE);
+    awn_stats_reset();
+    restart();
+
+    paint_frames(AWN_EFFECTS_QUALITY_DOWN_FRAMES * 2 + 1, 1, HEAVY);
+    paint_frames(AWN_EFFECTS_QUALITY_UP_FRAMES + 1, 1, CHEAP);
+
+    CHECK(awn_stats_get_count(AWN_STATS_EFFECTS_QUALITY_DOWN) == 2,
+          "%" G_GUINT64_FORMAT " steps down counted",
+          awn_stats_get_count(AWN_STATS_EFFECTS_QUALITY_DOWN));
+    CHECK(awn_stats_get_count(AWN_STATS_EFFECTS_QUALITY_UP) == 1,
+          "%" G_GUINT64_FORMAT " steps up counted",
+          awn_stats_get_count(AWN_STATS_EFFECTS_QUALITY_UP));
+
+    awn_stats_set_enabled(FALSE);
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    test_step_down();
+    test_many_icons();
+    test_hysteresis();
+    test_idle();
+    test_lowest();
+    test_stats();
+
+    awn_effects_quality_reset();
+
+    return test_finish(argv[0]);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Compares the curve offsets looked up in an AwnPathTable with the analytic
+ * ellipse of awn_utils_get_offset_modifier_by_path_type().
+ */
+
+#include <math.h>
+
+#include <libawn/libawn.h>
+#include <libawn/awn-utils.h>
+#include <libawn/awn-path.h>
+
+#include "test-utils.h"
+
+/* max difference between the table and the analytic curve, in pixels */
+#define TOLERANCE 0.05
+
+static void
+compare(AwnPathType path_type, GtkPositionType position,
+        gint offset, gfloat offset_modifier, gint length)
+{
+    AwnPathTable table = { 0 };
+    gboolean vertical = position == GTK_POS_LEFT || position == GTK_POS_RIGHT;
+    gdouble max_diff = 0.0;
+    gint worst = 0;
+    gint pos;
+
+    awn_path_table_ensure(&table, path_type, offset, offset_modifier, length);
+
+    for (pos = 0; pos <= length; pos++) {
+        gfloat expected = awn_utils_get_offset_modifier_by_path_type(
+                              path_type, position, offset, offset_modifier,
+                              vertical ? 0 : pos, vertical ? pos : 0,
+                              vertical ? 48 : length, vertical ? length : 48);
+        gdouble diff = fabs(awn_path_table_get_offset(&table, pos) - expected);
+
+        if (diff > max_diff) {
+            max_diff = diff;
+            worst = pos;
+        }
+    }
+
+    CHECK(max_diff <= TOLERANCE,
+          "path %d, offset %d, modifier %.1f, length %d: "
+          "off by %.4f px at %d", path_type, offset, offset_modifier, length,
+          max_diff, worst);
+
+    awn_path_table_clear(&table);
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    static const gint lengths[] = { 1, 2, 37, 480, 1024, 1920, 4096 };
+    static const gint offsets[] = { 0, 5, 20, 100 };
+    static const gfloat modifiers[] = { 0.0f, 1.0f, 10.0f, 50.0f, 100.0f };
+    AwnPathTable table = { 0 };
+    guint i, j, k;
+
+    g_type_init();
+
+    for (i = 0; i < G_N_ELEMENTS(lengths); i++) {
+        for (j = 0; j < G_N_ELEMENTS(offsets); j++) {
+            for (k = 0; k < G_N_ELEMENTS(modifiers); k++) {
+                compare(AWN_PATH_ELLIPSE, GTK_POS_BOTTOM,
+                        offsets[j], modifiers[k], lengths[i]);
+                compare(AWN_PATH_ELLIPSE, GTK_POS_LEFT,
+                        offsets[j], modifiers[k], lengths[i]);
+                compare(AWN_PATH_LINEAR, GTK_POS_TOP,
+                        offsets[j], modifiers[k], lengths[i]);
+            }
+        }
+    }
+
+    /* the table is only rebuilt when its parameters change */
+    CHECK(awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 10, 20.0f, 800),
+          "first build not reported");
+    CHECK(!awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 10, 20.0f, 800),
+          "table rebuilt with unchanged parameters");
+    CHECK(awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 10, 20.0f, 801),
+          "length change did not rebuild the table");
+    CHECK(awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 11, 20.0f, 801),
+          "offset change did not rebuild the table");
+    CHECK(awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 11, 21.0f, 801),
+          "modifier change did not rebuild the table");
+    CHECK(awn_path_table_ensure(&table, AWN_PATH_LINEAR, 11, 21.0f, 801),
+          "path type change did not rebuild the table");
+
+    /* positions outside of the panel are clamped to its ends */
+    awn_path_table_ensure(&table, AWN_PATH_ELLIPSE, 10, 20.0f, 800);
+    CHECK(awn_path_table_get_offset(&table, -50) ==
+          awn_path_table_get_offset(&table, 0), "negative position");
+    CHECK(awn_path_table_get_offset(&table, 900) ==
+          awn_path_table_get_offset(&table, 800), "position past the end");
+    awn_path_table_clear(&table);
+
+    return test_finish(argv[0]);
+}
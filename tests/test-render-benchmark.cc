@@ -0,0 +1,984 @@
+/*
+ *  Copyright (C) 2009 Michal Hruby <michal.mhr@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Non-interactive rendering benchmark.
+ *
+ * Drives every effect bundle and static effect, every overlay type and every
+ * background style for a number of frames at several sizes and orientations
+ * and reports per-frame time percentiles together with the number of heap
+ * allocations per frame. The tooltip cases hover over a row of 40 icons,
+ * one frame being the whole sweep.
+ *
+ * Effects and overlays paint into a real (unmanaged) window, so an X server
+ * is required; backgrounds only paint into image surfaces. The usual way
+ * to run it is:
+ *
+ *   xvfb-run -a dbus-launch ./test-render-benchmark --csv > baseline.csv
+ *   xvfb-run -a dbus-launch ./test-render-benchmark --baseline baseline.csv
+ *
+ * The second invocation exits with a non-zero status if the p90 frame time
+ * or the allocation count of any case exceeds the baseline by more than
+ * --margin percent.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+
+#include "src/awn-panel.h"
+#include "src/awn-background.h"
+#include "src/awn-background-3d.h"
+#include "src/awn-background-curves.h"
+#include "src/awn-background-edgy.h"
+#include "src/awn-background-flat.h"
+#include "src/awn-background-floaty.h"
+#include "src/awn-background-lucido.h"
+
+static gint frames = 100;
+static gchar* sizes_str = NULL;
+static gchar* only = NULL;
+static gboolean csv = FALSE;
+static gchar* baseline_file = NULL;
+static gdouble margin = 10.0;
+
+static GOptionEntry entries[] = {
+    {
+        "frames", 'n', 0, G_OPTION_ARG_INT, &frames,
+        "Number of frames rendered for each case (default 100)", "N"
+    },
+    {
+        "sizes", 's', 0, G_OPTION_ARG_STRING, &sizes_str,
+        "Comma separated list of icon sizes (default 24,48,96)", "LIST"
+    },
+    {
+        "only", 'o', 0, G_OPTION_ARG_STRING, &only,
+        "Run only cases whose name contains SUBSTRING", "SUBSTRING"
+    },
+    {
+        "csv", 'c', 0, G_OPTION_ARG_NONE, &csv,
+        "Print machine-readable CSV instead of a table", NULL
+    },
+    {
+        "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline_file,
+        "Fail if results exceed the CSV baseline in FILE", "FILE"
+    },
+    {
+        "margin", 'm', 0, G_OPTION_ARG_DOUBLE, &margin,
+        "Allowed regression over the baseline in percent (default 10)", "PCT"
+    },
+    { NULL }
+};
+
+static const GtkPositionType positions[] = {
+    GTK_POS_BOTTOM, GTK_POS_TOP, GTK_POS_LEFT, GTK_POS_RIGHT
+};
+
+static const gchar* position_names[] = {
+    "left", "right", "top", "bottom"  /* indexed by GtkPositionType */
+};
+
+/*
+ * Allocation counting
+ *
+ * We interpose malloc & friends and forward to the glibc implementation,
+ * the counter is only incremented while a frame is being timed.
+ */
+#ifdef __GLIBC__
+extern "C" {
+    extern void* __libc_malloc(size_t size);
+    extern void* __libc_calloc(size_t nmemb, size_t size);
+    extern void* __libc_realloc(void* ptr, size_t size);
+}
+
+static volatile gint alloc_counting = 0;
+static volatile gint alloc_count = 0;
+
+extern "C" void*
+malloc(size_t size) __THROW
+{
+    if (g_atomic_int_get(&alloc_counting)) {
+        g_atomic_int_inc(&alloc_count);
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void*
+calloc(size_t nmemb, size_t size) __THROW
+{
+    if (g_atomic_int_get(&alloc_counting)) {
+        g_atomic_int_inc(&alloc_count);
+    }
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void*
+realloc(void* ptr, size_t size) __THROW
+{
+    if (g_atomic_int_get(&alloc_counting)) {
+        g_atomic_int_inc(&alloc_count);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+#define ALLOC_COUNTING_START() \
+    G_STMT_START { \
+        g_atomic_int_set(&alloc_count, 0); \
+        g_atomic_int_set(&alloc_counting, 1); \
+    } G_STMT_END
+#define ALLOC_COUNTING_STOP() \
+    (g_atomic_int_set(&alloc_counting, 0), g_atomic_int_get(&alloc_count))
+#else
+#define ALLOC_COUNTING_START() G_STMT_START { } G_STMT_END
+#define ALLOC_COUNTING_STOP() (0)
+#endif
+
+/*
+ * Results
+ */
+typedef struct {
+    gchar*  name;
+    gint    frames;
+    gdouble p50;
+    gdouble p90;
+    gdouble p99;
+    gdouble max;
+    gdouble mean;
+    gdouble allocs;
+} BenchResult;
+
+typedef struct {
+    GArray* times;   /* gdouble, microseconds */
+    guint64 allocs;
+    GTimer* timer;
+} BenchRun;
+
+static GPtrArray* results = NULL;
+
+static void
+bench_run_init(BenchRun* run)
+{
+    run->times = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), frames);
+    run->allocs = 0;
+    run->timer = g_timer_new();
+}
+
+static void
+bench_frame_begin(BenchRun* run)
+{
+    ALLOC_COUNTING_START();
+    g_timer_start(run->timer);
+}
+
+static void
+bench_frame_end(BenchRun* run)
+{
+    gdouble us;
+
+    g_timer_stop(run->timer);
+    run->allocs += ALLOC_COUNTING_STOP();
+
+    us = g_timer_elapsed(run->timer, NULL) * G_USEC_PER_SEC;
+    g_array_append_val(run->times, us);
+}
+
+static int
+compare_doubles(gconstpointer a, gconstpointer b)
+{
+    gdouble x = *(const gdouble*)a;
+    gdouble y = *(const gdouble*)b;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static gdouble
+percentile(GArray* sorted, gdouble p)
+{
+    gint index = (gint)ceil(p / 100.0 * sorted->len) - 1;
+
+    index = CLAMP(index, 0, (gint)sorted->len - 1);
+    return g_array_index(sorted, gdouble, index);
+}
+
+static void
+bench_run_finish(BenchRun* run, const gchar* name)
+{
+    BenchResult* result;
+    gdouble sum = 0.0;
+    guint i;
+
+    if (run->times->len > 0) {
+        result = g_new0(BenchResult, 1);
+        g_array_sort(run->times, compare_doubles);
+
+        for (i = 0; i < run->times->len; i++) {
+            sum += g_array_index(run->times, gdouble, i);
+        }
+
+        result->name = g_strdup(name);
+        result->frames = run->times->len;
+        result->p50 = percentile(run->times, 50.0);
+        result->p90 = percentile(run->times, 90.0);
+        result->p99 = percentile(run->times, 99.0);
+        result->max = g_array_index(run->times, gdouble, run->times->len - 1);
+        result->mean = sum / run->times->len;
+        result->allocs = (gdouble)run->allocs / run->times->len;
+
+        g_ptr_array_add(results, result);
+    }
+
+    g_array_free(run->times, TRUE);
+    g_timer_destroy(run->timer);
+}
+
+static gboolean
+case_selected(const gchar* name)
+{
+    return only == NULL || strstr(name, only) != NULL;
+}
+
+/*
+ * Widget cases (effects & overlays)
+ */
+static void
+flush_events(void)
+{
+    while (g_main_context_pending(NULL)) {
+        g_main_context_iteration(NULL, FALSE);
+    }
+}
+
+static cairo_surface_t*
+create_icon_surface(gint size)
+{
+    cairo_surface_t* surface;
+    cairo_pattern_t* pat;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    cr = cairo_create(surface);
+
+    pat = cairo_pattern_create_linear(0, 0, 0, size);
+    cairo_pattern_add_color_stop_rgba(pat, 0.0, 0.95, 0.6, 0.2, 1.0);
+    cairo_pattern_add_color_stop_rgba(pat, 1.0, 0.4, 0.1, 0.6, 0.8);
+
+    awn_cairo_rounded_rect(cr, size * 0.1, size * 0.1,
+                           size * 0.8, size * 0.8, size * 0.15, ROUND_ALL);
+    cairo_set_source(cr, pat);
+    cairo_fill(cr);
+
+    cairo_pattern_destroy(pat);
+    cairo_destroy(cr);
+
+    return surface;
+}
+
+typedef void (*SetupFunc)(AwnIcon* icon, gint size);
+
+static void
+run_widget_case(const gchar* name, SetupFunc setup,
+                GtkPositionType position, gint size)
+{
+    GtkWidget* window;
+    GtkWidget* icon;
+    cairo_surface_t* surface;
+    BenchRun run;
+    gint i;
+
+    window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(window), 0, 0);
+
+    icon = awn_icon_new();
+    awn_icon_set_pos_type(AWN_ICON(icon), position);
+    surface = create_icon_surface(size);
+    awn_icon_set_from_surface(AWN_ICON(icon), surface);
+
+    gtk_container_add(GTK_CONTAINER(window), icon);
+    gtk_widget_show_all(window);
+    flush_events();
+
+    setup(AWN_ICON(icon), size);
+
+    /* warm-up frame, so the first-expose work isn't measured */
+    gtk_widget_queue_draw(icon);
+    gdk_window_process_updates(icon->window, TRUE);
+    flush_events();
+
+    bench_run_init(&run);
+
+    for (i = 0; i < frames; i++) {
+        /* animated cases progress with their own timers in between frames */
+        flush_events();
+        gtk_widget_queue_draw(icon);
+
+        bench_frame_begin(&run);
+        gdk_window_process_updates(icon->window, TRUE);
+        gdk_display_sync(gtk_widget_get_display(icon));
+        bench_frame_end(&run);
+    }
+
+    bench_run_finish(&run, name);
+
+    gtk_widget_destroy(window);
+    cairo_surface_destroy(surface);
+    flush_events();
+}
+
+/* effects */
+
+static void
+setup_effects_plain(AwnIcon* icon, gint size)
+{
+}
+
+static void
+setup_effects_shadow(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "make-shadow", TRUE, NULL);
+}
+
+static void
+setup_effects_reflection(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "reflection-visible", TRUE, NULL);
+}
+
+static void
+setup_effects_active(AwnIcon* icon, gint size)
+{
+    awn_icon_set_is_active(icon, TRUE);
+}
+
+static void
+setup_effects_arrows(AwnIcon* icon, gint size)
+{
+    awn_icon_set_indicator_count(icon, 2);
+}
+
+static void
+setup_effects_progress(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "progress", 0.5f, NULL);
+}
+
+static void
+setup_effects_alpha(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "icon-alpha", 0.5f, NULL);
+}
+
+static void
+setup_effects_depressed(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "depressed", TRUE, NULL);
+}
+
+static void
+setup_effects_all(AwnIcon* icon, gint size)
+{
+    g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                 "make-shadow", TRUE,
+                 "reflection-visible", TRUE,
+                 "progress", 0.5f,
+                 NULL);
+    awn_icon_set_is_active(icon, TRUE);
+    awn_icon_set_indicator_count(icon, 1);
+}
+
+static const struct {
+    const gchar* name;
+    SetupFunc    setup;
+} static_effects[] = {
+    { "plain",      setup_effects_plain },
+    { "shadow",     setup_effects_shadow },
+    { "reflection", setup_effects_reflection },
+    { "active",     setup_effects_active },
+    { "arrows",     setup_effects_arrows },
+    { "progress",   setup_effects_progress },
+    { "alpha",      setup_effects_alpha },
+    { "depressed",  setup_effects_depressed },
+    { "all",        setup_effects_all }
+};
+
+/* effect bundles in the order they're registered in AwnEffectsClass */
+static const gchar* bundle_names[] = {
+    "simple", "classic", "fade", "spotlight", "zoom",
+    "squish", "turn", "spotlight3d", "glow"
+};
+
+static gint current_bundle = 0;
+
+static void
+setup_effects_bundle(AwnIcon* icon, gint size)
+{
+    AwnEffects* fx = awn_overlayable_get_effects(AWN_OVERLAYABLE(icon));
+    gint effects = 0;
+    gint i;
+
+    /* each animation type has its own nibble */
+    for (i = 0; i < 5; i++) {
+        effects |= current_bundle << (i * 4);
+    }
+
+    g_object_set(fx, "effects", effects, NULL);
+    awn_effects_start(fx, AWN_EFFECT_ATTENTION);
+}
+
+/* overlays */
+
+static gchar* overlay_png = NULL;
+
+static void
+add_overlay(AwnIcon* icon, AwnOverlay* overlay)
+{
+    awn_overlayable_add_overlay(AWN_OVERLAYABLE(icon), overlay);
+}
+
+static void
+setup_overlay_text(AwnIcon* icon, gint size)
+{
+    AwnOverlayText* overlay = awn_overlay_text_new();
+
+    g_object_set(overlay, "text", "42", NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static void
+setup_overlay_throbber(AwnIcon* icon, gint size)
+{
+    GtkWidget* overlay = awn_overlay_throbber_new();
+
+    g_object_set(overlay, "active", TRUE, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static void
+setup_overlay_pixbuf(AwnIcon* icon, gint size)
+{
+    GdkPixbuf* pixbuf;
+    AwnOverlayPixbuf* overlay;
+
+    pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, size, size);
+    gdk_pixbuf_fill(pixbuf, 0x3465a4c0);
+    overlay = awn_overlay_pixbuf_new_with_pixbuf(pixbuf);
+    g_object_set(overlay, "scale", 0.5, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+
+    g_object_unref(pixbuf);
+}
+
+static void
+setup_overlay_pixbuf_file(AwnIcon* icon, gint size)
+{
+    AwnOverlayPixbufFile* overlay;
+
+    overlay = awn_overlay_pixbuf_file_new(overlay_png);
+    g_object_set(overlay, "scale", 0.5, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static void
+setup_overlay_progress(AwnIcon* icon, gint size)
+{
+    AwnOverlayProgress* overlay = awn_overlay_progress_new();
+
+    g_object_set(overlay, "percent-complete", 50.0, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static void
+setup_overlay_progress_circle(AwnIcon* icon, gint size)
+{
+    AwnOverlayProgressCircle* overlay = awn_overlay_progress_circle_new();
+
+    g_object_set(overlay, "percent-complete", 50.0, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static void
+setup_overlay_themed_icon(AwnIcon* icon, gint size)
+{
+    AwnOverlayThemedIcon* overlay;
+
+    overlay = awn_overlay_themed_icon_new(GTK_STOCK_MISSING_IMAGE);
+    g_object_set(overlay, "scale", 0.5, NULL);
+    add_overlay(icon, AWN_OVERLAY(overlay));
+}
+
+static const struct {
+    const gchar* name;
+    SetupFunc    setup;
+} overlays[] = {
+    { "text",            setup_overlay_text },
+    { "throbber",        setup_overlay_throbber },
+    { "pixbuf",          setup_overlay_pixbuf },
+    { "pixbuf-file",     setup_overlay_pixbuf_file },
+    { "progress",        setup_overlay_progress },
+    { "progress-circle", setup_overlay_progress_circle },
+    { "themed-icon",     setup_overlay_themed_icon }
+};
+
+static void
+run_widget_cases(GArray* sizes)
+{
+    guint s, p, i;
+
+    for (s = 0; s < sizes->len; s++) {
+        gint size = g_array_index(sizes, gint, s);
+
+        for (p = 0; p < G_N_ELEMENTS(positions); p++) {
+            GtkPositionType pos = positions[p];
+            gchar* name;
+
+            for (i = 0; i < G_N_ELEMENTS(static_effects); i++) {
+                name = g_strdup_printf("effects/%s/%s/%d",
+                                       static_effects[i].name,
+                                       position_names[pos], size);
+                if (case_selected(name)) {
+                    run_widget_case(name, static_effects[i].setup, pos, size);
+                }
+                g_free(name);
+            }
+
+            for (i = 0; i < G_N_ELEMENTS(bundle_names); i++) {
+                name = g_strdup_printf("effects/%s/%s/%d", bundle_names[i],
+                                       position_names[pos], size);
+                if (case_selected(name)) {
+                    current_bundle = i;
+                    run_widget_case(name, setup_effects_bundle, pos, size);
+                }
+                g_free(name);
+            }
+
+            for (i = 0; i < G_N_ELEMENTS(overlays); i++) {
+                name = g_strdup_printf("overlay/%s/%s/%d", overlays[i].name,
+                                       position_names[pos], size);
+                if (case_selected(name)) {
+                    run_widget_case(name, overlays[i].setup, pos, size);
+                }
+                g_free(name);
+            }
+        }
+    }
+}
+
+/*
+ * Background cases
+ */
+static const struct {
+    const gchar* name;
+    GType (*get_type)(void);
+} backgrounds[] = {
+    { "flat",   awn_background_flat_get_type },
+    { "3d",     awn_background_3d_get_type },
+    { "curves", awn_background_curves_get_type },
+    { "edgy",   awn_background_edgy_get_type },
+    { "floaty", awn_background_floaty_get_type },
+    { "lucido", awn_background_lucido_get_type }
+};
+
+static void
+run_background_case(const gchar* name, AwnBackground* bg,
+                    GtkPositionType position, gint size)
+{
+    cairo_surface_t* surface;
+    cairo_t* cr;
+    GdkRectangle area;
+    BenchRun run;
+    gint i;
+
+    area.x = 0;
+    area.y = 0;
+
+    if (position == GTK_POS_TOP || position == GTK_POS_BOTTOM) {
+        area.width = size * 12;
+        area.height = size * 3 / 2;
+    } else {
+        area.width = size * 3 / 2;
+        area.height = size * 12;
+    }
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         area.width, area.height);
+    cr = cairo_create(surface);
+
+    bench_run_init(&run);
+
+    for (i = 0; i < frames; i++) {
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+
+        /* measure the full draw, not the cached blit */
+        awn_background_invalidate(bg);
+
+        bench_frame_begin(&run);
+        awn_background_draw(bg, cr, position, &area);
+        cairo_surface_flush(surface);
+        bench_frame_end(&run);
+    }
+
+    bench_run_finish(&run, name);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+static void
+run_background_cases(GArray* sizes)
+{
+    GtkWidget* panel;
+    DesktopAgnosticConfigClient* client;
+    guint b, s, p;
+
+    panel = awn_panel_new_with_panel_id(AWN_PANEL_ID_DEFAULT);
+    if (panel == NULL) {
+        g_warning("Unable to create the panel, skipping backgrounds");
+        return;
+    }
+    g_object_get(panel, "client", &client, NULL);
+
+    /* Note that the main loop isn't iterated from here on, the panel is
+     * never shown and so its applets are never started.
+     */
+    for (b = 0; b < G_N_ELEMENTS(backgrounds); b++) {
+        AwnBackground* bg;
+
+        bg = AWN_BACKGROUND(g_object_new(backgrounds[b].get_type(),
+                                         "client", client,
+                                         "panel", panel,
+                                         NULL));
+
+        for (s = 0; s < sizes->len; s++) {
+            gint size = g_array_index(sizes, gint, s);
+
+            for (p = 0; p < G_N_ELEMENTS(positions); p++) {
+                GtkPositionType pos = positions[p];
+                gchar* name;
+
+                name = g_strdup_printf("background/%s/%s/%d",
+                                       backgrounds[b].name,
+                                       position_names[pos], size);
+                if (case_selected(name)) {
+                    run_background_case(name, bg, pos, size);
+                }
+                g_free(name);
+            }
+        }
+
+        g_object_unref(bg);
+    }
+
+    g_object_unref(client);
+}
+
+/*
+ * Tooltip cases
+ */
+#define SWEEP_ICONS 40
+#define SWEEP_ICON_SIZE 48
+
+static const gchar* tooltip_names[] = {
+    "Terminal", "Web Browser", "Mail", "Files", "Text Editor",
+    "Music Player", "Calendar", "Image Viewer", "Chat", "Settings"
+};
+
+/* @relabel: every sweep shows a different text than the previous one, like
+ * window titles changing while the pointer is away
+ */
+static void
+run_tooltip_case(const gchar* name, GtkPositionType position,
+                 gboolean relabel)
+{
+    GtkWidget* window;
+    GtkWidget* box;
+    AwnTooltip* tooltips[SWEEP_ICONS];
+    gchar* texts[2][SWEEP_ICONS];
+    cairo_surface_t* surface;
+    BenchRun run;
+    gint i, j;
+
+    window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(window), 0, 300);
+
+    if (position == GTK_POS_TOP || position == GTK_POS_BOTTOM) {
+        box = gtk_hbox_new(FALSE, 0);
+    } else {
+        box = gtk_vbox_new(FALSE, 0);
+    }
+    gtk_container_add(GTK_CONTAINER(window), box);
+
+    surface = create_icon_surface(SWEEP_ICON_SIZE);
+
+    for (j = 0; j < SWEEP_ICONS; j++) {
+        GtkWidget* icon = awn_icon_new();
+
+        awn_icon_set_pos_type(AWN_ICON(icon), position);
+        awn_icon_set_from_surface(AWN_ICON(icon), surface);
+        gtk_box_pack_start(GTK_BOX(box), icon, FALSE, FALSE, 0);
+        tooltips[j] = awn_icon_get_tooltip(AWN_ICON(icon));
+
+        texts[0][j] = g_strdup_printf("%s %d", tooltip_names[j %
+                                      G_N_ELEMENTS(tooltip_names)], j);
+        texts[1][j] = g_strdup_printf("%s - %d", tooltip_names[j %
+                                      G_N_ELEMENTS(tooltip_names)], j);
+    }
+
+    gtk_widget_show_all(window);
+    flush_events();
+
+    bench_run_init(&run);
+
+    /* the first sweep shows every tooltip for the first time, not measured */
+    for (i = -1; i < frames; i++) {
+        gchar** sweep_texts = texts[relabel ? (i + 1) % 2 : 0];
+
+        flush_events();
+
+        if (i >= 0) {
+            bench_frame_begin(&run);
+        }
+
+        for (j = 0; j < SWEEP_ICONS; j++) {
+            GtkWidget* tooltip = GTK_WIDGET(tooltips[j]);
+
+            awn_tooltip_set_text(tooltips[j], sweep_texts[j]);
+            awn_tooltip_update_position(tooltips[j]);
+            gtk_widget_show(tooltip);
+            gdk_window_process_updates(tooltip->window, TRUE);
+            gdk_display_sync(gtk_widget_get_display(tooltip));
+            flush_events();
+            gtk_widget_hide(tooltip);
+        }
+
+        if (i >= 0) {
+            gdk_display_sync(gtk_widget_get_display(window));
+            bench_frame_end(&run);
+        }
+    }
+
+    bench_run_finish(&run, name);
+
+    for (j = 0; j < SWEEP_ICONS; j++) {
+        g_free(texts[0][j]);
+        g_free(texts[1][j]);
+    }
+
+    gtk_widget_destroy(window);
+    cairo_surface_destroy(surface);
+    flush_events();
+}
+
+static void
+run_tooltip_cases(void)
+{
+    guint p;
+
+    for (p = 0; p < G_N_ELEMENTS(positions); p++) {
+        GtkPositionType pos = positions[p];
+        gchar* name;
+
+        name = g_strdup_printf("tooltip/sweep/%s", position_names[pos]);
+        if (case_selected(name)) {
+            run_tooltip_case(name, pos, FALSE);
+        }
+        g_free(name);
+
+        name = g_strdup_printf("tooltip/relabel/%s", position_names[pos]);
+        if (case_selected(name)) {
+            run_tooltip_case(name, pos, TRUE);
+        }
+        g_free(name);
+    }
+}
+
+/*
+ * Reporting
+ */
+static void
+print_results(void)
+{
+    guint i;
+
+    if (csv) {
+        g_print("case,frames,p50_us,p90_us,p99_us,max_us,mean_us,"
+                "allocs_per_frame\n");
+    } else {
+        g_print("%-44s %6s %9s %9s %9s %9s %8s\n", "case", "frames",
+                "p50 us", "p90 us", "p99 us", "max us", "allocs");
+    }
+
+    for (i = 0; i < results->len; i++) {
+        BenchResult* r = (BenchResult*)g_ptr_array_index(results, i);
+
+        if (csv) {
+            g_print("%s,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", r->name,
+                    r->frames, r->p50, r->p90, r->p99, r->max, r->mean,
+                    r->allocs);
+        } else {
+            g_print("%-44s %6d %9.1f %9.1f %9.1f %9.1f %8.1f\n", r->name,
+                    r->frames, r->p50, r->p90, r->p99, r->max, r->allocs);
+        }
+    }
+}
+
+/* Returns number of cases which regressed against the baseline. */
+static gint
+compare_with_baseline(const gchar* filename)
+{
+    GHashTable* baseline;
+    gchar* contents = NULL;
+    gchar** lines;
+    GError* error = NULL;
+    gint regressions = 0;
+    guint i;
+
+    if (!g_file_get_contents(filename, &contents, NULL, &error)) {
+        g_printerr("Unable to read baseline: %s\n", error->message);
+        g_error_free(error);
+        return -1;
+    }
+
+    baseline = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                     g_free, g_free);
+
+    lines = g_strsplit(contents, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+        gchar** fields = g_strsplit(lines[i], ",", -1);
+
+        /* case,frames,p50,p90,p99,max,mean,allocs; skips the header too */
+        if (g_strv_length(fields) == 8 && g_ascii_isdigit(fields[1][0])) {
+            gdouble* values = g_new(gdouble, 2);
+
+            values[0] = g_ascii_strtod(fields[3], NULL);
+            values[1] = g_ascii_strtod(fields[7], NULL);
+            g_hash_table_insert(baseline, g_strdup(fields[0]), values);
+        }
+        g_strfreev(fields);
+    }
+    g_strfreev(lines);
+    g_free(contents);
+
+    for (i = 0; i < results->len; i++) {
+        BenchResult* r = (BenchResult*)g_ptr_array_index(results, i);
+        gdouble* values = (gdouble*)g_hash_table_lookup(baseline, r->name);
+        gdouble factor = 1.0 + margin / 100.0;
+
+        if (values == NULL) {
+            continue;
+        }
+
+        if (r->p90 > values[0] * factor) {
+            g_printerr("REGRESSION %s: p90 %.1f us, baseline %.1f us\n",
+                       r->name, r->p90, values[0]);
+            regressions++;
+        } else if (r->allocs > values[1] * factor + 0.5) {
+            g_printerr("REGRESSION %s: %.1f allocs/frame, baseline %.1f\n",
+                       r->name, r->allocs, values[1]);
+            regressions++;
+        }
+    }
+
+    g_hash_table_destroy(baseline);
+
+    return regressions;
+}
+
+static GArray*
+parse_sizes(const gchar* str)
+{
+    GArray* sizes = g_array_new(FALSE, FALSE, sizeof(gint));
+    gchar** tokens = g_strsplit(str ? str : "24,48,96", ",", -1);
+    gint i;
+
+    for (i = 0; tokens[i]; i++) {
+        gint size = atoi(tokens[i]);
+        if (size > 0) {
+            g_array_append_val(sizes, size);
+        }
+    }
+    g_strfreev(tokens);
+
+    return sizes;
+}
+
+static gchar*
+create_overlay_png(void)
+{
+    cairo_surface_t* surface = create_icon_surface(128);
+    gchar* path = g_build_filename(g_get_tmp_dir(),
+                                   "awn-render-benchmark.png", NULL);
+
+    cairo_surface_write_to_png(surface, path);
+    cairo_surface_destroy(surface);
+
+    return path;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    GOptionContext* context;
+    GError* error = NULL;
+    GArray* sizes;
+    gint regressions = 0;
+
+    context = g_option_context_new("- AWN rendering benchmark");
+    g_option_context_add_main_entries(context, entries, NULL);
+    g_option_context_add_group(context, gtk_get_option_group(TRUE));
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return 2;
+    }
+    g_option_context_free(context);
+
+    if (frames <= 0) {
+        g_printerr("Number of frames must be positive\n");
+        return 2;
+    }
+
+    results = g_ptr_array_new();
+    sizes = parse_sizes(sizes_str);
+    overlay_png = create_overlay_png();
+
+    run_widget_cases(sizes);
+    run_background_cases(sizes);
+    run_tooltip_cases();
+
+    print_results();
+
+    if (baseline_file) {
+        regressions = compare_with_baseline(baseline_file);
+    }
+
+    g_unlink(overlay_png);
+    g_free(overlay_png);
+    g_array_free(sizes, TRUE);
+
+    return regressions != 0 ? 1 : 0;
+}
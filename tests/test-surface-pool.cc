@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Stress test of the scratch surface pool. First borrows and returns image
+ * surfaces the way a frame does, then renders an AwnIcon with every effect
+ * which uses scratch surfaces for a few thousand frames on a private Xvfb
+ * server, and checks that every borrowed surface came back and that the
+ * pool doesn't grow.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+#include "libawn/awn-surface-pool.h"
+
+#include "test-utils.h"
+
+#define FRAMES 2000
+#define ICON_SIZE 48
+
+static void
+stress_images(void)
+{
+    AwnSurfacePoolCounters counters;
+    gint i;
+
+    awn_surface_pool_trim();
+
+    for (i = 0; i < FRAMES * 2; i++) {
+        /* three nested borrows, the size changes every now and then */
+        gint size = 64 + (i / 500) * 8;
+        cairo_surface_t* a = awn_surface_pool_borrow_image(size, size);
+        cairo_surface_t* b = awn_surface_pool_borrow_image(size, size);
+        cairo_surface_t* c = awn_surface_pool_borrow(a,
+                             CAIRO_CONTENT_COLOR_ALPHA,
+                             size, size / 2);
+
+        CHECK(a != b && b != c && a != c, "frame %d got a surface twice", i);
+
+        awn_surface_pool_return(c);
+        awn_surface_pool_return(b);
+        awn_surface_pool_return(a);
+    }
+
+    awn_surface_pool_get_counters(&counters);
+    CHECK(counters.outstanding == 0, "%u image surfaces not returned",
+          counters.outstanding);
+    /* 8 different sizes, three surfaces each */
+    CHECK(counters.allocated <= 8 * 3, "%u image surfaces allocated",
+          counters.allocated);
+    CHECK(counters.idle <= 16, "%u idle surfaces", counters.idle);
+    CHECK(counters.reused >= FRAMES * 6 - 8 * 3, "only %u borrows reused",
+          counters.reused);
+
+    awn_surface_pool_trim();
+    awn_surface_pool_get_counters(&counters);
+    CHECK(counters.idle == 0, "%u idle surfaces after trim", counters.idle);
+}
+
+static void
+flush_events(void)
+{
+    gdk_display_sync(gdk_display_get_default());
+
+    while (gtk_events_pending()) {
+        gtk_main_iteration();
+    }
+}
+
+static cairo_surface_t*
+create_icon_surface(void)
+{
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         ICON_SIZE, ICON_SIZE);
+    cr = cairo_create(surface);
+    awn_cairo_rounded_rect(cr, 4, 4, ICON_SIZE - 8, ICON_SIZE - 8,
+                           ICON_SIZE * 0.15, ROUND_ALL);
+    cairo_set_source_rgba(cr, 0.3, 0.5, 0.9, 0.8);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    return surface;
+}
+
+static void
+stress_icon(void)
+{
+    AwnSurfacePoolCounters before, after;
+    GtkWidget* window;
+    GtkWidget* icon;
+    AwnEffects* fx;
+    cairo_surface_t* surface;
+    gint i;
+
+    window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(window), 0, 0);
+
+    icon = awn_icon_new();
+    surface = create_icon_surface();
+    awn_icon_set_from_surface(AWN_ICON(icon), surface);
+
+    gtk_container_add(GTK_CONTAINER(window), icon);
+    gtk_widget_show_all(window);
+    flush_events();
+
+    fx = awn_overlayable_get_effects(AWN_OVERLAYABLE(icon));
+    g_object_set(fx,
+                 "indirect-paint", TRUE,
+                 "make-shadow", TRUE,
+                 "reflection-visible", TRUE,
+                 "reflection-compat", TRUE,
+                 "depressed", TRUE,
+                 NULL);
+
+    /* the first frame fills the pool */
+    gtk_widget_queue_draw(icon);
+    gdk_window_process_updates(icon->window, TRUE);
+    flush_events();
+    awn_surface_pool_get_counters(&before);
+
+    for (i = 0; i < FRAMES; i++) {
+        gtk_widget_queue_draw(icon);
+        gdk_window_process_updates(icon->window, TRUE);
+        flush_events();
+    }
+
+    awn_surface_pool_get_counters(&after);
+    CHECK(after.outstanding == 0, "%u scratch surfaces leaked",
+          after.outstanding);
+    CHECK(after.allocated == before.allocated,
+          "%u surfaces allocated after the first frame",
+          after.allocated - before.allocated);
+    CHECK(after.reused > before.reused, "the pool wasn't used");
+
+    gtk_widget_destroy(window);
+    cairo_surface_destroy(surface);
+    flush_events();
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+
+    g_type_init();
+
+    stress_images();
+
+    test_start_xvfb();
+
+    gtk_init(&argc, &argv);
+
+    stress_icon();
+
+    return test_finish(argv[0]);
+}
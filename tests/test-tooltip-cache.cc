@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ * Shows and hides an AwnTooltip the way hovering along the dock does and
+ * checks that repeated texts come from the layout cache and leave the label
+ * alone, and that the background and the shape mask are only painted again
+ * when the size or the colours change. Runs on a private Xvfb server.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+#include "libawn/awn-stats.h"
+
+#include "test-utils.h"
+
+#define HOVERS 20
+
+#define COUNT(counter) awn_stats_get_count(AWN_STATS_##counter)
+
+static void
+flush_events(void)
+{
+    gdk_display_sync(gdk_display_get_default());
+
+    while (gtk_events_pending()) {
+        gtk_main_iteration();
+    }
+}
+
+static void
+hover(AwnTooltip* tooltip, const gchar* text)
+{
+    awn_tooltip_set_text(tooltip, text);
+    awn_tooltip_update_position(tooltip);
+    gtk_widget_show(GTK_WIDGET(tooltip));
+    flush_events();
+    gdk_window_process_updates(GTK_WIDGET(tooltip)->window, TRUE);
+    flush_events();
+    gtk_widget_hide(GTK_WIDGET(tooltip));
+    flush_events();
+}
+
+static const gchar*
+label_text(AwnTooltip* tooltip)
+{
+    GtkWidget* align = gtk_bin_get_child(GTK_BIN(tooltip));
+
+    return gtk_label_get_text(GTK_LABEL(gtk_bin_get_child(GTK_BIN(align))));
+}
+
+static void
+test_tooltip(void)
+{
+    GtkWidget* window;
+    GtkWidget* icon;
+    AwnTooltip* tooltip;
+    DesktopAgnosticColor* color;
+    gint i;
+
+    window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(window), 100, 300);
+    icon = awn_icon_new();
+    gtk_widget_set_size_request(icon, 48, 48);
+    gtk_container_add(GTK_CONTAINER(window), icon);
+    gtk_widget_show_all(window);
+    flush_events();
+
+    tooltip = awn_icon_get_tooltip(AWN_ICON(icon));
+
+    awn_stats_reset();
+    hover(tooltip, "Terminal");
+    hover(tooltip, "Web Browser");
+    CHECK(COUNT(TOOLTIP_LAYOUT_CACHE_MISS) == 2,
+          "%" G_GUINT64_FORMAT " texts parsed, expected 2",
+          COUNT(TOOLTIP_LAYOUT_CACHE_MISS));
+    CHECK(strcmp(label_text(tooltip), "Web Browser") == 0,
+          "label shows \"%s\"", label_text(tooltip));
+
+    /* back to a recent text */
+    hover(tooltip, "Terminal");
+    CHECK(COUNT(TOOLTIP_LAYOUT_CACHE_HIT) == 1, "recent text wasn't reused");
+    CHECK(strcmp(label_text(tooltip), "Terminal") == 0,
+          "label shows \"%s\" instead of a reused text",
+          label_text(tooltip));
+
+    /* the same text over and over */
+    awn_stats_reset();
+    for (i = 0; i < HOVERS; i++) {
+        hover(tooltip, "Terminal");
+    }
+    CHECK(COUNT(TOOLTIP_LAYOUT_CACHE_HIT) == 0 &&
+          COUNT(TOOLTIP_LAYOUT_CACHE_MISS) == 0,
+          "label updated with an unchanged text");
+    CHECK(COUNT(TOOLTIP_BACKGROUND_RENDER) == 0,
+          "background painted %" G_GUINT64_FORMAT " times for the same size",
+          COUNT(TOOLTIP_BACKGROUND_RENDER));
+    CHECK(COUNT(TOOLTIP_MASKS) == 0,
+          "mask rebuilt %" G_GUINT64_FORMAT " times for the same size",
+          COUNT(TOOLTIP_MASKS));
+
+    /* new colours, same size */
+    awn_stats_reset();
+    color = desktop_agnostic_color_new_from_string("#336699cc", NULL);
+    awn_tooltip_set_background_color(tooltip, color);
+    g_object_unref(color);
+    hover(tooltip, "Terminal");
+    CHECK(COUNT(TOOLTIP_BACKGROUND_RENDER) == 1,
+          "background painted %" G_GUINT64_FORMAT " times after a colour change",
+          COUNT(TOOLTIP_BACKGROUND_RENDER));
+    CHECK(COUNT(TOOLTIP_MASKS) == 0, "mask rebuilt after a colour change");
+
+    gtk_widget_destroy(window);
+    flush_events();
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+
+    test_start_xvfb();
+
+    gtk_init(&argc, &argv);
+
+    awn_stats_set_enabled(TRUE);
+
+    test_tooltip();
+
+    awn_stats_set_enabled(FALSE);
+
+    return test_finish(argv[0]);
+}
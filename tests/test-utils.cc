@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "test-utils.h"
+
+/* automake treats this exit status as a skipped test */
+#define EXIT_SKIPPED 77
+
+gint test_failures = 0;
+
+static GPid xvfb_pid = 0;
+
+static void
+test_stop_xvfb(void)
+{
+    if (xvfb_pid) {
+        kill(xvfb_pid, SIGTERM);
+        g_spawn_close_pid(xvfb_pid);
+        xvfb_pid = 0;
+    }
+}
+
+void
+test_start_xvfb(void)
+{
+    const gchar* argv[] = {
+        "Xvfb", "-displayfd", "1", "-screen", "0", "1024x768x24",
+        "-nolisten", "tcp", NULL
+    };
+    GError* error = NULL;
+    gint out_fd;
+    gchar display[32] = ":";
+    gssize len = 1;
+
+    if (!g_spawn_async_with_pipes(NULL, (gchar**)argv, NULL,
+                                  (GSpawnFlags)(G_SPAWN_SEARCH_PATH |
+                                                G_SPAWN_STDERR_TO_DEV_NULL),
+                                  NULL, NULL, &xvfb_pid, NULL, &out_fd, NULL,
+                                  &error)) {
+        gchar* reason = g_strdup_printf("Unable to start Xvfb: %s",
+                                        error->message);
+        g_error_free(error);
+        test_skip(reason);
+    }
+
+    while (len < (gssize)sizeof(display) - 1) {
+        gssize r = read(out_fd, display + len, 1);
+        if (r <= 0 || display[len] == '\n') {
+            break;
+        }
+        len++;
+    }
+    display[len] = '\0';
+    close(out_fd);
+
+    if (len == 1) {
+        test_skip("Xvfb didn't report its display");
+    }
+
+    g_setenv("DISPLAY", display, TRUE);
+}
+
+void
+test_skip(const gchar* reason)
+{
+    g_printerr("%s\n", reason);
+    test_stop_xvfb();
+    exit(EXIT_SKIPPED);
+}
+
+gint
+test_finish(const gchar* name)
+{
+    test_stop_xvfb();
+
+    if (test_failures == 0) {
+        g_print("PASS: %s\n", name);
+    }
+
+    return test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2009-2010 Michal Hruby <michal.mhr@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/* test-utils.h
+ *
+ * Helpers shared by the tests in this directory: failure counting and a
+ * private Xvfb server for the tests which need a display.
+ */
+
+#ifndef _TEST_UTILS_H
+#define _TEST_UTILS_H
+
+#include <glib.h>
+
+extern gint test_failures;
+
+/* Reports a failure without stopping the test. */
+#define CHECK(cond, ...) \
+    G_STMT_START { \
+        if (!(cond)) { \
+            g_printerr("FAIL: " __VA_ARGS__); \
+            g_printerr("\n"); \
+            test_failures++; \
+        } \
+    } G_STMT_END
+
+/* Starts a private Xvfb server and points DISPLAY at it. Skips the test
+ * when that isn't possible.
+ */
+void test_start_xvfb(void);
+
+/* Stops Xvfb (if it was started) and exits with the "skipped" status. */
+void test_skip(const gchar* reason) G_GNUC_NORETURN;
+
+/* Stops Xvfb (if it was started), prints PASS when no CHECK failed and
+ * returns the exit status of the test.
+ */
+gint test_finish(const gchar* name);
+
+#endif